@@ -0,0 +1,374 @@
+/**
+ * Access Stream Analyzer
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef ACCESS_ANALYZER_H
+#define ACCESS_ANALYZER_H
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#include "memory_types.h"
+
+/**
+ * Fenwick (binary indexed) tree of 0/1 markers: point update, prefix count
+ * and position of the first marker in O(log n)
+ */
+class MarkerTree {
+private:
+    std::vector<uint32_t> tree;   // 1-based partial sums
+    size_t topBit;                // Highest power of two <= size, for descent
+
+public:
+    explicit MarkerTree(size_t size = 0) : tree(size + 1, 0), topBit(1) {
+        while (topBit * 2 <= size) topBit *= 2;
+    }
+    
+    size_t size() const { return tree.size() - 1; }
+    
+    void add(size_t position, int delta) {
+        for (size_t i = position + 1; i < tree.size(); i += i & (0 - i)) tree[i] += delta;
+    }
+    
+    /**
+     * Markers at positions [0, position)
+     */
+    uint32_t countBelow(size_t position) const {
+        uint32_t sum = 0;
+        for (size_t i = position; i > 0; i -= i & (0 - i)) sum += tree[i];
+        return sum;
+    }
+    
+    /**
+     * Position of the first marker (the tree must hold at least one)
+     */
+    size_t firstMarker() const {
+        size_t position = 0;
+        for (size_t step = topBit; step > 0; step /= 2) {
+            if (position + step < tree.size() && tree[position + step] == 0) position += step;
+        }
+        return position;
+    }
+    
+    /**
+     * Rebuild in O(n) from a marker array
+     */
+    void assign(const std::vector<uint8_t>& markers) {
+        std::fill(tree.begin(), tree.end(), 0);
+        for (size_t i = 1; i < tree.size(); i++) {
+            tree[i] += markers[i - 1];
+            size_t parent = i + (i & (0 - i));
+            if (parent < tree.size()) tree[parent] += tree[i];
+        }
+    }
+};
+
+/**
+ * Reuse-distance histogram and per-job working sets over a stream of page
+ * accesses, in one pass and bounded memory
+ * 
+ * Reuse distance is the number of distinct other pages touched since the
+ * previous access to the same page, measured over all jobs together (the
+ * TLB and physical memory are shared). An LRU structure of C entries hits
+ * exactly the accesses with distance below C, so the histogram gives the
+ * hit rate of every power-of-two TLB or frame count at once.
+ * 
+ * Distances come from Olken's algorithm: each tracked page keeps a marker
+ * at the time slot of its last access in a Fenwick tree, and the distance
+ * is the number of markers after that slot, O(log n) per access. Slots are
+ * renumbered when they run out, and at most depth pages are tracked (the
+ * least recently used one is forgotten), so memory stays fixed however long
+ * the stream is. Distances of depth or more, and pages forgotten before
+ * their reuse, count with first touches as "beyond depth".
+ * 
+ * A job's working set W(t, window) is the set of distinct pages among its
+ * last window accesses (per-job virtual time, as in Denning's model). It is
+ * kept exactly with a ring of the last window page indices and a per-page
+ * count of occurrences in the ring, O(1) per access.
+ */
+class AccessAnalyzer {
+public:
+    // Bucket 0 holds distance 0; bucket b > 0 holds [2^(b-1), 2^b)
+    static const int DISTANCE_BUCKETS = 34;
+    
+    /**
+     * Working-set statistics for one job
+     */
+    struct JobWorkingSet {
+        int jobId;
+        PageId pageCount;          // Pages in the job
+        uint64_t accesses;         // Accesses recorded (the job's virtual time)
+        PageId current;            // |W(t, window)| now
+        PageId peak;               // Largest |W(t, window)| seen
+        double sizeSum;            // Sum of |W(t, window)| over the job's accesses
+        
+        double mean() const { return accesses ? sizeSum / accesses : 0.0; }
+    };
+    
+    /**
+     * Totals over jobs that have ended
+     */
+    struct FinishedJobs {
+        uint64_t jobs;
+        uint64_t accesses;
+        double sizeSum;            // Sum of |W(t, window)| over all their accesses
+        PageId peak;               // Largest working set any of them reached
+    };
+
+private:
+    struct TrackedJob {
+        JobWorkingSet stats;
+        std::vector<PageId> ring;          // Last window page indices (grows to window)
+        std::vector<uint32_t> inWindow;    // Page index -> occurrences in ring
+        size_t ringHead;                   // Oldest ring entry once the ring is full
+    };
+    
+    uint64_t window;
+    size_t depth;
+    
+    // Reuse distance state
+    MarkerTree markers;                    // One marker per tracked page, at its last slot
+    std::vector<uint8_t> live;             // Slot -> holds a marker
+    std::vector<uint64_t> slotKey;         // Slot -> page key
+    std::unordered_map<uint64_t, uint32_t> lastSlot;  // Page key -> slot of its last access
+    size_t nextSlot;
+    uint64_t distanceCounts[DISTANCE_BUCKETS];
+    uint64_t beyondDepth;                  // First touches and distances >= depth
+    uint64_t totalAccesses;
+    
+    std::unordered_map<int, TrackedJob> jobs;
+    FinishedJobs finished;
+    
+    static int bucketOf(uint64_t distance) {
+        return distance == 0 ? 0 : 64 - __builtin_clzll(distance);
+    }
+    
+    /**
+     * Renumber live slots to 0 .. n-1 in access order and rebuild the tree
+     */
+    void compactSlots() {
+        size_t packed = 0;
+        for (size_t slot = 0; slot < nextSlot; slot++) {
+            if (!live[slot]) continue;
+            uint64_t key = slotKey[slot];
+            live[slot] = 0;
+            live[packed] = 1;
+            slotKey[packed] = key;
+            lastSlot[key] = static_cast<uint32_t>(packed);
+            packed++;
+        }
+        nextSlot = packed;
+        markers.assign(live);
+    }
+    
+    void recordDistance(uint64_t key) {
+        totalAccesses++;
+        std::unordered_map<uint64_t, uint32_t>::iterator it = lastSlot.find(key);
+        if (it != lastSlot.end()) {
+            uint32_t slot = it->second;
+            // Every tracked page's marker precedes nextSlot, so the markers
+            // after this page's slot are the tracked count minus those up to it
+            uint64_t distance = lastSlot.size() - markers.countBelow(slot + 1);
+            if (distance < depth) distanceCounts[bucketOf(distance)]++;
+            else beyondDepth++;
+            markers.add(slot, -1);
+            live[slot] = 0;
+        } else {
+            beyondDepth++;
+            if (lastSlot.size() == depth) {
+                // Forget the least recently used page
+                size_t oldest = markers.firstMarker();
+                markers.add(oldest, -1);
+                live[oldest] = 0;
+                lastSlot.erase(slotKey[oldest]);
+            }
+            it = lastSlot.insert(std::make_pair(key, 0u)).first;
+        }
+        
+        if (nextSlot == live.size()) compactSlots();
+        it->second = static_cast<uint32_t>(nextSlot);
+        slotKey[nextSlot] = key;
+        live[nextSlot] = 1;
+        markers.add(nextSlot, 1);
+        nextSlot++;
+    }
+    
+    void recordWorkingSet(TrackedJob& job, PageId pageIndex) {
+        if (job.inWindow[pageIndex]++ == 0) job.stats.current++;
+        if (job.ring.size() < window) {
+            job.ring.push_back(pageIndex);
+        } else {
+            // The access window ago leaves the window
+            PageId expired = job.ring[job.ringHead];
+            if (--job.inWindow[expired] == 0) job.stats.current--;
+            job.ring[job.ringHead] = pageIndex;
+            job.ringHead = job.ringHead + 1 < job.ring.size() ? job.ringHead + 1 : 0;
+        }
+        
+        job.stats.accesses++;
+        job.stats.sizeSum += job.stats.current;
+        if (job.stats.current > job.stats.peak) job.stats.peak = job.stats.current;
+    }
+
+public:
+    /**
+     * @param window Working-set window in accesses of the job (at least 1)
+     * @param depth Most pages whose reuse is tracked (at least 1); memory is
+     *              a few dozen bytes per tracked page
+     */
+    AccessAnalyzer(uint64_t window, size_t depth)
+        : window(window), depth(depth), markers(2 * depth), live(2 * depth, 0), slotKey(2 * depth, 0),
+          nextSlot(0), beyondDepth(0), totalAccesses(0) {
+        if (window == 0 || depth == 0) {
+            throw std::invalid_argument("Working-set window and reuse depth must be positive");
+        }
+        for (int b = 0; b < DISTANCE_BUCKETS; b++) distanceCounts[b] = 0;
+        lastSlot.reserve(depth);
+        FinishedJobs none = {0, 0, 0.0, 0};
+        finished = none;
+    }
+    
+    /**
+     * Start tracking a job's working set
+     * @param pageCount Pages in the job; recorded page indices must be below it
+     */
+    void trackJob(int jobId, PageId pageCount) {
+        TrackedJob& job = jobs[jobId];
+        JobWorkingSet stats = {jobId, pageCount, 0, 0, 0, 0.0};
+        job.stats = stats;
+        job.ring.clear();
+        job.inWindow.assign(pageCount, 0);
+        job.ringHead = 0;
+    }
+    
+    /**
+     * Stop tracking a job, folding its statistics into the finished totals
+     */
+    void untrackJob(int jobId) {
+        std::unordered_map<int, TrackedJob>::iterator it = jobs.find(jobId);
+        if (it == jobs.end()) return;
+        const JobWorkingSet& stats = it->second.stats;
+        finished.jobs++;
+        finished.accesses += stats.accesses;
+        finished.sizeSum += stats.sizeSum;
+        if (stats.peak > finished.peak) finished.peak = stats.peak;
+        jobs.erase(it);
+    }
+    
+    /**
+     * Record one access to a job's page
+     * @param pageIndex Job-relative page index (as in TranslationResult::pageNumber)
+     */
+    void recordAccess(int jobId, PageId pageIndex) {
+        recordDistance((static_cast<uint64_t>(static_cast<uint32_t>(jobId)) << 32) | pageIndex);
+        
+        std::unordered_map<int, TrackedJob>::iterator it = jobs.find(jobId);
+        if (it != jobs.end() && pageIndex < it->second.stats.pageCount) recordWorkingSet(it->second, pageIndex);
+    }
+    
+    /**
+     * Record a batch of logical addresses of one job (as passed to
+     * resolveAddresses); addresses past the job's pages are skipped
+     */
+    void recordAddresses(int jobId, const Address* logicalAddresses, size_t count, uint32_t pageSize) {
+        std::unordered_map<int, TrackedJob>::iterator it = jobs.find(jobId);
+        Address limit = it != jobs.end() ? static_cast<Address>(it->second.stats.pageCount) * pageSize : 0;
+        for (size_t i = 0; i < count; i++) {
+            if (logicalAddresses[i] < limit) recordAccess(jobId, static_cast<PageId>(logicalAddresses[i] / pageSize));
+        }
+    }
+    
+    // Configuration and results
+    uint64_t getWindow() const { return window; }
+    size_t getDepth() const { return depth; }
+    uint64_t accessCount() const { return totalAccesses; }
+    uint64_t beyondDepthCount() const { return beyondDepth; }
+    uint64_t distanceCount(int bucket) const { return distanceCounts[bucket]; }
+    const FinishedJobs& finishedJobs() const { return finished; }
+    
+    /**
+     * Accesses an LRU structure of capacity entries (a power of two up to
+     * the depth) would hit: exactly those with reuse distance below capacity
+     */
+    uint64_t lruHits(uint64_t capacity) const {
+        uint64_t hits = 0;
+        for (int b = 0; b < DISTANCE_BUCKETS && b <= bucketOf(capacity - 1); b++) hits += distanceCounts[b];
+        return hits;
+    }
+    
+    /**
+     * Working sets of the jobs being tracked, in ID order
+     */
+    std::vector<JobWorkingSet> workingSets() const {
+        std::vector<JobWorkingSet> sets;
+        sets.reserve(jobs.size());
+        for (const auto& entry : jobs) sets.push_back(entry.second.stats);
+        std::sort(sets.begin(), sets.end(),
+                  [](const JobWorkingSet& a, const JobWorkingSet& b) { return a.jobId < b.jobId; });
+        return sets;
+    }
+};
+
+/**
+ * Print the reuse-distance histogram, the LRU miss-ratio curve it implies,
+ * and working-set sizes
+ */
+inline void printAccessReport(std::ostream& out, const AccessAnalyzer& analyzer) {
+    uint64_t accesses = analyzer.accessCount();
+    
+    out << "\n=== Access Analysis ===" << std::endl;
+    out << "Accesses: " << accesses << " (reuse depth " << analyzer.getDepth()
+        << " pages, working-set window " << analyzer.getWindow() << " accesses)" << std::endl;
+    if (accesses == 0) return;
+    
+    out << "\nReuse Distance:" << std::endl;
+    out << std::setw(24) << "Distance" << std::setw(14) << "Accesses" << std::setw(10) << "Share" << std::endl;
+    out << std::string(48, '-') << std::endl;
+    for (int b = 0; b < AccessAnalyzer::DISTANCE_BUCKETS; b++) {
+        uint64_t count = analyzer.distanceCount(b);
+        if (count == 0) continue;
+        std::string range = b <= 1 ? std::to_string(b)
+                                   : std::to_string(uint64_t(1) << (b - 1)) + " - " + std::to_string((uint64_t(1) << b) - 1);
+        out << std::setw(24) << range << std::setw(14) << count << std::setw(9) << std::fixed
+            << std::setprecision(2) << 100.0 * count / accesses << "%" << std::endl;
+    }
+    out << std::setw(24) << "first / beyond depth" << std::setw(14) << analyzer.beyondDepthCount()
+        << std::setw(9) << 100.0 * analyzer.beyondDepthCount() / accesses << "%" << std::endl;
+    
+    // Exact for power-of-two capacities
+    out << "\nLRU Miss Ratio by Capacity (TLB entries or frames):" << std::endl;
+    out << std::setw(12) << "Capacity" << std::setw(12) << "Miss %" << std::endl;
+    out << std::string(24, '-') << std::endl;
+    for (uint64_t capacity = 1; capacity <= analyzer.getDepth(); capacity *= 2) {
+        out << std::setw(12) << capacity << std::setw(11) << std::fixed << std::setprecision(2)
+            << 100.0 * (accesses - analyzer.lruHits(capacity)) / accesses << "%" << std::endl;
+    }
+    
+    std::vector<AccessAnalyzer::JobWorkingSet> sets = analyzer.workingSets();
+    out << "\nWorking Sets (live jobs):" << std::endl;
+    out << std::setw(8) << "Job ID" << std::setw(10) << "Pages" << std::setw(12) << "Accesses"
+        << std::setw(10) << "Current" << std::setw(10) << "Mean" << std::setw(10) << "Peak" << std::endl;
+    out << std::string(60, '-') << std::endl;
+    for (const AccessAnalyzer::JobWorkingSet& set : sets) {
+        out << std::setw(8) << set.jobId << std::setw(10) << set.pageCount << std::setw(12) << set.accesses
+            << std::setw(10) << set.current << std::setw(10) << std::fixed << std::setprecision(1) << set.mean()
+            << std::setw(10) << set.peak << std::endl;
+    }
+    
+    const AccessAnalyzer::FinishedJobs& finished = analyzer.finishedJobs();
+    if (finished.jobs > 0) {
+        out << "Ended jobs: " << finished.jobs << ", mean working set "
+            << (finished.accesses ? finished.sizeSum / finished.accesses : 0.0)
+            << " pages, largest " << finished.peak << " pages" << std::endl;
+    }
+}
+
+#endif // ACCESS_ANALYZER_H
@@ -0,0 +1,282 @@
+/**
+ * Binary Trace Format
+ * 
+ * Fixed-width, memory-mappable encoding of the trace operations described
+ * in trace_replay.h. A binary trace is laid out as:
+ * 
+ *   BinaryTraceHeader                    (64 bytes)
+ *   BinaryTraceRecord[recordCount]       (24 bytes each)
+ *   name table                           (concatenated job names, no separators)
+ * 
+ * All fields are stored in the host's (little-endian) byte order. The
+ * replay driver maps the file and reads records in place, so traces far
+ * larger than RAM replay with no per-record parsing or allocation.
+ */
+
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <istream>
+#include <vector>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace_replay.h"
+
+const char BINARY_TRACE_MAGIC[8] = {'P', 'M', 'T', 'R', 'A', 'C', 'E', '\0'};
+const uint32_t BINARY_TRACE_VERSION = 1;
+const uint32_t BINARY_TRACE_NO_NAME = 0xFFFFFFFFu;  // Record carries no name
+
+/**
+ * File header at offset 0
+ */
+struct BinaryTraceHeader {
+    char magic[8];             // BINARY_TRACE_MAGIC
+    uint32_t version;          // BINARY_TRACE_VERSION
+    uint32_t recordSize;       // sizeof(BinaryTraceRecord)
+    uint64_t recordCount;      // Number of records following the header
+    uint64_t nameTableOffset;  // File offset of the name table
+    uint64_t nameTableSize;    // Size of the name table in bytes
+    uint8_t reserved[24];      // Zero; pads the header to 64 bytes
+};
+
+/**
+ * One operation
+ */
+struct BinaryTraceRecord {
+    uint8_t opcode;            // TraceOp::Kind
+    uint8_t reserved[3];       // Zero
+    int32_t jobId;             // Trace-local job identifier
+    int64_t value;             // Job size or logical address
+    uint32_t nameOffset;       // Offset into the name table, or BINARY_TRACE_NO_NAME
+    uint32_t nameLength;       // Name length in bytes
+};
+
+static_assert(sizeof(BinaryTraceHeader) == 64, "binary trace header must be 64 bytes");
+static_assert(sizeof(BinaryTraceRecord) == 24, "binary trace record must be 24 bytes");
+
+/**
+ * Read-only memory mapping of a binary trace, usable as a replay source
+ */
+class MappedBinaryTrace {
+private:
+    void* mapping;               // Whole-file mapping
+    size_t mappingSize;
+    const BinaryTraceRecord* records;
+    size_t recordCount;
+    const char* nameTable;
+    uint64_t nameTableSize;
+    
+    MappedBinaryTrace(const MappedBinaryTrace&);
+    MappedBinaryTrace& operator=(const MappedBinaryTrace&);
+
+public:
+    MappedBinaryTrace() : mapping(nullptr), mappingSize(0), records(nullptr), recordCount(0),
+                          nameTable(nullptr), nameTableSize(0) {}
+    
+    ~MappedBinaryTrace() { close(); }
+    
+    /**
+     * Map a binary trace and validate its header
+     * @param path File to map
+     * @param error Receives the reason on failure
+     * @return true if the trace is mapped and usable
+     */
+    bool open(const std::string& path, std::string& error) {
+        close();
+        
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "Cannot open trace file " + path;
+            return false;
+        }
+        
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(BinaryTraceHeader)) {
+            ::close(fd);
+            error = "Trace file " + path + " is too small to be a binary trace";
+            return false;
+        }
+        
+        size_t size = static_cast<size_t>(info.st_size);
+        void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            error = "Cannot map trace file " + path;
+            return false;
+        }
+        
+        const BinaryTraceHeader* header = static_cast<const BinaryTraceHeader*>(base);
+        uint64_t recordsEnd = sizeof(BinaryTraceHeader) + header->recordCount * sizeof(BinaryTraceRecord);
+        if (std::memcmp(header->magic, BINARY_TRACE_MAGIC, sizeof(BINARY_TRACE_MAGIC)) != 0 ||
+            header->version != BINARY_TRACE_VERSION ||
+            header->recordSize != sizeof(BinaryTraceRecord) ||
+            header->recordCount > (size - sizeof(BinaryTraceHeader)) / sizeof(BinaryTraceRecord) ||
+            header->nameTableOffset < recordsEnd || header->nameTableOffset > size ||
+            header->nameTableSize > size - header->nameTableOffset) {
+            munmap(base, size);
+            error = "Trace file " + path + " has an invalid or unsupported binary header";
+            return false;
+        }
+        
+        // Records are consumed front to back exactly once
+        madvise(base, size, MADV_SEQUENTIAL);
+        
+        mapping = base;
+        mappingSize = size;
+        records = reinterpret_cast<const BinaryTraceRecord*>(static_cast<const char*>(base) + sizeof(BinaryTraceHeader));
+        recordCount = static_cast<size_t>(header->recordCount);
+        nameTable = static_cast<const char*>(base) + header->nameTableOffset;
+        nameTableSize = header->nameTableSize;
+        return true;
+    }
+    
+    /**
+     * Unmap the trace (no-op if nothing is mapped)
+     */
+    void close() {
+        if (mapping) munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+        records = nullptr;
+        recordCount = 0;
+        nameTable = nullptr;
+        nameTableSize = 0;
+    }
+    
+    size_t size() const { return recordCount; }
+    
+    /**
+     * Decode a record in place; names outside the name table read as empty
+     */
+    TraceOpView operator[](size_t i) const {
+        const BinaryTraceRecord& record = records[i];
+        TraceOp::Kind kind = record.opcode < TRACE_OP_KINDS ? static_cast<TraceOp::Kind>(record.opcode)
+                                                            : TraceOp::DISPLAY;
+        TraceOpView view = {kind, record.jobId, record.value, "", 0};
+        if (record.nameOffset != BINARY_TRACE_NO_NAME &&
+            static_cast<uint64_t>(record.nameOffset) + record.nameLength <= nameTableSize) {
+            view.name = nameTable + record.nameOffset;
+            view.nameLength = record.nameLength;
+        }
+        return view;
+    }
+    
+    /**
+     * Check whether a file starts with the binary trace magic
+     */
+    static bool isBinaryTrace(const std::string& path) {
+        char magic[sizeof(BINARY_TRACE_MAGIC)];
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        bool matches = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                       std::memcmp(magic, BINARY_TRACE_MAGIC, sizeof(magic)) == 0;
+        std::fclose(file);
+        return matches;
+    }
+};
+
+/**
+ * Convert a text trace to the binary format
+ * 
+ * Streams the input line by line, so only the (deduplicated) job names are
+ * held in memory while converting.
+ * @param in Text trace
+ * @param outPath Binary trace to write
+ * @param recordsWritten Receives the number of records written
+ * @param error Receives the reason on failure
+ * @return true on success
+ */
+inline bool convertTextTrace(std::istream& in, const std::string& outPath,
+                             uint64_t& recordsWritten, std::string& error) {
+    FILE* out = std::fopen(outPath.c_str(), "wb");
+    if (!out) {
+        error = "Cannot create " + outPath;
+        return false;
+    }
+    
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+    
+    // Header is rewritten with the final counts once all records are out
+    BinaryTraceHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BINARY_TRACE_MAGIC, sizeof(BINARY_TRACE_MAGIC));
+    header.version = BINARY_TRACE_VERSION;
+    header.recordSize = sizeof(BinaryTraceRecord);
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1;
+    
+    std::unordered_map<std::string, uint32_t> nameOffsets;
+    std::string nameTable;
+    std::string line;
+    TraceOp op = {TraceOp::DISPLAY, 0, 0, std::string()};
+    int lineNumber = 0;
+    recordsWritten = 0;
+    
+    while (ok && std::getline(in, line)) {
+        lineNumber++;
+        
+        TraceLineStatus status = parseTraceLine(line, op);
+        if (status == TRACE_LINE_BLANK) continue;
+        if (status == TRACE_LINE_MALFORMED) {
+            error = "Malformed trace line " + std::to_string(lineNumber) + ": " + line;
+            ok = false;
+            break;
+        }
+        
+        BinaryTraceRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.opcode = static_cast<uint8_t>(op.kind);
+        record.jobId = op.jobId;
+        record.value = op.value;
+        record.nameOffset = BINARY_TRACE_NO_NAME;
+        
+        if (op.kind == TraceOp::ACCEPT) {
+            // Identical names share one name-table entry
+            auto it = nameOffsets.find(op.name);
+            if (it == nameOffsets.end()) {
+                // Offsets are 32-bit and the top value means "no name"
+                if (op.name.size() >= BINARY_TRACE_NO_NAME - nameTable.size()) {
+                    error = "Name table exceeds 4 GiB at trace line " + std::to_string(lineNumber);
+                    ok = false;
+                    break;
+                }
+                it = nameOffsets.insert(std::make_pair(op.name, static_cast<uint32_t>(nameTable.size()))).first;
+                nameTable += op.name;
+            }
+            record.nameOffset = it->second;
+            record.nameLength = static_cast<uint32_t>(op.name.size());
+        }
+        
+        ok = std::fwrite(&record, sizeof(record), 1, out) == 1;
+        recordsWritten++;
+    }
+    
+    if (!ok && error.empty()) error = "Failed writing " + outPath;
+    
+    if (ok) {
+        header.recordCount = recordsWritten;
+        header.nameTableOffset = sizeof(header) + recordsWritten * sizeof(BinaryTraceRecord);
+        header.nameTableSize = nameTable.size();
+        ok = std::fwrite(nameTable.data(), 1, nameTable.size(), out) == nameTable.size() &&
+             std::fseek(out, 0, SEEK_SET) == 0 &&
+             std::fwrite(&header, sizeof(header), 1, out) == 1;
+        if (!ok) error = "Failed writing " + outPath;
+    }
+    
+    if (std::fclose(out) != 0 && ok) {
+        error = "Failed writing " + outPath;
+        ok = false;
+    }
+    return ok;
+}
+
+#endif // BINARY_TRACE_H
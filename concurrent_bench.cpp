@@ -0,0 +1,246 @@
+/**
+ * Concurrent Translation Benchmark
+ * 
+ * Measures lock-free translation throughput of ConcurrentPagedMemoryManager
+ * as the number of translating threads grows from 1 to 32, optionally while
+ * a writer thread keeps accepting and removing jobs. With --alloc it instead
+ * measures accept/remove throughput with every thread allocating, which
+ * exercises the sharded free-frame pool.
+ * 
+ * Usage: concurrent_bench [--jobs N] [--job-pages N] [--batch N] [--millis N] [--churn] [--alloc]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+
+#include "concurrent_memory.h"
+
+using namespace std;
+
+struct BenchConfig {
+    int jobs;          // Jobs translated against
+    int jobPages;      // Pages per job
+    int batch;         // Addresses per translateBatch call
+    int millis;        // Measurement time per thread count
+    bool churn;        // Run a writer concurrently
+    bool alloc;        // Measure accept/remove instead of translation
+};
+
+/**
+ * Small per-thread generator so address selection does not dominate timing
+ */
+static inline uint64_t nextRandom(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/**
+ * Run one measurement with the given number of translating threads
+ * @return Translations per second summed over all threads
+ */
+static double measure(ConcurrentPagedMemoryManager& manager, const vector<int>& jobIds,
+                      const BenchConfig& config, int threadCount) {
+    const Address jobSize = static_cast<Address>(config.jobPages) * manager.getPageSize();
+    atomic<bool> started(false);
+    atomic<bool> running(true);
+    atomic<int> ready(0);
+    vector<uint64_t> translated(threadCount, 0);
+    vector<thread> workers;
+    
+    for (int t = 0; t < threadCount; t++) {
+        workers.push_back(thread([&, t]() {
+            int reader = manager.registerReader();
+            uint64_t state = 0x9E3779B97F4A7C15ull * (t + 1);
+            vector<Address> logical(config.batch);
+            vector<Address> physical(config.batch);
+            uint64_t done = 0;
+            
+            ready++;
+            while (!started.load(memory_order_acquire)) this_thread::yield();
+            while (running.load(memory_order_relaxed)) {
+                int jobId = jobIds[nextRandom(state) % jobIds.size()];
+                for (int i = 0; i < config.batch; i++) logical[i] = nextRandom(state) % jobSize;
+                manager.translateBatch(reader, jobId, logical.data(), config.batch, physical.data());
+                done += config.batch;
+            }
+            
+            translated[t] = done;
+            manager.unregisterReader(reader);
+        }));
+    }
+    
+    // Start the clock only once every thread is registered
+    while (ready.load() < threadCount) this_thread::yield();
+    auto start = chrono::steady_clock::now();
+    started.store(true, memory_order_release);
+    this_thread::sleep_for(chrono::milliseconds(config.millis));
+    running = false;
+    for (thread& worker : workers) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    uint64_t total = 0;
+    for (uint64_t count : translated) total += count;
+    return total / seconds;
+}
+
+/**
+ * Run one measurement with every thread accepting and removing its own jobs
+ * @return Accept+remove pairs per second summed over all threads
+ */
+static double measureAlloc(ConcurrentPagedMemoryManager& manager, const BenchConfig& config, int threadCount) {
+    const Address jobSize = static_cast<Address>(config.jobPages) * manager.getPageSize();
+    atomic<bool> started(false);
+    atomic<bool> running(true);
+    atomic<int> ready(0);
+    vector<uint64_t> completed(threadCount, 0);
+    vector<thread> workers;
+    
+    for (int t = 0; t < threadCount; t++) {
+        workers.push_back(thread([&, t]() {
+            vector<int> owned;
+            uint64_t done = 0;
+            
+            ready++;
+            while (!started.load(memory_order_acquire)) this_thread::yield();
+            while (running.load(memory_order_relaxed)) {
+                // Keep a few jobs live so frees and allocations interleave
+                if (owned.size() == 4) {
+                    manager.removeJob(owned.front());
+                    owned.erase(owned.begin());
+                    done++;
+                }
+                AcceptResult result = manager.acceptJob("alloc", jobSize);
+                if (result.success) owned.push_back(result.jobId);
+            }
+            for (int jobId : owned) manager.removeJob(jobId);
+            completed[t] = done;
+        }));
+    }
+    
+    while (ready.load() < threadCount) this_thread::yield();
+    auto start = chrono::steady_clock::now();
+    started.store(true, memory_order_release);
+    this_thread::sleep_for(chrono::milliseconds(config.millis));
+    running = false;
+    for (thread& worker : workers) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    uint64_t total = 0;
+    for (uint64_t count : completed) total += count;
+    return total / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config = {64, 256, 16, 500, false, false};
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--churn") {
+            config.churn = true;
+        } else if (arg == "--alloc") {
+            config.alloc = true;
+        } else if (i + 1 < argc && (arg == "--jobs" || arg == "--job-pages" || arg == "--batch" || arg == "--millis")) {
+            int value = atoi(argv[++i]);
+            if (value <= 0) {
+                cout << "Error: " << arg << " must be positive" << endl;
+                return 1;
+            }
+            if (arg == "--jobs") config.jobs = value;
+            else if (arg == "--job-pages") config.jobPages = value;
+            else if (arg == "--batch") config.batch = value;
+            else config.millis = value;
+        } else {
+            cout << "Usage: " << argv[0] << " [--jobs N] [--job-pages N] [--batch N] [--millis N] [--churn] [--alloc]" << endl;
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    
+    static const int threadCounts[] = {1, 2, 4, 8, 16, 32};
+    const uint32_t pageSize = 4096;
+    
+    if (config.alloc) {
+        // Room for every thread's live jobs at the highest thread count
+        ConcurrentPagedMemoryManager manager(pageSize, static_cast<FrameId>(32 * 4 + 1) * config.jobPages);
+        cout << "Accept/remove throughput (" << config.jobPages << "-page jobs, "
+             << manager.getShardCount() << " frame shards)" << endl;
+        cout << setw(8) << "Threads" << setw(18) << "Pairs/s" << setw(10) << "Speedup" << endl;
+        cout << string(36, '-') << endl;
+        
+        double baseline = 0;
+        for (int threadCount : threadCounts) {
+            double rate = measureAlloc(manager, config, threadCount);
+            if (baseline == 0) baseline = rate;
+            cout << setw(8) << threadCount << setw(18) << fixed << setprecision(0) << rate
+                 << setw(9) << setprecision(2) << rate / baseline << "x" << endl;
+        }
+        cout << "Hardware threads: " << thread::hardware_concurrency() << endl;
+        return 0;
+    }
+    
+    // Room for the translated jobs plus the churning writer's working set
+    FrameId frames = static_cast<FrameId>(config.jobs + 16) * config.jobPages;
+    ConcurrentPagedMemoryManager manager(pageSize, frames);
+    
+    vector<int> jobIds;
+    for (int j = 0; j < config.jobs; j++) {
+        AcceptResult result = manager.acceptJob("bench" + to_string(j),
+                                                static_cast<Address>(config.jobPages) * pageSize);
+        if (result.success) jobIds.push_back(result.jobId);
+    }
+    if (jobIds.empty()) {
+        cout << "Error: no job fits in " << frames << " frames" << endl;
+        return 1;
+    }
+    
+    // Writer that keeps replacing a small set of jobs while readers run
+    atomic<bool> churning(config.churn);
+    atomic<uint64_t> writes(0);
+    thread writer;
+    if (config.churn) {
+        writer = thread([&]() {
+            vector<int> owned;
+            while (churning.load(memory_order_relaxed)) {
+                if (owned.size() == 16) {
+                    manager.removeJob(owned.front());
+                    owned.erase(owned.begin());
+                }
+                AcceptResult result = manager.acceptJob("churn", static_cast<Address>(config.jobPages) * pageSize);
+                if (result.success) {
+                    owned.push_back(result.jobId);
+                    writes++;
+                }
+            }
+            for (int jobId : owned) manager.removeJob(jobId);
+        });
+    }
+    
+    cout << "Translation throughput (" << config.jobs << " jobs x " << config.jobPages << " pages, batch "
+         << config.batch << (config.churn ? ", concurrent writer" : "") << ")" << endl;
+    cout << setw(8) << "Threads" << setw(18) << "Translations/s" << setw(10) << "Speedup" << endl;
+    cout << string(36, '-') << endl;
+    
+    double baseline = 0;
+    for (int threadCount : threadCounts) {
+        double rate = measure(manager, jobIds, config, threadCount);
+        if (baseline == 0) baseline = rate;
+        cout << setw(8) << threadCount << setw(18) << fixed << setprecision(0) << rate
+             << setw(9) << setprecision(2) << rate / baseline << "x" << endl;
+    }
+    
+    if (config.churn) {
+        churning = false;
+        writer.join();
+        cout << "Writer accepts completed: " << writes.load() << endl;
+    }
+    
+    cout << "Hardware threads: " << thread::hardware_concurrency() << endl;
+    return 0;
+}
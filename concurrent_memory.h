@@ -0,0 +1,390 @@
+/**
+ * Concurrent Paged Memory Manager
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ * 
+ * Lets many simulated CPUs translate addresses against one manager while
+ * jobs are accepted and removed.
+ * 
+ * Memory model:
+ * - acceptJob/removeJob may be called from any number of threads. Frames
+ *   come from a ShardedFramePool (one shard per allocating thread), so
+ *   allocating and freeing frames does not contend on a global lock; only
+ *   the short job-directory update is serialized by a mutex.
+ * - For each accepted job the writer publishes an immutable translation
+ *   snapshot (size and page table) into a job directory with a release
+ *   store; translating threads read it with acquire loads and never block
+ *   or write shared memory other than their own reader slot.
+ * - Removal unlinks the snapshot and retires it through epoch-based
+ *   reclamation, so it is deleted only after every translation that could
+ *   have seen it has finished. A translation that overlaps a removal may
+ *   observe either the old mapping or "no such job".
+ * - Translations do not go through a TLB; PagedMemoryManager's TLB is
+ *   single-threaded state.
+ */
+
+#ifndef CONCURRENT_MEMORY_H
+#define CONCURRENT_MEMORY_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+#include "paged_memory.h"
+#include "epoch_reclaimer.h"
+#include "sharded_frame_pool.h"
+#include "memory_stats.h"
+
+class ConcurrentPagedMemoryManager {
+private:
+    /**
+     * Immutable per-job translation snapshot
+     */
+    struct JobMapping {
+        const std::string* name;   // Interned in jobNames
+        Address size;
+        std::vector<FrameId> frameTable;
+    };
+    
+    /**
+     * Open-addressed job directory (linear probing)
+     * 
+     * Job IDs are never reused, so removal leaves the key in place with a
+     * null mapping; probe chains stay intact and readers need no tombstone
+     * handling beyond treating null as absent. The writer replaces the whole
+     * directory when live entries plus tombstones reach half the capacity.
+     */
+    struct Directory {
+        struct Slot {
+            std::atomic<int> jobId;                   // 0 = never used
+            std::atomic<const JobMapping*> mapping;   // nullptr once removed
+        };
+        
+        size_t mask;
+        size_t usedSlots;                             // Writer-only: slots with a key
+        Slot* slots;
+        
+        explicit Directory(size_t capacity) : mask(capacity - 1), usedSlots(0), slots(new Slot[capacity]) {
+            for (size_t i = 0; i < capacity; i++) {
+                slots[i].jobId.store(0, std::memory_order_relaxed);
+                slots[i].mapping.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        
+        ~Directory() { delete[] slots; }
+        
+        size_t capacity() const { return mask + 1; }
+        
+        static size_t hash(int jobId) { return static_cast<uint32_t>(jobId) * 2654435761u; }
+        
+        const JobMapping* find(int jobId) const {
+            for (size_t i = hash(jobId) & mask;; i = (i + 1) & mask) {
+                int key = slots[i].jobId.load(std::memory_order_acquire);
+                if (key == jobId) return slots[i].mapping.load(std::memory_order_acquire);
+                if (key == 0) return nullptr;
+            }
+        }
+        
+        // Writer-only: caller guarantees a free slot exists
+        void insert(int jobId, const JobMapping* mapping) {
+            size_t i = hash(jobId) & mask;
+            while (slots[i].jobId.load(std::memory_order_relaxed) != 0) i = (i + 1) & mask;
+            slots[i].mapping.store(mapping, std::memory_order_relaxed);
+            slots[i].jobId.store(jobId, std::memory_order_release);
+            usedSlots++;
+        }
+        
+        // Writer-only: detach a mapping, returning it for retirement
+        const JobMapping* unlink(int jobId) {
+            for (size_t i = hash(jobId) & mask;; i = (i + 1) & mask) {
+                int key = slots[i].jobId.load(std::memory_order_relaxed);
+                if (key == jobId) return slots[i].mapping.exchange(nullptr, std::memory_order_release);
+                if (key == 0) return nullptr;
+            }
+        }
+    };
+    
+    static const size_t MIN_DIRECTORY_CAPACITY = 64;
+    
+    uint32_t pageSize;
+    FrameId totalFrames;
+    int pageShift;                         // log2(pageSize), or -1 if not a power of two
+    
+    ShardedFramePool freeFrames;
+    std::atomic<int> nextJobId;
+    
+    std::mutex writeLock;                  // Serializes directory updates
+    std::atomic<Directory*> directory;
+    size_t liveJobs;                       // Guarded by writeLock
+    EpochReclaimer reclaimer;              // retire/reclaim guarded by writeLock
+    StringTable jobNames;                  // Job names, guarded by writeLock
+    ConcurrentOperationStats stats;        // Per-thread counters, merged on read
+    
+    ConcurrentPagedMemoryManager(const ConcurrentPagedMemoryManager&);
+    ConcurrentPagedMemoryManager& operator=(const ConcurrentPagedMemoryManager&);
+    
+    /**
+     * Index of the calling thread, in the order threads first ask for one
+     */
+    static int threadIndex() {
+        static std::atomic<int> nextThread(0);
+        static thread_local int index = nextThread.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+    
+    /**
+     * Shard owned by the calling thread; threads are spread round-robin
+     * over the shards in the order they first allocate
+     */
+    int threadShard() const { return threadIndex() % freeFrames.getShardCount(); }
+    
+    /**
+     * Make room for one more key, rebuilding the directory without
+     * tombstones when it is half full (caller holds writeLock)
+     */
+    void reserveDirectorySlot() {
+        Directory* current = directory.load(std::memory_order_relaxed);
+        if ((current->usedSlots + 1) * 2 <= current->capacity()) return;
+        
+        size_t capacity = MIN_DIRECTORY_CAPACITY;
+        while (capacity < (liveJobs + 1) * 4) capacity *= 2;
+        
+        Directory* rebuilt = new Directory(capacity);
+        for (size_t i = 0; i < current->capacity(); i++) {
+            const JobMapping* mapping = current->slots[i].mapping.load(std::memory_order_relaxed);
+            if (mapping) rebuilt->insert(current->slots[i].jobId.load(std::memory_order_relaxed), mapping);
+        }
+        directory.store(rebuilt, std::memory_order_release);
+        reclaimer.retire(current);
+    }
+    
+    template <typename Split>
+    static size_t translateMapped(const Split& split, const JobMapping& job, const Address* logicalAddresses,
+                                  size_t count, Address* physicalAddresses) {
+        size_t translated = 0;
+        for (size_t i = 0; i < count; i++) {
+            Address address = logicalAddresses[i];
+            bool inBounds = address < job.size;
+            Address safeAddress = inBounds ? address : 0;
+            Address physical = split.frameBase(job.frameTable[split.pageOf(safeAddress)])
+                             + split.offsetOf(safeAddress);
+            physicalAddresses[i] = inBounds ? physical : TRANSLATION_OUT_OF_BOUNDS;
+            translated += inBounds;
+        }
+        return translated;
+    }
+    
+    // acceptJob without the counters
+    AcceptResult admitJob(const std::string& jobName, Address jobSize) {
+        AcceptResult result = {false, Status::Ok, {{0, 0, 0}, nullptr}, -1, 0, 0};
+        
+        if (jobSize == 0) {
+            result.status = failWith(Status::InvalidSize, result.detail);
+            return result;
+        }
+        
+        Address pagesNeeded = jobSize / pageSize + (jobSize % pageSize != 0);
+        if (pagesNeeded > totalFrames) {
+            result.status = failWith(Status::OutOfFrames, result.detail, pagesNeeded, freeFrames.freeCount());
+            return result;
+        }
+        
+        // Build the page table before publishing; no lock is held here
+        JobMapping* mapping = new JobMapping;
+        mapping->size = jobSize;
+        mapping->frameTable.resize(static_cast<size_t>(pagesNeeded));
+        if (!freeFrames.take(threadShard(), mapping->frameTable.size(), mapping->frameTable.data())) {
+            delete mapping;
+            result.status = failWith(Status::OutOfFrames, result.detail, pagesNeeded, freeFrames.freeCount());
+            return result;
+        }
+        
+        result.jobId = nextJobId.fetch_add(1, std::memory_order_relaxed);
+        
+        {
+            std::lock_guard<std::mutex> guard(writeLock);
+            mapping->name = jobNames.intern(jobName);
+            reserveDirectorySlot();
+            directory.load(std::memory_order_relaxed)->insert(result.jobId, mapping);
+            liveJobs++;
+            reclaimer.reclaim();
+        }
+        
+        result.success = true;
+        result.pagesAllocated = static_cast<PageId>(pagesNeeded);
+        result.internalFragmentation = jobSize % pageSize ? pageSize - jobSize % pageSize : 0;
+        return result;
+    }
+    
+    // removeJob without the counters
+    RemoveResult releaseJob(int jobId) {
+        RemoveResult result = {false, Status::Ok, {{0, 0, 0}, nullptr}, nullptr, 0, 0};
+        
+        if (jobId <= 0) {
+            result.status = failWith(Status::InvalidJobId, result.detail, static_cast<uint64_t>(jobId));
+            return result;
+        }
+        
+        // Unlinking hands this thread sole ownership until it retires the mapping
+        JobMapping* mapping;
+        {
+            std::lock_guard<std::mutex> guard(writeLock);
+            mapping = const_cast<JobMapping*>(directory.load(std::memory_order_relaxed)->unlink(jobId));
+            if (mapping) liveJobs--;
+        }
+        if (!mapping) {
+            result.status = failWith(Status::NoSuchJob, result.detail, static_cast<uint64_t>(jobId));
+            return result;
+        }
+        
+        freeFrames.release(threadShard(), mapping->frameTable.data(), mapping->frameTable.size());
+        result.success = true;
+        result.jobName = mapping->name;
+        result.pagesFreed = static_cast<PageId>(mapping->frameTable.size());
+        result.framesFreed = static_cast<FrameId>(mapping->frameTable.size());
+        
+        std::lock_guard<std::mutex> guard(writeLock);
+        reclaimer.retire(mapping);
+        reclaimer.reclaim();
+        return result;
+    }
+
+public:
+    /**
+     * Constructor - Same parameters and validation as PagedMemoryManager
+     * @param shardCount Free-frame shards; 0 uses one per hardware thread
+     */
+    ConcurrentPagedMemoryManager(uint32_t pageSize, FrameId totalFrames, int shardCount = 0)
+        : pageSize(pageSize), totalFrames(totalFrames), pageShift(-1),
+          freeFrames(totalFrames <= MAX_FRAMES ? totalFrames : 0,
+                     shardCount > 0 ? shardCount : static_cast<int>(std::thread::hardware_concurrency())),
+          nextJobId(1), directory(nullptr), liveJobs(0) {
+        if (pageSize == 0 || totalFrames == 0) {
+            throw std::invalid_argument("Page size and frame count must be positive");
+        }
+        if (totalFrames > MAX_FRAMES) {
+            throw std::invalid_argument("Frame count exceeds the 32-bit frame ID range");
+        }
+        
+        directory.store(new Directory(MIN_DIRECTORY_CAPACITY), std::memory_order_relaxed);
+        if ((pageSize & (pageSize - 1)) == 0) {
+            pageShift = 0;
+            while ((uint32_t(1) << pageShift) < pageSize) pageShift++;
+        }
+    }
+    
+    /**
+     * Destructor - No reader may be translating
+     */
+    ~ConcurrentPagedMemoryManager() {
+        Directory* current = directory.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < current->capacity(); i++) {
+            delete current->slots[i].mapping.load(std::memory_order_relaxed);
+        }
+        delete current;
+    }
+    
+    /**
+     * Accept a job, placing its pages on random frames of the calling
+     * thread's shard
+     * @see PagedMemoryManager::acceptJob
+     */
+    AcceptResult acceptJob(const std::string& jobName, Address jobSize) {
+        AcceptResult result = admitJob(jobName, jobSize);
+        stats.accepted(threadIndex(), result.status);
+        return result;
+    }
+    
+    /**
+     * Remove a job, returning its frames to the calling thread's shard
+     * 
+     * The frames are reusable immediately; the page table is freed once no
+     * translation can still be using it.
+     * @see PagedMemoryManager::removeJob
+     */
+    RemoveResult removeJob(int jobId) {
+        RemoveResult result = releaseJob(jobId);
+        stats.removed(threadIndex(), result.status);
+        return result;
+    }
+    
+    /**
+     * Claim a reader slot; every translating thread needs its own
+     * @return Slot to pass to translate calls, or -1 if none is free
+     */
+    int registerReader() { return reclaimer.registerReader(); }
+    
+    /**
+     * Release a slot obtained from registerReader()
+     */
+    void unregisterReader(int reader) { reclaimer.unregisterReader(reader); }
+    
+    /**
+     * Translate one logical address without taking any lock
+     * @param reader Slot from registerReader() owned by the calling thread
+     * @return Physical address, TRANSLATION_OUT_OF_BOUNDS or TRANSLATION_NO_SUCH_JOB
+     */
+    Address translate(int reader, int jobId, Address logicalAddress) {
+        Address physical;
+        translateBatch(reader, jobId, &logicalAddress, 1, &physical);
+        return physical;
+    }
+    
+    /**
+     * Translate a batch of logical addresses for one job without taking any
+     * lock; the whole batch sees one consistent page table
+     * @param reader Slot from registerReader() owned by the calling thread
+     * @see PagedMemoryManager::resolveAddresses for the output convention
+     * @return Number of addresses translated successfully
+     */
+    size_t translateBatch(int reader, int jobId, const Address* logicalAddresses, size_t count,
+                          Address* physicalAddresses) {
+        reclaimer.enter(reader);
+        
+        const JobMapping* job = directory.load(std::memory_order_acquire)->find(jobId);
+        size_t translated = 0;
+        if (!job) {
+            std::fill(physicalAddresses, physicalAddresses + count, TRANSLATION_NO_SUCH_JOB);
+        } else if (pageShift == 12) {
+            translated = translateMapped(FixedShiftPageSplit<12>(), *job, logicalAddresses, count, physicalAddresses);
+        } else if (pageShift >= 0) {
+            translated = translateMapped(ShiftPageSplit(pageShift), *job, logicalAddresses, count, physicalAddresses);
+        } else {
+            translated = translateMapped(DividePageSplit(pageSize), *job, logicalAddresses, count,
+                                         physicalAddresses);
+        }
+        
+        reclaimer.exit(reader);
+        stats.translatedBatch(reader, count, translated);
+        return translated;
+    }
+    
+    // Read-only configuration (fixed at construction, safe from any thread)
+    uint32_t getPageSize() const { return pageSize; }
+    FrameId getTotalFrames() const { return totalFrames; }
+    int getShardCount() const { return freeFrames.getShardCount(); }
+    
+    /**
+     * Operation counters summed over every thread (all zero when built with
+     * PAGED_MEMORY_STATS=0)
+     */
+    StatCounters getOperationCounters() const { return stats.counters(); }
+    
+    /**
+     * Make frame selection reproducible; call before other threads start
+     * allocating (which shard a thread uses still depends on thread start order)
+     */
+    void seedRandom(uint64_t seed) { freeFrames.seed(seed); }
+    
+    /**
+     * Used frames, including frames reserved by accepts still in flight
+     */
+    FrameId getUsedFrames() const { return totalFrames - freeFrames.freeCount(); }
+};
+
+#endif // CONCURRENT_MEMORY_H
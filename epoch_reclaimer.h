@@ -0,0 +1,152 @@
+/**
+ * Epoch-Based Reclamation
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Deferred freeing of objects that lock-free readers may still be using
+ * 
+ * Readers bracket every access with enter()/exit() on a slot obtained from
+ * registerReader(). enter() publishes the global epoch the reader started
+ * in; exit() marks the slot quiescent again. A writer unlinks an object so
+ * no new reader can reach it, then retires it: the object is tagged with
+ * the current epoch and the epoch advances. It is deleted once every slot
+ * is either quiescent or entered in a later epoch, since such a reader
+ * started after the unlink and cannot hold a reference.
+ * 
+ * enter()/exit() are wait-free. retire() and reclaim() are meant to be
+ * called by one writer at a time (callers serialize them).
+ */
+class EpochReclaimer {
+public:
+    static const int MAX_READERS = 64;
+
+private:
+    // One cache line per slot so readers never write to a shared line
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch;   // Epoch entered in, 0 when quiescent
+        std::atomic<bool> registered;
+    };
+    
+    struct Retired {
+        uint64_t epoch;                // Global epoch at the time of retirement
+        void* object;
+        void (*destroy)(void*);
+    };
+    
+    ReaderSlot slots[MAX_READERS];
+    std::atomic<uint64_t> globalEpoch;
+    std::vector<Retired> retired;      // Writer-owned
+    
+    EpochReclaimer(const EpochReclaimer&);
+    EpochReclaimer& operator=(const EpochReclaimer&);
+    
+    template <typename T>
+    static void destroyObject(void* object) { delete static_cast<T*>(object); }
+
+public:
+    EpochReclaimer() : globalEpoch(1) {
+        for (int i = 0; i < MAX_READERS; i++) {
+            slots[i].epoch.store(0, std::memory_order_relaxed);
+            slots[i].registered.store(false, std::memory_order_relaxed);
+        }
+    }
+    
+    /**
+     * Destructor - Free everything still pending (no reader may be active)
+     */
+    ~EpochReclaimer() {
+        for (const Retired& item : retired) item.destroy(item.object);
+    }
+    
+    /**
+     * Claim a reader slot for the calling thread
+     * @return Slot index, or -1 if all MAX_READERS slots are taken
+     */
+    int registerReader() {
+        for (int i = 0; i < MAX_READERS; i++) {
+            bool expected = false;
+            if (slots[i].registered.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    
+    /**
+     * Give a reader slot back (the reader must be outside enter()/exit())
+     */
+    void unregisterReader(int slot) {
+        slots[slot].epoch.store(0, std::memory_order_release);
+        slots[slot].registered.store(false, std::memory_order_release);
+    }
+    
+    /**
+     * Begin a read-side critical section
+     * 
+     * The fence orders the epoch announcement before every load the reader
+     * makes afterwards, pairing with the fence in reclaim(): either the
+     * writer sees this slot as active, or the reader sees the unlink.
+     */
+    void enter(int slot) {
+        slots[slot].epoch.store(globalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    
+    /**
+     * End a read-side critical section
+     */
+    void exit(int slot) {
+        slots[slot].epoch.store(0, std::memory_order_release);
+    }
+    
+    /**
+     * Schedule an already unlinked object for deletion
+     */
+    template <typename T>
+    void retire(T* object) {
+        Retired item = {globalEpoch.fetch_add(1, std::memory_order_seq_cst), object, &destroyObject<T>};
+        retired.push_back(item);
+    }
+    
+    /**
+     * Delete every retired object no active reader can still reference
+     * @return Number of objects deleted
+     */
+    size_t reclaim() {
+        if (retired.empty()) return 0;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        
+        // Oldest epoch any reader is still inside
+        uint64_t oldestActive = UINT64_MAX;
+        for (int i = 0; i < MAX_READERS; i++) {
+            uint64_t epoch = slots[i].epoch.load(std::memory_order_acquire);
+            if (epoch != 0 && epoch < oldestActive) oldestActive = epoch;
+        }
+        
+        size_t kept = 0;
+        size_t freed = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch < oldestActive) {
+                retired[i].destroy(retired[i].object);
+                freed++;
+            } else {
+                retired[kept++] = retired[i];
+            }
+        }
+        retired.resize(kept);
+        return freed;
+    }
+    
+    size_t pendingCount() const { return retired.size(); }
+};
+
+#endif // EPOCH_RECLAIMER_H
@@ -0,0 +1,82 @@
+/**
+ * Fast Random Number Generator
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef FAST_RANDOM_H
+#define FAST_RANDOM_H
+
+#include <cstdint>
+#include <random>
+
+/**
+ * xoshiro256** (Blackman and Vigna): 32 bytes of state, a handful of
+ * shifts, rotates and multiplies per 64-bit output
+ * 
+ * Satisfies UniformRandomBitGenerator, so it drops into the standard
+ * distributions. Seeding expands one 64-bit value with splitmix64, so equal
+ * seeds give identical sequences and nearby seeds give unrelated ones.
+ */
+class Xoshiro256 {
+private:
+    uint64_t state[4];
+    
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+public:
+    typedef uint64_t result_type;
+    
+    explicit Xoshiro256(uint64_t seedValue = 0) { seed(seedValue); }
+    
+    /**
+     * Restart the sequence from a seed
+     */
+    void seed(uint64_t seedValue) {
+        for (int i = 0; i < 4; i++) state[i] = splitmix64(seedValue);
+    }
+    
+    /**
+     * A seed taken from the system entropy source (one syscall; for
+     * construction, not per-operation use)
+     */
+    static uint64_t entropySeed() {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    }
+    
+    /**
+     * Generator state, for saving and restoring a sequence mid-stream
+     */
+    static const int STATE_WORDS = 4;
+    const uint64_t* stateWords() const { return state; }
+    void restoreState(const uint64_t* words) {
+        for (int i = 0; i < STATE_WORDS; i++) state[i] = words[i];
+    }
+    
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+    
+    result_type operator()() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        
+        return result;
+    }
+};
+
+#endif // FAST_RANDOM_H
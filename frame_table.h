@@ -0,0 +1,288 @@
+/**
+ * Frame Table
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef FRAME_TABLE_H
+#define FRAME_TABLE_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "memory_types.h"
+#include "occupancy_kernels.h"
+
+/**
+ * Physical frame metadata stored as a structure of arrays
+ * 
+ * Occupancy is a bitmap (one bit per frame, 64 frames per word), so scans
+ * that only need to know which frames are in use touch 1/128th of the bytes
+ * a per-frame struct would. Owner and page arrays are read only for frames
+ * that are actually occupied. The frame number is the index, and every
+ * frame is exactly one page in size, so neither is stored.
+ * 
+ * A second bitmap marks frames whose state changed since the last call to
+ * takeChangedFrames, so delta snapshots visit only those frames.
+ * 
+ * A frame may be mapped by several jobs (copy-on-write after a fork). The
+ * owner recorded here is one of them; the others are counted in sharers,
+ * which is only allocated once the first frame is shared.
+ */
+class FrameTable {
+private:
+    std::vector<uint64_t> occupancy;  // Bit f set when frame f is in use
+    std::vector<int> owners;          // Frame -> owning job ID (-1 when free)
+    std::vector<PageId> pages;        // Frame -> logical page number stored there
+    std::vector<uint64_t> changed;    // Bit f set when frame f changed since the last takeChangedFrames
+    std::vector<uint32_t> sharers;    // Frame -> mappings beyond the owner's (empty until a frame is shared)
+    FrameId frameCount;
+
+public:
+    static const int BITS_PER_WORD = 64;
+    
+    /**
+     * Constructor - Start with every frame free
+     * @param totalFrames Total number of physical frames
+     */
+    explicit FrameTable(FrameId totalFrames)
+        : occupancy((static_cast<size_t>(totalFrames) + BITS_PER_WORD - 1) / BITS_PER_WORD, 0),
+          owners(totalFrames, -1), pages(totalFrames, 0),
+          changed((static_cast<size_t>(totalFrames) + BITS_PER_WORD - 1) / BITS_PER_WORD, 0),
+          frameCount(totalFrames) {}
+    
+    /**
+     * Record that a frame now holds a job's page
+     */
+    void occupy(FrameId frameNumber, int jobId, PageId pageNumber) {
+        occupancy[frameNumber / BITS_PER_WORD] |= uint64_t(1) << (frameNumber % BITS_PER_WORD);
+        changed[frameNumber / BITS_PER_WORD] |= uint64_t(1) << (frameNumber % BITS_PER_WORD);
+        owners[frameNumber] = jobId;
+        pages[frameNumber] = pageNumber;
+    }
+    
+    /**
+     * Mark a frame as free
+     */
+    void release(FrameId frameNumber) {
+        occupancy[frameNumber / BITS_PER_WORD] &= ~(uint64_t(1) << (frameNumber % BITS_PER_WORD));
+        changed[frameNumber / BITS_PER_WORD] |= uint64_t(1) << (frameNumber % BITS_PER_WORD);
+        owners[frameNumber] = -1;
+        pages[frameNumber] = 0;
+    }
+    
+    /**
+     * Add a mapping of an occupied frame by another job
+     */
+    void share(FrameId frameNumber) {
+        if (sharers.empty()) sharers.assign(frameCount, 0);
+        sharers[frameNumber]++;
+    }
+    
+    /**
+     * Drop one mapping of a shared frame
+     * @return Mappings left (at least 1; the frame stays occupied)
+     */
+    uint32_t unshare(FrameId frameNumber) { return --sharers[frameNumber] + 1; }
+    
+    /**
+     * Jobs whose page tables map the frame (1 for an unshared occupied frame)
+     */
+    uint32_t mappingCount(FrameId frameNumber) const {
+        return sharers.empty() ? 1 : sharers[frameNumber] + 1;
+    }
+    
+    bool isShared(FrameId frameNumber) const { return !sharers.empty() && sharers[frameNumber] > 0; }
+    
+    bool isOccupied(FrameId frameNumber) const {
+        return (occupancy[frameNumber / BITS_PER_WORD] >> (frameNumber % BITS_PER_WORD)) & 1;
+    }
+    
+    int ownerOf(FrameId frameNumber) const { return owners[frameNumber]; }
+    PageId pageOf(FrameId frameNumber) const { return pages[frameNumber]; }
+    FrameId size() const { return frameCount; }
+    
+    // Raw bitmap access for word-wide scans
+    const uint64_t* occupancyWords() const { return occupancy.data(); }
+    size_t wordCount() const { return occupancy.size(); }
+    
+    // Raw per-frame arrays, for saving state (shareCounts() is empty until a frame is shared)
+    const int* ownerData() const { return owners.data(); }
+    const PageId* pageData() const { return pages.data(); }
+    const std::vector<uint32_t>& shareCounts() const { return sharers; }
+    
+    /**
+     * Replace the whole table with saved arrays (wordCount() words, size()
+     * frames each; shareCounts may be null when no frame was shared). No
+     * frame counts as changed afterwards.
+     */
+    void restore(const uint64_t* occupancyBits, const int* frameOwners, const PageId* framePages,
+                 const uint32_t* shareCounts) {
+        occupancy.assign(occupancyBits, occupancyBits + occupancy.size());
+        owners.assign(frameOwners, frameOwners + frameCount);
+        pages.assign(framePages, framePages + frameCount);
+        if (shareCounts) sharers.assign(shareCounts, shareCounts + frameCount);
+        else sharers.clear();
+        std::fill(changed.begin(), changed.end(), uint64_t(0));
+    }
+    
+    /**
+     * Count occupied frames (vectorized popcount over the bitmap)
+     */
+    FrameId countOccupied() const {
+        return static_cast<FrameId>(occupancyCountOccupied(occupancy.data(), occupancy.size()));
+    }
+    
+    /**
+     * Histogram of runs of consecutive free frames
+     */
+    FreeRunHistogram freeRunHistogram() const {
+        return occupancyFreeRunHistogram(occupancy.data(), frameCount);
+    }
+    
+    /**
+     * Find the first free frame at or after start, skipping full words
+     * @return Frame number, or INVALID_FRAME if none is free
+     */
+    FrameId findFree(FrameId start) const {
+        if (start >= frameCount) return INVALID_FRAME;
+        
+        size_t word = start / BITS_PER_WORD;
+        uint64_t freeBits = ~occupancy[word] & (~uint64_t(0) << (start % BITS_PER_WORD));
+        while (true) {
+            if (freeBits) {
+                uint64_t frame = word * BITS_PER_WORD + static_cast<uint64_t>(__builtin_ctzll(freeBits));
+                return frame < frameCount ? static_cast<FrameId>(frame) : INVALID_FRAME;
+            }
+            if (++word >= occupancy.size()) return INVALID_FRAME;
+            freeBits = ~occupancy[word];
+        }
+    }
+    
+    /**
+     * Find the first occupied frame in [start, limit)
+     * @return Frame number, or limit if every frame in the range is free
+     */
+    FrameId findOccupied(FrameId start, FrameId limit) const {
+        if (limit > frameCount) limit = frameCount;
+        if (start >= limit) return limit;
+        
+        size_t word = start / BITS_PER_WORD;
+        size_t lastWord = (static_cast<size_t>(limit) - 1) / BITS_PER_WORD;
+        uint64_t usedBits = occupancy[word] & (~uint64_t(0) << (start % BITS_PER_WORD));
+        while (true) {
+            if (usedBits) {
+                uint64_t frame = word * BITS_PER_WORD + static_cast<uint64_t>(__builtin_ctzll(usedBits));
+                return frame < limit ? static_cast<FrameId>(frame) : limit;
+            }
+            if (++word > lastWord) return limit;
+            usedBits = occupancy[word];
+        }
+    }
+    
+    /**
+     * Find the last occupied frame in [begin, end), scanning down from end
+     * @return Frame number, or INVALID_FRAME if every frame in the range is free
+     */
+    FrameId findLastOccupied(FrameId begin, FrameId end) const {
+        if (end > frameCount) end = frameCount;
+        if (begin >= end) return INVALID_FRAME;
+        
+        size_t word = (static_cast<size_t>(end) - 1) / BITS_PER_WORD;
+        size_t firstWord = begin / BITS_PER_WORD;
+        uint64_t usedBits = occupancy[word] & (~uint64_t(0) >> (BITS_PER_WORD - 1 - (end - 1) % BITS_PER_WORD));
+        while (true) {
+            if (usedBits) {
+                uint64_t frame = word * BITS_PER_WORD + static_cast<uint64_t>(63 - __builtin_clzll(usedBits));
+                return frame >= begin ? static_cast<FrameId>(frame) : INVALID_FRAME;
+            }
+            if (word-- == firstWord) return INVALID_FRAME;
+            usedBits = occupancy[word];
+        }
+    }
+    
+    /**
+     * Find the lowest run of count free frames inside [begin, end) whose
+     * first frame is a multiple of alignment
+     * @return First frame of the run, or INVALID_FRAME if there is none
+     */
+    FrameId findFreeRun(FrameId count, FrameId alignment, FrameId begin, FrameId end) const {
+        if (count == 0 || alignment == 0) return INVALID_FRAME;
+        if (end > frameCount) end = frameCount;
+        
+        FrameId start = begin;
+        while (true) {
+            start = findFree(start);
+            if (start == INVALID_FRAME || start >= end) return INVALID_FRAME;
+            
+            uint64_t aligned = (static_cast<uint64_t>(start) + alignment - 1) / alignment * alignment;
+            if (aligned + count > end) return INVALID_FRAME;
+            
+            // Only the frames the run needs are checked
+            FrameId runEnd = findOccupied(static_cast<FrameId>(aligned), static_cast<FrameId>(aligned + count));
+            if (runEnd == aligned + count) return static_cast<FrameId>(aligned);
+            start = runEnd;
+        }
+    }
+    
+    /**
+     * Count occupied frames in [begin, end)
+     */
+    FrameId countOccupied(FrameId begin, FrameId end) const {
+        if (end > frameCount) end = frameCount;
+        if (begin >= end) return 0;
+        
+        size_t firstWord = begin / BITS_PER_WORD;
+        size_t lastWord = (static_cast<size_t>(end) - 1) / BITS_PER_WORD;
+        uint64_t headMask = ~uint64_t(0) << (begin % BITS_PER_WORD);
+        uint64_t tailMask = ~uint64_t(0) >> (BITS_PER_WORD - 1 - (end - 1) % BITS_PER_WORD);
+        if (firstWord == lastWord) {
+            return static_cast<FrameId>(__builtin_popcountll(occupancy[firstWord] & headMask & tailMask));
+        }
+        
+        uint64_t used = static_cast<uint64_t>(__builtin_popcountll(occupancy[firstWord] & headMask))
+                      + static_cast<uint64_t>(__builtin_popcountll(occupancy[lastWord] & tailMask))
+                      + occupancyCountOccupied(occupancy.data() + firstWord + 1, lastWord - firstWord - 1);
+        return static_cast<FrameId>(used);
+    }
+    
+    /**
+     * Append every free frame in [begin, end) to out, in ascending order
+     */
+    void collectFree(FrameId begin, FrameId end, std::vector<FrameId>& out) const {
+        if (end > frameCount) end = frameCount;
+        for (FrameId frame = findFree(begin); frame != INVALID_FRAME && frame < end; ) {
+            FrameId runEnd = findOccupied(frame, end);
+            for (FrameId f = frame; f < runEnd; f++) out.push_back(f);
+            if (runEnd >= end) break;
+            frame = findFree(runEnd);
+        }
+    }
+    
+    /**
+     * Append every frame occupied or released since the previous call to
+     * out, in ascending order, and start tracking changes afresh
+     */
+    void takeChangedFrames(std::vector<FrameId>& out) {
+        for (size_t word = 0; word < changed.size(); word++) {
+            for (uint64_t bits = changed[word]; bits; bits &= bits - 1) {
+                out.push_back(static_cast<FrameId>(word * BITS_PER_WORD + __builtin_ctzll(bits)));
+            }
+            changed[word] = 0;
+        }
+    }
+    
+    /**
+     * Collect the lowest-numbered free frames
+     * @param count Number of frames wanted
+     * @param out Receives up to count frame numbers in ascending order
+     * @return Number of frames written
+     */
+    size_t findFreeFrames(size_t count, FrameId* out) const {
+        return occupancyFindFreeFrames(occupancy.data(), frameCount, count, out);
+    }
+};
+
+#endif // FRAME_TABLE_H
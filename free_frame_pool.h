@@ -0,0 +1,102 @@
+/**
+ * Free Frame Pool
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef FREE_FRAME_POOL_H
+#define FREE_FRAME_POOL_H
+
+#include <vector>
+#include <random>
+
+#include "memory_types.h"
+
+/**
+ * Pool of free physical frames, kept up to date on every allocation and free
+ * 
+ * Free frame numbers are stored densely in freeList; position maps each frame
+ * back to its slot (or INVALID_FRAME when occupied) so that any frame can be taken or
+ * returned in O(1) without scanning the frame table.
+ */
+class FreeFramePool {
+private:
+    std::vector<FrameId> freeList;  // Dense list of free frame numbers
+    std::vector<FrameId> position;  // Frame number -> index in freeList, INVALID_FRAME if occupied
+    
+public:
+    /**
+     * Constructor - Start with every frame free
+     * @param totalFrames Total number of physical frames
+     */
+    explicit FreeFramePool(FrameId totalFrames)
+        : freeList(totalFrames), position(totalFrames) {
+        for (FrameId i = 0; i < totalFrames; i++) {
+            freeList[i] = i;
+            position[i] = i;
+        }
+    }
+    
+    /**
+     * @return Number of frames currently free
+     */
+    FrameId size() const {
+        return static_cast<FrameId>(freeList.size());
+    }
+    
+    /**
+     * Remove a specific frame from the pool in O(1)
+     * @param frameNumber Frame to mark as taken (must currently be free)
+     */
+    void take(FrameId frameNumber) {
+        FrameId slot = position[frameNumber];
+        FrameId last = freeList.back();
+        
+        // Move the last free frame into the vacated slot
+        freeList[slot] = last;
+        position[last] = slot;
+        freeList.pop_back();
+        position[frameNumber] = INVALID_FRAME;
+    }
+    
+    /**
+     * Take a uniformly random free frame in O(1)
+     * 
+     * Repeated calls perform a partial Fisher-Yates shuffle over the free
+     * set, so picking n frames costs O(n) regardless of memory size.
+     * @param g Random number generator
+     * @return Selected frame number (pool must not be empty)
+     */
+    template <typename Generator>
+    FrameId takeRandom(Generator& g) {
+        std::uniform_int_distribution<FrameId> pick(0, size() - 1);
+        FrameId frameNumber = freeList[pick(g)];
+        take(frameNumber);
+        return frameNumber;
+    }
+    
+    // Raw arrays, for saving state: freeData() holds size() frames,
+    // positionData() one slot per frame
+    const FrameId* freeData() const { return freeList.data(); }
+    const FrameId* positionData() const { return position.data(); }
+    
+    /**
+     * Replace the pool with saved arrays, keeping their order so random
+     * selection continues exactly where it left off
+     */
+    void restore(const FrameId* freeFrames, FrameId freeCount, const FrameId* positions) {
+        freeList.assign(freeFrames, freeFrames + freeCount);
+        position.assign(positions, positions + position.size());
+    }
+    
+    /**
+     * Return a frame to the pool in O(1)
+     * @param frameNumber Frame to mark as free (must currently be taken)
+     */
+    void release(FrameId frameNumber) {
+        position[frameNumber] = static_cast<FrameId>(freeList.size());
+        freeList.push_back(frameNumber);
+    }
+};
+
+#endif // FREE_FRAME_POOL_H
@@ -0,0 +1,93 @@
+/**
+ * Latency Histogram
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Fixed-size log-linear latency histogram (HDR style)
+ * 
+ * Values below 16 get exact buckets; above that every power of two is split
+ * into 16 linear sub-buckets, bounding the relative error to about 6%.
+ * Recording is a few shifts and an increment, and memory use is constant no
+ * matter how many samples are recorded.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+private:
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    uint64_t maxValue;
+    
+    static int bucketOf(uint64_t value) {
+        if (value < static_cast<uint64_t>(SUB_BUCKETS)) return static_cast<int>(value);
+        int exponent = 63 - __builtin_clzll(value);
+        int sub = static_cast<int>((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+    }
+    
+    // Smallest value that falls into the bucket
+    static uint64_t bucketLowerBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+        int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+        uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+        return (static_cast<uint64_t>(SUB_BUCKETS) | sub) << (exponent - SUB_BUCKET_BITS);
+    }
+
+public:
+    LatencyHistogram() { reset(); }
+    
+    void reset() {
+        std::memset(counts, 0, sizeof(counts));
+        total = 0;
+        maxValue = 0;
+    }
+    
+    /**
+     * Record one sample
+     */
+    void record(uint64_t value) {
+        counts[bucketOf(value)]++;
+        total++;
+        if (value > maxValue) maxValue = value;
+    }
+    
+    /**
+     * Fold another histogram's samples into this one
+     */
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+        total += other.total;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+    
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+    
+    /**
+     * Value at the given percentile (0-100), reported as the lower bound of
+     * the bucket holding that rank
+     */
+    uint64_t percentile(double percentile) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * (total - 1) + 0.5);
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen > rank) return bucketLowerBound(i) < maxValue ? bucketLowerBound(i) : maxValue;
+        }
+        return maxValue;
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_H
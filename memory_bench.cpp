@@ -0,0 +1,344 @@
+/**
+ * Memory Manager Benchmarks
+ * 
+ * Google Benchmark suite for PagedMemoryManager's hot paths: acceptJob as
+ * memory grows from 1K to 10M frames, single and batch translation against
+ * growing job counts, removeJob with many live pages, incremental
+ * compaction steps, mixed churn under each translation mode, and restoring
+ * a filled memory from a state image. `make bench` runs it and writes the
+ * results as JSON so runs can be diffed for regressions.
+ * 
+ * Usage: memory_bench [--benchmark_filter=REGEX] [--benchmark_out=FILE --benchmark_out_format=json]
+ */
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+#include <benchmark/benchmark.h>
+
+#include "paged_memory.h"
+
+using namespace std;
+
+static const uint32_t PAGE_SIZE = 4096;
+static const uint64_t SEED = 42;
+
+/**
+ * Remove every job still listed, leaving memory empty
+ */
+static void removeAll(PagedMemoryManager& manager, vector<int>& jobIds) {
+    for (size_t i = 0; i < jobIds.size(); i++) manager.removeJob(jobIds[i]);
+    jobIds.clear();
+}
+
+/**
+ * Fill memory with jobs of jobPages pages until pageBudget pages are live
+ */
+static vector<int> acceptJobs(PagedMemoryManager& manager, uint64_t pageBudget, uint64_t jobPages) {
+    vector<int> jobIds;
+    for (uint64_t live = 0; live + jobPages <= pageBudget; live += jobPages) {
+        AcceptResult result = manager.acceptJob("job", jobPages * PAGE_SIZE);
+        if (!result.success) break;
+        jobIds.push_back(result.jobId);
+    }
+    return jobIds;
+}
+
+/**
+ * acceptJob of a 64-page job; range(0) is the frame count, range(1) the
+ * placement policy. Memory is emptied (untimed) whenever it fills.
+ */
+static void BM_AcceptJob(benchmark::State& state) {
+    const FrameId totalFrames = static_cast<FrameId>(state.range(0));
+    const PagedMemoryManager::Placement policy = static_cast<PagedMemoryManager::Placement>(state.range(1));
+    const uint64_t jobPages = 64;
+    PagedMemoryManager manager(PAGE_SIZE, totalFrames);
+    manager.seedRandom(SEED);
+    vector<int> jobIds;
+    jobIds.reserve(totalFrames / jobPages + 1);
+    
+    for (auto _ : state) {
+        AcceptResult result = manager.acceptJob("job", jobPages * PAGE_SIZE, policy);
+        if (!result.success) {
+            state.PauseTiming();
+            removeAll(manager, jobIds);
+            state.ResumeTiming();
+            continue;
+        }
+        jobIds.push_back(result.jobId);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(PagedMemoryManager::placementName(policy));
+}
+BENCHMARK(BM_AcceptJob)
+    ->ArgNames({"frames", "placement"})
+    ->ArgsProduct({{1 << 10, 10 << 10, 100 << 10, 1 << 20, 10 << 20},
+                   {PagedMemoryManager::PLACEMENT_RANDOM, PagedMemoryManager::PLACEMENT_FIRST_FIT}});
+
+/**
+ * Fixed set of (job, address) pairs spread over every job, so the loop
+ * measures translation rather than address generation
+ */
+struct AccessSet {
+    vector<int> jobIds;
+    vector<Address> addresses;
+};
+
+static AccessSet makeAccesses(const vector<int>& jobIds, Address jobSize, size_t count) {
+    AccessSet set;
+    Xoshiro256 rng(SEED);
+    set.jobIds.resize(count);
+    set.addresses.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        set.jobIds[i] = jobIds[rng() % jobIds.size()];
+        set.addresses[i] = rng() % jobSize;
+    }
+    return set;
+}
+
+/**
+ * resolveAddress over range(0) live 16-page jobs; range(1) is the TLB size
+ * (0 = no TLB)
+ */
+static void BM_ResolveAddress(benchmark::State& state) {
+    const uint64_t jobCount = static_cast<uint64_t>(state.range(0));
+    const uint64_t jobPages = 16;
+    PagedMemoryManager manager(PAGE_SIZE, static_cast<FrameId>(jobCount * jobPages));
+    manager.seedRandom(SEED);
+    if (state.range(1) > 0) manager.configureTlb(static_cast<int>(state.range(1)), 4, Tlb::POLICY_LRU);
+    vector<int> jobIds = acceptJobs(manager, jobCount * jobPages, jobPages);
+    AccessSet accesses = makeAccesses(jobIds, jobPages * PAGE_SIZE, 1 << 16);
+    
+    size_t next = 0;
+    for (auto _ : state) {
+        TranslationResult result = manager.resolveAddress(accesses.jobIds[next], accesses.addresses[next]);
+        benchmark::DoNotOptimize(result.physicalAddress);
+        next = (next + 1) & (accesses.addresses.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResolveAddress)
+    ->ArgNames({"jobs", "tlb"})
+    ->ArgsProduct({{1, 10, 100, 1000, 10000}, {0, 64}});
+
+/**
+ * resolveAddresses with batches of range(1) addresses into one of range(0)
+ * live 256-page jobs; items are addresses translated
+ */
+static void BM_ResolveAddresses(benchmark::State& state) {
+    const uint64_t jobCount = static_cast<uint64_t>(state.range(0));
+    const size_t batch = static_cast<size_t>(state.range(1));
+    const uint64_t jobPages = 256;
+    PagedMemoryManager manager(PAGE_SIZE, static_cast<FrameId>(jobCount * jobPages));
+    manager.seedRandom(SEED);
+    vector<int> jobIds = acceptJobs(manager, jobCount * jobPages, jobPages);
+    AccessSet accesses = makeAccesses(jobIds, jobPages * PAGE_SIZE, 1 << 16);
+    vector<Address> physical(batch);
+    
+    size_t next = 0;
+    for (auto _ : state) {
+        size_t translated = manager.resolveAddresses(accesses.jobIds[next], &accesses.addresses[next], batch,
+                                                     physical.data());
+        benchmark::DoNotOptimize(translated);
+        benchmark::DoNotOptimize(physical.data());
+        next += batch;
+        if (next + batch > accesses.addresses.size()) next = 0;
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_ResolveAddresses)
+    ->ArgNames({"jobs", "batch"})
+    ->ArgsProduct({{1, 100, 1000}, {16, 256, 4096}});
+
+/**
+ * removeJob of a range(1)-page job with range(0) pages live in other jobs
+ * of the same size; the job is accepted again untimed after each removal
+ */
+static void BM_RemoveJob(benchmark::State& state) {
+    const uint64_t livePages = static_cast<uint64_t>(state.range(0));
+    const uint64_t jobPages = static_cast<uint64_t>(state.range(1));
+    PagedMemoryManager manager(PAGE_SIZE, static_cast<FrameId>(livePages + jobPages));
+    manager.seedRandom(SEED);
+    vector<int> jobIds = acceptJobs(manager, livePages, jobPages);
+    int victim = manager.acceptJob("victim", jobPages * PAGE_SIZE).jobId;
+    
+    for (auto _ : state) {
+        RemoveResult result = manager.removeJob(victim);
+        benchmark::DoNotOptimize(result.pagesFreed);
+        state.PauseTiming();
+        victim = manager.acceptJob("victim", jobPages * PAGE_SIZE).jobId;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * jobPages);
+}
+BENCHMARK(BM_RemoveJob)
+    ->ArgNames({"live_pages", "job_pages"})
+    ->ArgsProduct({{1 << 10, 1 << 16, 1 << 20, 10 << 20}, {64, 4096}});
+
+/**
+ * Fill memory with 16-page jobs and remove every other one, leaving free
+ * frames scattered across the whole memory
+ */
+static void fragment(PagedMemoryManager& manager, vector<int>& jobIds) {
+    removeAll(manager, jobIds);
+    jobIds = acceptJobs(manager, manager.getTotalFrames(), 16);
+    for (size_t i = 0; i < jobIds.size(); i += 2) manager.removeJob(jobIds[i]);
+}
+
+/**
+ * One compactStep of at most range(1) migrations on range(0) frames of
+ * fragmented memory; memory is fragmented again (untimed) after each pass.
+ * Items are pages moved.
+ */
+static void BM_CompactStep(benchmark::State& state) {
+    const FrameId totalFrames = static_cast<FrameId>(state.range(0));
+    const FrameId budget = static_cast<FrameId>(state.range(1));
+    PagedMemoryManager manager(PAGE_SIZE, totalFrames);
+    manager.seedRandom(SEED);
+    vector<int> jobIds;
+    fragment(manager, jobIds);
+    manager.startCompaction();
+    
+    uint64_t moved = 0;
+    for (auto _ : state) {
+        CompactionStep step = manager.compactStep(budget);
+        moved += step.framesMoved;
+        if (step.finished) {
+            state.PauseTiming();
+            fragment(manager, jobIds);
+            manager.startCompaction();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(moved));
+}
+BENCHMARK(BM_CompactStep)
+    ->ArgNames({"frames", "budget"})
+    ->ArgsProduct({{1 << 16, 1 << 20}, {16, 256, 4096}});
+
+enum ChurnMode {
+    CHURN_EAGER,
+    CHURN_TLB,
+    CHURN_DEMAND,
+    CHURN_RADIX,
+    CHURN_HUGE
+};
+
+static const char* churnModeName(ChurnMode mode) {
+    switch (mode) {
+        case CHURN_EAGER: return "eager";
+        case CHURN_TLB: return "tlb";
+        case CHURN_DEMAND: return "demand-lru";
+        case CHURN_RADIX: return "radix-4";
+        default: return "huge-2m";
+    }
+}
+
+/**
+ * Mixed workload on range(0) frames: about 90% single translations, 5%
+ * accepts and 5% removals, with job sizes from 1 to 1024 pages. One item
+ * is one operation. range(1) selects the translation mode.
+ */
+static void BM_Churn(benchmark::State& state) {
+    const FrameId totalFrames = static_cast<FrameId>(state.range(0));
+    const ChurnMode mode = static_cast<ChurnMode>(state.range(1));
+    PagedMemoryManager manager(PAGE_SIZE, totalFrames);
+    manager.seedRandom(SEED);
+    switch (mode) {
+        case CHURN_EAGER: break;
+        case CHURN_TLB: manager.configureTlb(64, 4, Tlb::POLICY_LRU); break;
+        case CHURN_DEMAND: manager.configureDemandPaging(PageReplacer::POLICY_LRU); break;
+        case CHURN_RADIX: manager.configurePageTable(4); break;
+        case CHURN_HUGE: manager.configureHugePages(PagedMemoryManager::HUGE_PAGES_2M); break;
+    }
+    
+    // Start with jobs covering half the frames so accepts and removals both
+    // succeed most of the time (counted in pages, since demand paging maps
+    // nothing at accept time)
+    Xoshiro256 rng(SEED);
+    vector<int> jobIds;
+    vector<Address> jobSizes;
+    for (uint64_t pages = 0; pages < totalFrames / 2;) {
+        uint64_t jobPages = rng() % 1024 + 1;
+        Address size = jobPages * PAGE_SIZE;
+        pages += jobPages;
+        AcceptResult result = manager.acceptJob("job", size);
+        if (!result.success) break;
+        jobIds.push_back(result.jobId);
+        jobSizes.push_back(size);
+    }
+    
+    uint64_t failures = 0;
+    for (auto _ : state) {
+        uint64_t roll = rng();
+        uint32_t op = static_cast<uint32_t>(roll % 20);
+        if (op == 0 || jobIds.empty()) {
+            Address size = ((roll >> 8) % 1024 + 1) * PAGE_SIZE;
+            AcceptResult result = manager.acceptJob("job", size);
+            if (result.success) {
+                jobIds.push_back(result.jobId);
+                jobSizes.push_back(size);
+            } else {
+                failures++;
+            }
+        } else if (op == 1) {
+            size_t victim = static_cast<size_t>((roll >> 8) % jobIds.size());
+            manager.removeJob(jobIds[victim]);
+            jobIds[victim] = jobIds.back();
+            jobSizes[victim] = jobSizes.back();
+            jobIds.pop_back();
+            jobSizes.pop_back();
+        } else {
+            size_t target = static_cast<size_t>((roll >> 8) % jobIds.size());
+            TranslationResult result = manager.resolveAddress(jobIds[target], (roll >> 32) % jobSizes[target]);
+            benchmark::DoNotOptimize(result.physicalAddress);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["failed_accepts"] = static_cast<double>(failures);
+    state.SetLabel(churnModeName(mode));
+}
+BENCHMARK(BM_Churn)
+    ->ArgNames({"frames", "mode"})
+    ->ArgsProduct({{1 << 16, 1 << 20}, {CHURN_EAGER, CHURN_TLB, CHURN_DEMAND, CHURN_RADIX, CHURN_HUGE}});
+
+/**
+ * Restore range(0) frames of memory filled with 64-page jobs from a state
+ * image: construct the manager, map the image and loadState. The image is
+ * written once, untimed. Items are frames restored; compare with filling
+ * the same memory through BM_AcceptJob.
+ */
+static void BM_LoadState(benchmark::State& state) {
+    const FrameId totalFrames = static_cast<FrameId>(state.range(0));
+    const string path = "/tmp/memory_bench_state.img";
+    string error;
+    {
+        PagedMemoryManager manager(PAGE_SIZE, totalFrames);
+        manager.seedRandom(SEED);
+        acceptJobs(manager, totalFrames, 64);
+        if (!manager.saveState(path, error)) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+    }
+    
+    for (auto _ : state) {
+        PagedMemoryManager manager(PAGE_SIZE, totalFrames);
+        MemoryImage image;
+        if (!image.open(path, error) || !manager.loadState(image, error)) {
+            state.SkipWithError(error.c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(manager.getUsedFrames());
+    }
+    std::remove(path.c_str());
+    state.SetItemsProcessed(state.iterations() * totalFrames);
+}
+BENCHMARK(BM_LoadState)
+    ->ArgName("frames")
+    ->Arg(1 << 16)->Arg(1 << 20)->Arg(10 << 20)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,347 @@
+/**
+ * Memory State Image Format
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ * 
+ * Flat, versioned binary image of a PagedMemoryManager's state, written by
+ * saveState() and read back by loadState(). An image is laid out as:
+ * 
+ *   MemoryImageHeader                    (320 bytes, section table included)
+ *   sections, each starting on a 64-byte boundary:
+ *     frame occupancy bitmap             (uint64_t per 64 frames)
+ *     frame owners                       (int32_t per frame)
+ *     frame page numbers                 (uint32_t per frame)
+ *     frame share counts                 (uint32_t per frame, or empty)
+ *     free frame list                    (uint32_t per free frame, in pool order)
+ *     free list positions                (uint32_t per frame)
+ *     job records                        (MemoryImageJob, in job ID order)
+ *     page lists                         (uint32_t: each job's page numbers,
+ *                                         frame table, radix nodes and huge
+ *                                         frames, back to back)
+ *     job names                          (concatenated, no separators)
+ * 
+ * Every array is stored exactly as the manager holds it, in the host's
+ * (little-endian) byte order, so an image is mapped and each section found
+ * by its offset, with no per-record decoding. Loading is still a copying
+ * loader: the manager's arrays are std::vectors that own their storage,
+ * so loadState() validates the sections and copies them into the manager
+ * (one bulk copy per array), interns the job names and inserts each job
+ * into the job index. Its cost grows with the state, but stays well below
+ * rebuilding the state through acceptJob.
+ */
+
+#ifndef MEMORY_IMAGE_H
+#define MEMORY_IMAGE_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "memory_types.h"
+
+const char MEMORY_IMAGE_MAGIC[8] = {'P', 'M', 'S', 'T', 'A', 'T', 'E', '\0'};
+const uint32_t MEMORY_IMAGE_VERSION = 1;
+const uint64_t MEMORY_IMAGE_ALIGNMENT = 64;   // Section start alignment (one cache line)
+
+/**
+ * Sections of an image, in file order
+ */
+enum MemoryImageSectionId {
+    IMAGE_FRAME_OCCUPANCY,
+    IMAGE_FRAME_OWNERS,
+    IMAGE_FRAME_PAGES,
+    IMAGE_FRAME_SHARERS,
+    IMAGE_FREE_LIST,
+    IMAGE_FREE_POSITIONS,
+    IMAGE_JOBS,
+    IMAGE_PAGE_LISTS,
+    IMAGE_NAMES
+};
+
+const int IMAGE_SECTION_COUNT = IMAGE_NAMES + 1;
+
+/**
+ * Where one section lives in the file
+ */
+struct MemoryImageSection {
+    uint64_t offset;           // File offset, a multiple of MEMORY_IMAGE_ALIGNMENT
+    uint64_t count;            // Elements in the section
+    uint32_t elementSize;      // Bytes per element
+    uint32_t reserved;         // Zero
+};
+
+/**
+ * File header at offset 0
+ */
+struct MemoryImageHeader {
+    char magic[8];             // MEMORY_IMAGE_MAGIC
+    uint32_t version;          // MEMORY_IMAGE_VERSION
+    uint32_t headerSize;       // sizeof(MemoryImageHeader)
+    uint64_t fileSize;         // Size of the whole image
+    
+    // Geometry and allocation settings
+    uint32_t pageSize;
+    uint32_t totalFrames;
+    int32_t placement;         // PagedMemoryManager::Placement
+    int32_t numaNodes;
+    int32_t replacement;       // PageReplacer::Policy, or -1 without demand paging
+    int32_t pageTableLevels;
+    int32_t hugePages;         // PagedMemoryManager::HugePages flags
+    
+    // Allocator state
+    int32_t nextJobId;
+    uint32_t nextPageNumber;
+    uint32_t reserved;         // Zero
+    uint64_t sharedMappings;   // Copy-on-write mappings beyond the frames' owners
+    uint64_t rngState[4];      // Frame selection generator
+    
+    MemoryImageSection sections[IMAGE_SECTION_COUNT];
+};
+
+/**
+ * One job; its arrays are consecutive in the page lists section from
+ * listOffset on, in field order
+ */
+struct MemoryImageJob {
+    int32_t id;
+    uint32_t pageCount;
+    uint64_t size;
+    uint32_t firstPage;
+    uint32_t hugeCoveredPages;
+    int32_t forkNext;
+    int32_t forkPrev;
+    uint32_t nameOffset;       // Offset into the names section
+    uint32_t nameLength;
+    uint64_t listOffset;       // First page-list entry of the job's arrays
+    uint32_t pageListLength;   // Page numbers (flat page table only)
+    uint32_t frameTableLength; // Frame table entries
+    uint64_t radixEntries;     // Radix node storage entries (0 with a flat table)
+    uint32_t hugeFrameCounts[HUGE_PAGE_CLASSES];  // Huge pages per class
+    int32_t radixLevels;       // 0 with a flat table
+    uint32_t radixRootEntries;
+    uint64_t radixNodes;
+    uint64_t radixMapped;
+};
+
+static_assert(sizeof(MemoryImageSection) == 24, "image section entry must be 24 bytes");
+static_assert(sizeof(MemoryImageHeader) == 320, "image header must be 320 bytes");
+static_assert(sizeof(MemoryImageHeader) % MEMORY_IMAGE_ALIGNMENT == 0, "image header must keep sections aligned");
+static_assert(sizeof(MemoryImageJob) == 96, "image job record must be 96 bytes");
+
+/**
+ * Element size each section must declare
+ */
+inline uint32_t memoryImageElementSize(int section) {
+    switch (section) {
+        case IMAGE_FRAME_OCCUPANCY: return sizeof(uint64_t);
+        case IMAGE_JOBS: return sizeof(MemoryImageJob);
+        case IMAGE_NAMES: return 1;
+        default: return sizeof(uint32_t);
+    }
+}
+
+/**
+ * Read-only memory mapping of a state image
+ * 
+ * open() checks the header and that every section lies inside the file
+ * with the expected element size. A manager's loadState() checks the
+ * contents: counts against its own geometry, and every frame, page, job
+ * and node index stored against memory, the job table and the sections,
+ * so a corrupted image is rejected rather than trusted.
+ */
+class MemoryImage {
+private:
+    void* mapping;               // Whole-file mapping
+    size_t mappingSize;
+    
+    MemoryImage(const MemoryImage&);
+    MemoryImage& operator=(const MemoryImage&);
+
+public:
+    MemoryImage() : mapping(nullptr), mappingSize(0) {}
+    
+    ~MemoryImage() { close(); }
+    
+    /**
+     * Map an image and validate its layout
+     * @param path File to map
+     * @param error Receives the reason on failure
+     * @return true if the image is mapped and usable
+     */
+    bool open(const std::string& path, std::string& error) {
+        close();
+        
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "Cannot open state image " + path;
+            return false;
+        }
+        
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(MemoryImageHeader)) {
+            ::close(fd);
+            error = "State image " + path + " is too small to hold a header";
+            return false;
+        }
+        
+        size_t size = static_cast<size_t>(info.st_size);
+        void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            error = "Cannot map state image " + path;
+            return false;
+        }
+        
+        const MemoryImageHeader* header = static_cast<const MemoryImageHeader*>(base);
+        bool valid = std::memcmp(header->magic, MEMORY_IMAGE_MAGIC, sizeof(MEMORY_IMAGE_MAGIC)) == 0 &&
+                     header->version == MEMORY_IMAGE_VERSION &&
+                     header->headerSize == sizeof(MemoryImageHeader) &&
+                     header->fileSize == size;
+        for (int s = 0; valid && s < IMAGE_SECTION_COUNT; s++) {
+            const MemoryImageSection& section = header->sections[s];
+            valid = section.elementSize == memoryImageElementSize(s) &&
+                    section.offset % MEMORY_IMAGE_ALIGNMENT == 0 &&
+                    section.offset >= sizeof(MemoryImageHeader) && section.offset <= size &&
+                    section.count <= (size - section.offset) / section.elementSize;
+        }
+        if (!valid) {
+            munmap(base, size);
+            error = "State image " + path + " has an invalid or unsupported header";
+            return false;
+        }
+        
+        // The whole image is about to be read
+        madvise(base, size, MADV_WILLNEED);
+        
+        mapping = base;
+        mappingSize = size;
+        return true;
+    }
+    
+    /**
+     * Unmap the image (no-op if nothing is mapped)
+     */
+    void close() {
+        if (mapping) munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+    
+    bool isOpen() const { return mapping != nullptr; }
+    size_t size() const { return mappingSize; }
+    
+    const MemoryImageHeader& header() const { return *static_cast<const MemoryImageHeader*>(mapping); }
+    
+    uint64_t count(MemoryImageSectionId section) const { return header().sections[section].count; }
+    
+    /**
+     * A section's first element, in place in the mapping
+     */
+    template <typename T>
+    const T* section(MemoryImageSectionId section) const {
+        return reinterpret_cast<const T*>(static_cast<const char*>(mapping) + header().sections[section].offset);
+    }
+};
+
+/**
+ * Writes an image section by section, in section order
+ * 
+ * The header is written last, once every section's offset and count are
+ * known; the caller fills in everything but the magic, version, sizes and
+ * section table.
+ */
+class MemoryImageWriter {
+private:
+    FILE* out;
+    std::vector<char> buffer;
+    uint64_t position;           // Bytes written so far
+    MemoryImageSection sections[IMAGE_SECTION_COUNT];
+    int current;                 // Section being written, -1 before the first
+    bool ok;
+    
+    MemoryImageWriter(const MemoryImageWriter&);
+    MemoryImageWriter& operator=(const MemoryImageWriter&);
+    
+    void write(const void* data, size_t bytes) {
+        if (ok && bytes > 0) ok = std::fwrite(data, 1, bytes, out) == bytes;
+        position += bytes;
+    }
+
+public:
+    MemoryImageWriter() : out(nullptr), position(0), current(-1), ok(false) {
+        std::memset(sections, 0, sizeof(sections));
+    }
+    
+    ~MemoryImageWriter() {
+        if (out) std::fclose(out);
+    }
+    
+    /**
+     * Create the file and reserve room for the header
+     */
+    bool create(const std::string& path, std::string& error) {
+        out = std::fopen(path.c_str(), "wb");
+        if (!out) {
+            error = "Cannot create " + path;
+            return false;
+        }
+        buffer.resize(1 << 20);
+        std::setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+        
+        ok = true;
+        MemoryImageHeader placeholder;
+        std::memset(&placeholder, 0, sizeof(placeholder));
+        write(&placeholder, sizeof(placeholder));
+        return true;
+    }
+    
+    /**
+     * Start the next section, padding to its alignment
+     */
+    void beginSection(MemoryImageSectionId section) {
+        static const char padding[MEMORY_IMAGE_ALIGNMENT] = {0};
+        write(padding, static_cast<size_t>((MEMORY_IMAGE_ALIGNMENT - position % MEMORY_IMAGE_ALIGNMENT)
+                                           % MEMORY_IMAGE_ALIGNMENT));
+        current = section;
+        sections[section].offset = position;
+        sections[section].count = 0;
+        sections[section].elementSize = memoryImageElementSize(section);
+    }
+    
+    /**
+     * Append count elements to the current section
+     */
+    void append(const void* elements, uint64_t count) {
+        sections[current].count += count;
+        write(elements, static_cast<size_t>(count * sections[current].elementSize));
+    }
+    
+    /**
+     * Write the header and close the file
+     * @param header Geometry and allocator state; the rest is filled in here
+     */
+    bool finish(MemoryImageHeader header, const std::string& path, std::string& error) {
+        std::memcpy(header.magic, MEMORY_IMAGE_MAGIC, sizeof(MEMORY_IMAGE_MAGIC));
+        header.version = MEMORY_IMAGE_VERSION;
+        header.headerSize = sizeof(MemoryImageHeader);
+        header.fileSize = position;
+        std::memcpy(header.sections, sections, sizeof(sections));
+        
+        ok = ok && std::fseek(out, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, out) == 1;
+        ok = std::fclose(out) == 0 && ok;
+        out = nullptr;
+        if (!ok) error = "Failed writing " + path;
+        return ok;
+    }
+    
+    uint64_t bytesWritten() const { return position; }
+};
+
+#endif // MEMORY_IMAGE_H
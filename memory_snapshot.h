@@ -0,0 +1,533 @@
+/**
+ * Compact Memory-State Snapshots
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ * 
+ * A snapshot holds summary counters, a run-length encoding of the
+ * occupancy bitmap and the largest jobs, instead of one line per frame,
+ * page and job. A delta snapshot replaces the occupancy map with just the
+ * frames that changed since the previous snapshot, so long runs can be
+ * polled cheaply. Snapshots are formatted as text, JSON or a fixed binary
+ * layout into one buffer and written with a single write.
+ * 
+ * Binary layout (host byte order):
+ *   BinarySnapshotHeader                  (96 bytes)
+ *   uint32_t runs[runCount]               alternating free/used run lengths from frame 0
+ *   BinarySnapshotJob jobs[jobCount]      (24 bytes each)
+ *   BinarySnapshotFrame frames[changedCount]  (12 bytes each, delta only)
+ *   name table                            (concatenated job names)
+ */
+
+#ifndef MEMORY_SNAPSHOT_H
+#define MEMORY_SNAPSHOT_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "paged_memory.h"
+
+const char BINARY_SNAPSHOT_MAGIC[8] = {'P', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+const uint32_t BINARY_SNAPSHOT_VERSION = 1;
+
+/**
+ * Binary snapshot header
+ */
+struct BinarySnapshotHeader {
+    char magic[8];             // BINARY_SNAPSHOT_MAGIC
+    uint32_t version;          // BINARY_SNAPSHOT_VERSION
+    uint32_t delta;            // 1 for a delta snapshot
+    uint64_t sequence;         // Snapshot number, from 1
+    uint32_t pageSize;
+    uint32_t totalFrames;
+    uint32_t usedFrames;
+    uint32_t activeJobs;
+    uint32_t freeRuns;         // Runs of consecutive free frames
+    uint32_t largestFreeRun;
+    uint64_t tlbHits;
+    uint64_t tlbMisses;
+    uint64_t pageFaults;       // Demand paging only
+    uint32_t runCount;         // Occupancy runs that follow (0 for a delta)
+    uint32_t jobCount;         // Job records that follow
+    uint32_t changedCount;     // Changed-frame records that follow (delta only)
+    uint32_t nameTableSize;
+    uint8_t reserved[8];       // Zero; pads the header to 96 bytes
+};
+
+/**
+ * One of the largest jobs
+ */
+struct BinarySnapshotJob {
+    int32_t jobId;
+    uint32_t pageCount;
+    uint64_t size;             // Bytes
+    uint32_t nameOffset;       // Offset into the name table
+    uint32_t nameLength;
+};
+
+/**
+ * Current state of a frame that changed
+ */
+struct BinarySnapshotFrame {
+    uint32_t frame;
+    int32_t owner;             // Owning job ID, -1 when free
+    uint32_t page;             // System-wide page number (0 when free)
+};
+
+static_assert(sizeof(BinarySnapshotHeader) == 96, "binary snapshot header must be 96 bytes");
+static_assert(sizeof(BinarySnapshotJob) == 24, "binary snapshot job must be 24 bytes");
+static_assert(sizeof(BinarySnapshotFrame) == 12, "binary snapshot frame must be 12 bytes");
+
+/**
+ * Captured memory state
+ */
+struct MemorySnapshot {
+    struct JobEntry {
+        int id;
+        const std::string* name;   // Points into the manager; valid until the job is removed
+        Address size;
+        PageId pageCount;
+    };
+    
+    struct FrameEntry {
+        FrameId frame;
+        int owner;                 // -1 when free
+        PageId page;
+    };
+    
+    uint64_t sequence;
+    bool delta;
+    uint32_t pageSize;
+    FrameId totalFrames;
+    FrameId usedFrames;
+    size_t activeJobs;
+    uint64_t freeRuns;
+    uint64_t largestFreeRun;
+    bool tlbEnabled;
+    uint64_t tlbHits;
+    uint64_t tlbMisses;
+    bool demandPaging;
+    uint64_t pageFaults;
+    std::vector<FrameId> occupancyRuns;  // Alternating free/used lengths from frame 0 (full only)
+    std::vector<JobEntry> largestJobs;
+    std::vector<FrameEntry> changedFrames;  // Delta only
+};
+
+/**
+ * Capture a snapshot; every capture restarts change tracking, so a delta
+ * covers the frames changed since the previous capture of either kind
+ * @param delta Record changed frames instead of the occupancy map
+ * @param topJobs How many of the largest jobs to include
+ * @param changedScratch Reused buffer for the changed-frame list
+ * @param snapshot Receives the state; its vectors are reused across calls
+ */
+inline void captureSnapshot(PagedMemoryManager& manager, bool delta, size_t topJobs,
+                            std::vector<FrameId>& changedScratch, MemorySnapshot& snapshot) {
+    const FrameTable& frames = manager.getFrameTable();
+    const Tlb& tlb = manager.getTlb();
+    FreeRunHistogram freeRuns = frames.freeRunHistogram();
+    
+    snapshot.sequence++;
+    snapshot.delta = delta;
+    snapshot.pageSize = manager.getPageSize();
+    snapshot.totalFrames = manager.getTotalFrames();
+    snapshot.usedFrames = frames.countOccupied();
+    snapshot.activeJobs = manager.getJobCount();
+    snapshot.freeRuns = freeRuns.runCount;
+    snapshot.largestFreeRun = freeRuns.largestRun;
+    snapshot.tlbEnabled = tlb.enabled();
+    snapshot.tlbHits = tlb.hitCount();
+    snapshot.tlbMisses = tlb.missCount();
+    snapshot.demandPaging = manager.demandPagingEnabled();
+    snapshot.pageFaults = manager.getPageFaults();
+    
+    // Run boundaries come from the bitmap scans, which skip whole words
+    snapshot.occupancyRuns.clear();
+    if (!delta) {
+        FrameId total = snapshot.totalFrames;
+        bool used = false;
+        for (FrameId frame = 0; frame < total; used = !used) {
+            FrameId next;
+            if (used) {
+                next = frames.findFree(frame);
+                if (next == INVALID_FRAME) next = total;
+            } else {
+                next = frames.findOccupied(frame, total);
+            }
+            snapshot.occupancyRuns.push_back(next - frame);
+            frame = next;
+        }
+    }
+    
+    changedScratch.clear();
+    manager.takeChangedFrames(changedScratch);
+    snapshot.changedFrames.clear();
+    if (delta) {
+        for (FrameId frame : changedScratch) {
+            bool occupied = frames.isOccupied(frame);
+            MemorySnapshot::FrameEntry entry = {frame, occupied ? frames.ownerOf(frame) : -1,
+                                                occupied ? frames.pageOf(frame) : 0};
+            snapshot.changedFrames.push_back(entry);
+        }
+    }
+    
+    snapshot.largestJobs.clear();
+    for (const Job* job : manager.largestJobs(topJobs)) {
+        MemorySnapshot::JobEntry entry = {job->id, job->name, job->size, job->pageCount};
+        snapshot.largestJobs.push_back(entry);
+    }
+}
+
+/**
+ * Append a decimal number without going through a stream
+ */
+inline void snapshotAppendNumber(std::string& out, uint64_t value) {
+    char digits[20];
+    int length = 0;
+    do {
+        digits[length++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (length > 0) out += digits[--length];
+}
+
+inline void snapshotAppendSigned(std::string& out, int64_t value) {
+    if (value < 0) {
+        out += '-';
+        snapshotAppendNumber(out, static_cast<uint64_t>(0) - static_cast<uint64_t>(value));
+    } else {
+        snapshotAppendNumber(out, static_cast<uint64_t>(value));
+    }
+}
+
+/**
+ * Append a JSON string literal
+ */
+inline void snapshotAppendJsonString(std::string& out, const std::string& text) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (byte < 0x20) {
+            out += "\\u00";
+            out += hex[byte >> 4];
+            out += hex[byte & 0xF];
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+/**
+ * Format a snapshot for reading on a console
+ */
+inline void formatSnapshotText(const MemorySnapshot& snapshot, std::string& out) {
+    out += "\n=== Memory Snapshot #";
+    snapshotAppendNumber(out, snapshot.sequence);
+    out += snapshot.delta ? " (delta) ===\n" : " ===\n";
+    
+    out += "Frames Used: ";
+    snapshotAppendNumber(out, snapshot.usedFrames);
+    out += " / ";
+    snapshotAppendNumber(out, snapshot.totalFrames);
+    out += ", Jobs: ";
+    snapshotAppendNumber(out, snapshot.activeJobs);
+    out += ", Free Runs: ";
+    snapshotAppendNumber(out, snapshot.freeRuns);
+    out += " (largest: ";
+    snapshotAppendNumber(out, snapshot.largestFreeRun);
+    out += " frames)\n";
+    if (snapshot.tlbEnabled) {
+        out += "TLB Hits: ";
+        snapshotAppendNumber(out, snapshot.tlbHits);
+        out += ", Misses: ";
+        snapshotAppendNumber(out, snapshot.tlbMisses);
+        out += '\n';
+    }
+    if (snapshot.demandPaging) {
+        out += "Page Faults: ";
+        snapshotAppendNumber(out, snapshot.pageFaults);
+        out += '\n';
+    }
+    
+    if (snapshot.delta) {
+        out += "Changed Frames: ";
+        snapshotAppendNumber(out, snapshot.changedFrames.size());
+        out += '\n';
+        for (const MemorySnapshot::FrameEntry& entry : snapshot.changedFrames) {
+            out += "  ";
+            snapshotAppendNumber(out, entry.frame);
+            if (entry.owner < 0) {
+                out += " free\n";
+            } else {
+                out += " job ";
+                snapshotAppendSigned(out, entry.owner);
+                out += " page ";
+                snapshotAppendNumber(out, entry.page);
+                out += '\n';
+            }
+        }
+    } else {
+        // Runs alternate free/used starting at frame 0; a leading used run
+        // shows as an empty free run
+        out += "Occupancy (";
+        snapshotAppendNumber(out, snapshot.occupancyRuns.size());
+        out += " runs, F = free, U = used):";
+        for (size_t i = 0; i < snapshot.occupancyRuns.size(); i++) {
+            if (snapshot.occupancyRuns[i] == 0) continue;
+            out += ' ';
+            snapshotAppendNumber(out, snapshot.occupancyRuns[i]);
+            out += i % 2 ? 'U' : 'F';
+        }
+        out += '\n';
+    }
+    
+    out += "Largest Jobs:\n";
+    for (const MemorySnapshot::JobEntry& job : snapshot.largestJobs) {
+        out += "  ";
+        snapshotAppendSigned(out, job.id);
+        out += ' ';
+        out += *job.name;
+        out += ": ";
+        snapshotAppendNumber(out, job.size);
+        out += " bytes, ";
+        snapshotAppendNumber(out, job.pageCount);
+        out += " pages\n";
+    }
+}
+
+/**
+ * Format a snapshot as one JSON object followed by a newline
+ */
+inline void formatSnapshotJson(const MemorySnapshot& snapshot, std::string& out) {
+    out += "{\"sequence\":";
+    snapshotAppendNumber(out, snapshot.sequence);
+    out += snapshot.delta ? ",\"delta\":true" : ",\"delta\":false";
+    out += ",\"pageSize\":";
+    snapshotAppendNumber(out, snapshot.pageSize);
+    out += ",\"totalFrames\":";
+    snapshotAppendNumber(out, snapshot.totalFrames);
+    out += ",\"usedFrames\":";
+    snapshotAppendNumber(out, snapshot.usedFrames);
+    out += ",\"activeJobs\":";
+    snapshotAppendNumber(out, snapshot.activeJobs);
+    out += ",\"freeRuns\":";
+    snapshotAppendNumber(out, snapshot.freeRuns);
+    out += ",\"largestFreeRun\":";
+    snapshotAppendNumber(out, snapshot.largestFreeRun);
+    if (snapshot.tlbEnabled) {
+        out += ",\"tlbHits\":";
+        snapshotAppendNumber(out, snapshot.tlbHits);
+        out += ",\"tlbMisses\":";
+        snapshotAppendNumber(out, snapshot.tlbMisses);
+    }
+    if (snapshot.demandPaging) {
+        out += ",\"pageFaults\":";
+        snapshotAppendNumber(out, snapshot.pageFaults);
+    }
+    
+    if (snapshot.delta) {
+        out += ",\"changedFrames\":[";
+        for (size_t i = 0; i < snapshot.changedFrames.size(); i++) {
+            const MemorySnapshot::FrameEntry& entry = snapshot.changedFrames[i];
+            out += i ? ",[" : "[";
+            snapshotAppendNumber(out, entry.frame);
+            out += ',';
+            snapshotAppendSigned(out, entry.owner);
+            out += ',';
+            snapshotAppendNumber(out, entry.page);
+            out += ']';
+        }
+        out += ']';
+    } else {
+        out += ",\"occupancyRuns\":[";
+        for (size_t i = 0; i < snapshot.occupancyRuns.size(); i++) {
+            if (i) out += ',';
+            snapshotAppendNumber(out, snapshot.occupancyRuns[i]);
+        }
+        out += ']';
+    }
+    
+    out += ",\"largestJobs\":[";
+    for (size_t i = 0; i < snapshot.largestJobs.size(); i++) {
+        const MemorySnapshot::JobEntry& job = snapshot.largestJobs[i];
+        out += i ? ",{\"id\":" : "{\"id\":";
+        snapshotAppendSigned(out, job.id);
+        out += ",\"name\":";
+        snapshotAppendJsonString(out, *job.name);
+        out += ",\"size\":";
+        snapshotAppendNumber(out, job.size);
+        out += ",\"pages\":";
+        snapshotAppendNumber(out, job.pageCount);
+        out += '}';
+    }
+    out += "]}\n";
+}
+
+/**
+ * Format a snapshot in the binary layout described at the top of this file
+ */
+inline void formatSnapshotBinary(const MemorySnapshot& snapshot, std::string& out) {
+    uint32_t nameTableSize = 0;
+    for (const MemorySnapshot::JobEntry& job : snapshot.largestJobs) {
+        nameTableSize += static_cast<uint32_t>(job.name->size());
+    }
+    
+    BinarySnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BINARY_SNAPSHOT_MAGIC, sizeof(BINARY_SNAPSHOT_MAGIC));
+    header.version = BINARY_SNAPSHOT_VERSION;
+    header.delta = snapshot.delta ? 1 : 0;
+    header.sequence = snapshot.sequence;
+    header.pageSize = snapshot.pageSize;
+    header.totalFrames = snapshot.totalFrames;
+    header.usedFrames = snapshot.usedFrames;
+    header.activeJobs = static_cast<uint32_t>(snapshot.activeJobs);
+    header.freeRuns = static_cast<uint32_t>(snapshot.freeRuns);
+    header.largestFreeRun = static_cast<uint32_t>(snapshot.largestFreeRun);
+    header.tlbHits = snapshot.tlbHits;
+    header.tlbMisses = snapshot.tlbMisses;
+    header.pageFaults = snapshot.pageFaults;
+    header.runCount = static_cast<uint32_t>(snapshot.occupancyRuns.size());
+    header.jobCount = static_cast<uint32_t>(snapshot.largestJobs.size());
+    header.changedCount = static_cast<uint32_t>(snapshot.changedFrames.size());
+    header.nameTableSize = nameTableSize;
+    
+    size_t start = out.size();
+    out.resize(start + sizeof(header) + snapshot.occupancyRuns.size() * sizeof(uint32_t)
+               + snapshot.largestJobs.size() * sizeof(BinarySnapshotJob)
+               + snapshot.changedFrames.size() * sizeof(BinarySnapshotFrame) + nameTableSize);
+    char* cursor = &out[start];
+    
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    
+    // FrameId is uint32_t, so the runs copy out as they are
+    if (!snapshot.occupancyRuns.empty()) {
+        std::memcpy(cursor, snapshot.occupancyRuns.data(), snapshot.occupancyRuns.size() * sizeof(uint32_t));
+        cursor += snapshot.occupancyRuns.size() * sizeof(uint32_t);
+    }
+    
+    uint32_t nameOffset = 0;
+    for (const MemorySnapshot::JobEntry& job : snapshot.largestJobs) {
+        BinarySnapshotJob record = {job.id, job.pageCount, job.size, nameOffset,
+                                    static_cast<uint32_t>(job.name->size())};
+        std::memcpy(cursor, &record, sizeof(record));
+        cursor += sizeof(record);
+        nameOffset += record.nameLength;
+    }
+    
+    for (const MemorySnapshot::FrameEntry& entry : snapshot.changedFrames) {
+        BinarySnapshotFrame record = {entry.frame, entry.owner, entry.page};
+        std::memcpy(cursor, &record, sizeof(record));
+        cursor += sizeof(record);
+    }
+    
+    for (const MemorySnapshot::JobEntry& job : snapshot.largestJobs) {
+        std::memcpy(cursor, job.name->data(), job.name->size());
+        cursor += job.name->size();
+    }
+}
+
+/**
+ * Captures snapshots on demand and writes each as one buffered write
+ * 
+ * The first snapshot is always full; in delta mode later ones carry only
+ * the frames changed since the one before. Capture and output buffers are
+ * reused from one snapshot to the next.
+ */
+class SnapshotWriter {
+public:
+    enum Format {
+        FORMAT_TEXT,
+        FORMAT_JSON,
+        FORMAT_BINARY
+    };
+
+private:
+    Format format;
+    bool deltaMode;
+    size_t topJobs;
+    FILE* out;                 // Destination (stdout or an appended file)
+    bool ownsFile;
+    MemorySnapshot snapshot;
+    std::vector<FrameId> changedScratch;
+    std::string buffer;
+    
+    SnapshotWriter(const SnapshotWriter&);
+    SnapshotWriter& operator=(const SnapshotWriter&);
+
+public:
+    SnapshotWriter(Format format, bool deltaMode, size_t topJobs)
+        : format(format), deltaMode(deltaMode), topJobs(topJobs), out(stdout), ownsFile(false) {
+        snapshot.sequence = 0;
+    }
+    
+    ~SnapshotWriter() {
+        if (ownsFile) std::fclose(out);
+    }
+    
+    /**
+     * Append snapshots to a file instead of standard output
+     * @param error Receives the reason on failure
+     */
+    bool openFile(const std::string& path, std::string& error) {
+        FILE* file = std::fopen(path.c_str(), "ab");
+        if (!file) {
+            error = "Cannot open snapshot file " + path;
+            return false;
+        }
+        // Each snapshot goes out as one write of the formatted buffer
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        if (ownsFile) std::fclose(out);
+        out = file;
+        ownsFile = true;
+        return true;
+    }
+    
+    bool writesToFile() const { return ownsFile; }
+    uint64_t snapshotCount() const { return snapshot.sequence; }
+    
+    /**
+     * Capture, format and write one snapshot
+     * @param error Receives the reason on failure
+     */
+    bool write(PagedMemoryManager& manager, std::string& error) {
+        captureSnapshot(manager, deltaMode && snapshot.sequence > 0, topJobs, changedScratch, snapshot);
+        
+        buffer.clear();
+        switch (format) {
+            case FORMAT_JSON:
+                formatSnapshotJson(snapshot, buffer);
+                break;
+            case FORMAT_BINARY:
+                formatSnapshotBinary(snapshot, buffer);
+                break;
+            default:
+                formatSnapshotText(snapshot, buffer);
+                break;
+        }
+        
+        if (std::fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size() || std::fflush(out) != 0) {
+            error = "Failed writing snapshot";
+            return false;
+        }
+        return true;
+    }
+    
+    static const char* formatName(Format f) {
+        switch (f) {
+            case FORMAT_JSON: return "json";
+            case FORMAT_BINARY: return "binary";
+            default: return "text";
+        }
+    }
+};
+
+#endif // MEMORY_SNAPSHOT_H
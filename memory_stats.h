@@ -0,0 +1,272 @@
+/**
+ * Operation Counters and Latency Histograms
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ * 
+ * Instrumentation is on by default. Building with -DPAGED_MEMORY_STATS=0
+ * replaces both recorders with empty inline classes, so the managers read
+ * no clocks and keep no counters.
+ */
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "memory_status.h"
+#include "latency_histogram.h"
+
+#ifndef PAGED_MEMORY_STATS
+#define PAGED_MEMORY_STATS 1
+#endif
+
+/**
+ * Operations with a latency histogram
+ */
+enum StatOp {
+    STAT_ACCEPT,
+    STAT_TRANSLATE,
+    STAT_TRANSLATE_BATCH,
+    STAT_REMOVE
+};
+
+const int STAT_OP_KINDS = STAT_REMOVE + 1;
+
+inline const char* statOpName(StatOp op) {
+    switch (op) {
+        case STAT_ACCEPT: return "accept";
+        case STAT_TRANSLATE: return "translate";
+        case STAT_TRANSLATE_BATCH: return "translate batch";
+        default: return "remove";
+    }
+}
+
+/**
+ * Operation counts (a batch counts each of its addresses as a translation)
+ */
+struct StatCounters {
+    uint64_t accepts;              // Jobs accepted
+    uint64_t acceptRejects;        // Accepts refused for lack of (contiguous) frames
+    uint64_t acceptFailures;       // Accepts refused for any other reason
+    uint64_t translations;         // Addresses translated
+    uint64_t translationFailures;  // Addresses that could not be translated
+    uint64_t pageFaults;           // Translations that loaded their page
+    uint64_t removals;             // Jobs removed
+    uint64_t removeFailures;       // Removals of missing or invalid job IDs
+};
+
+/**
+ * Whether a failed accept was refused for lack of frames
+ */
+inline bool isFrameShortage(Status status) {
+    return status == Status::OutOfFrames || status == Status::Fragmented;
+}
+
+#if PAGED_MEMORY_STATS
+
+/**
+ * Single-threaded recorder used inside PagedMemoryManager
+ * 
+ * Counters are plain increments. Accepts and removals are timed on every
+ * call; a translation costs about as much as reading the clock, so only
+ * every TRANSLATE_SAMPLE_INTERVAL-th translation call (single or batch) is
+ * timed. Sampling thins the histograms without skewing their percentiles.
+ */
+class OperationStats {
+public:
+    static const bool ENABLED = true;
+    static const uint32_t TRANSLATE_SAMPLE_INTERVAL = 64;   // Power of two
+    
+    // Start of a timed operation (0 = not timed)
+    typedef uint64_t Stamp;
+
+private:
+    StatCounters totals;
+    LatencyHistogram latencies[STAT_OP_KINDS];
+    uint32_t translateTicks;
+    
+    static Stamp now() {
+        return static_cast<Stamp>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    
+    void record(StatOp op, Stamp started) {
+        if (started != 0) latencies[op].record(now() - started);
+    }
+
+public:
+    OperationStats() { reset(); }
+    
+    void reset() {
+        totals = StatCounters();
+        for (int op = 0; op < STAT_OP_KINDS; op++) latencies[op].reset();
+        translateTicks = 0;
+    }
+    
+    Stamp start() { return now(); }
+    
+    Stamp startSampled() {
+        return (++translateTicks & (TRANSLATE_SAMPLE_INTERVAL - 1)) == 0 ? now() : 0;
+    }
+    
+    void accepted(Status status, Stamp started) {
+        if (status == Status::Ok) totals.accepts++;
+        else if (isFrameShortage(status)) totals.acceptRejects++;
+        else totals.acceptFailures++;
+        record(STAT_ACCEPT, started);
+    }
+    
+    void translated(bool success, bool pageFault, Stamp started) {
+        totals.translations += success;
+        totals.translationFailures += !success;
+        totals.pageFaults += pageFault;
+        record(STAT_TRANSLATE, started);
+    }
+    
+    void translatedBatch(size_t count, size_t translated, uint64_t pageFaults, Stamp started) {
+        totals.translations += translated;
+        totals.translationFailures += count - translated;
+        totals.pageFaults += pageFaults;
+        record(STAT_TRANSLATE_BATCH, started);
+    }
+    
+    void removed(Status status, Stamp started) {
+        if (status == Status::Ok) totals.removals++;
+        else totals.removeFailures++;
+        record(STAT_REMOVE, started);
+    }
+    
+    const StatCounters& counters() const { return totals; }
+    
+    /**
+     * Latency of one operation kind in nanoseconds
+     */
+    const LatencyHistogram& latency(StatOp op) const { return latencies[op]; }
+};
+
+/**
+ * Per-thread counters for ConcurrentPagedMemoryManager, merged on read
+ * 
+ * Each thread adds to its own cache line, so recording never contends.
+ * Translations are counted in the translating thread's reader slot, which
+ * only it writes; accepts and removals go to a slot chosen by the calling
+ * thread's index, which threads beyond THREAD_SLOTS share, so those are
+ * atomic adds. No latencies are kept: merging a histogram while its owner
+ * writes it would race.
+ */
+class ConcurrentOperationStats {
+public:
+    static const bool ENABLED = true;
+    static const int THREAD_SLOTS = 64;
+
+private:
+    enum Counter {
+        ACCEPTS, ACCEPT_REJECTS, ACCEPT_FAILURES, TRANSLATIONS, TRANSLATION_FAILURES, REMOVALS,
+        REMOVE_FAILURES, COUNTERS
+    };
+    
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> values[COUNTERS];
+    };
+    
+    Slot readerSlots[THREAD_SLOTS];   // Indexed by reader slot
+    Slot threadSlots[THREAD_SLOTS];   // Indexed by thread index
+    
+    static void add(Slot& slot, Counter counter, uint64_t amount) {
+        slot.values[counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+    
+    // Single-writer add: a plain load and store, cheaper than a locked add
+    static void addOwned(Slot& slot, Counter counter, uint64_t amount) {
+        std::atomic<uint64_t>& value = slot.values[counter];
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+public:
+    ConcurrentOperationStats() {
+        for (int s = 0; s < THREAD_SLOTS; s++) {
+            for (int c = 0; c < COUNTERS; c++) {
+                readerSlots[s].values[c].store(0, std::memory_order_relaxed);
+                threadSlots[s].values[c].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    void accepted(int thread, Status status) {
+        Slot& slot = threadSlots[thread % THREAD_SLOTS];
+        add(slot, status == Status::Ok ? ACCEPTS : isFrameShortage(status) ? ACCEPT_REJECTS : ACCEPT_FAILURES, 1);
+    }
+    
+    void translatedBatch(int reader, size_t count, size_t translated) {
+        Slot& slot = readerSlots[reader % THREAD_SLOTS];
+        addOwned(slot, TRANSLATIONS, translated);
+        addOwned(slot, TRANSLATION_FAILURES, count - translated);
+    }
+    
+    void removed(int thread, Status status) {
+        add(threadSlots[thread % THREAD_SLOTS], status == Status::Ok ? REMOVALS : REMOVE_FAILURES, 1);
+    }
+    
+    /**
+     * Sum of every thread's counters (each counter is read atomically, but
+     * operations in flight may be partly counted)
+     */
+    StatCounters counters() const {
+        StatCounters total = StatCounters();
+        for (int s = 0; s < THREAD_SLOTS; s++) {
+            total.translations += readerSlots[s].values[TRANSLATIONS].load(std::memory_order_relaxed);
+            total.translationFailures += readerSlots[s].values[TRANSLATION_FAILURES].load(std::memory_order_relaxed);
+            const Slot& slot = threadSlots[s];
+            total.accepts += slot.values[ACCEPTS].load(std::memory_order_relaxed);
+            total.acceptRejects += slot.values[ACCEPT_REJECTS].load(std::memory_order_relaxed);
+            total.acceptFailures += slot.values[ACCEPT_FAILURES].load(std::memory_order_relaxed);
+            total.removals += slot.values[REMOVALS].load(std::memory_order_relaxed);
+            total.removeFailures += slot.values[REMOVE_FAILURES].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+#else // !PAGED_MEMORY_STATS
+
+/**
+ * Instrumentation compiled out: every call is empty and reports zeros
+ */
+class OperationStats {
+public:
+    static const bool ENABLED = false;
+    static const uint32_t TRANSLATE_SAMPLE_INTERVAL = 64;
+    typedef uint64_t Stamp;
+    
+    void reset() {}
+    Stamp start() { return 0; }
+    Stamp startSampled() { return 0; }
+    void accepted(Status, Stamp) {}
+    void translated(bool, bool, Stamp) {}
+    void translatedBatch(size_t, size_t, uint64_t, Stamp) {}
+    void removed(Status, Stamp) {}
+    
+    StatCounters counters() const { return StatCounters(); }
+    
+    const LatencyHistogram& latency(StatOp) const {
+        static const LatencyHistogram empty;
+        return empty;
+    }
+};
+
+class ConcurrentOperationStats {
+public:
+    static const bool ENABLED = false;
+    
+    void accepted(int, Status) {}
+    void translatedBatch(int, size_t, size_t) {}
+    void removed(int, Status) {}
+    
+    StatCounters counters() const { return StatCounters(); }
+};
+
+#endif // PAGED_MEMORY_STATS
+
+#endif // MEMORY_STATS_H
@@ -0,0 +1,106 @@
+/**
+ * Operation Status Codes
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef MEMORY_STATUS_H
+#define MEMORY_STATUS_H
+
+#include <string>
+#include <cstdint>
+
+/**
+ * Why an operation failed (or Ok)
+ * 
+ * Results carry a Status and the few numbers needed to explain it; the
+ * message is only formatted when errorMessage() is called, so callers that
+ * just count failures never build a string.
+ */
+enum class Status : uint8_t {
+    Ok,
+    InvalidSize,     // Job size of zero
+    TooLarge,        // More pages than a page table can index
+    OutOfFrames,     // Not enough free frames
+    Fragmented,      // Enough free frames, but no contiguous run for the placement
+    InvalidJobId,    // Job ID not positive
+    NoSuchJob,       // No active job with this ID
+    OutOfBounds,     // Logical address past the job's end
+    NoMemory,        // Page-table storage for a page fault could not be allocated
+    Unsupported      // Operation not available in the manager's configuration
+};
+
+const int STATUS_COUNT = static_cast<int>(Status::Unsupported) + 1;
+
+/**
+ * Values recorded with a failure for its message
+ */
+struct Diagnostic {
+    uint64_t values[3];   // Meaning depends on the status (see formatDiagnostic)
+    const char* text;     // Static string, e.g. a placement name (may be null)
+};
+
+/**
+ * Short name of a status, for counters and logs
+ */
+inline const char* statusName(Status status) noexcept {
+    switch (status) {
+        case Status::Ok: return "Ok";
+        case Status::InvalidSize: return "InvalidSize";
+        case Status::TooLarge: return "TooLarge";
+        case Status::OutOfFrames: return "OutOfFrames";
+        case Status::Fragmented: return "Fragmented";
+        case Status::InvalidJobId: return "InvalidJobId";
+        case Status::NoSuchJob: return "NoSuchJob";
+        case Status::OutOfBounds: return "OutOfBounds";
+        case Status::NoMemory: return "NoMemory";
+        default: return "Unsupported";
+    }
+}
+
+/**
+ * Format the full message for a failure
+ */
+inline std::string formatDiagnostic(Status status, const Diagnostic& detail) {
+    const uint64_t* v = detail.values;
+    switch (status) {
+        case Status::Ok:
+            return std::string();
+        case Status::InvalidSize:
+            return "Job size must be positive. Got: 0 bytes";
+        case Status::TooLarge:
+            return "Job needs " + std::to_string(v[0]) + " pages, more than a page table can index.";
+        case Status::OutOfFrames:
+            return "Not enough free frames. Need " + std::to_string(v[0]) + " frames, but only "
+                 + std::to_string(v[1]) + " are available.";
+        case Status::Fragmented:
+            return "No run of " + std::to_string(v[0]) + " contiguous free frames for "
+                 + (detail.text ? detail.text : "contiguous") + " placement (free memory is fragmented).";
+        case Status::InvalidJobId:
+            return "Job ID must be positive. Got: " + std::to_string(static_cast<int64_t>(v[0]));
+        case Status::NoSuchJob:
+            return "Job ID " + std::to_string(static_cast<int64_t>(v[0])) + " not found.";
+        case Status::OutOfBounds:
+            return "Logical address " + std::to_string(v[0]) + " is out of bounds for job "
+                 + std::to_string(static_cast<int64_t>(v[1])) + " (size: " + std::to_string(v[2]) + ")";
+        case Status::NoMemory:
+            return "No memory for the page-table nodes of page " + std::to_string(v[0]) + " of job "
+                 + std::to_string(static_cast<int64_t>(v[1])) + ".";
+        default:
+            return std::string(detail.text ? detail.text : "Operation") + " is not supported in this configuration.";
+    }
+}
+
+/**
+ * Record a failure's status and values (noexcept, no allocation)
+ */
+inline Status failWith(Status status, Diagnostic& detail, uint64_t a = 0, uint64_t b = 0, uint64_t c = 0,
+                       const char* text = nullptr) noexcept {
+    detail.values[0] = a;
+    detail.values[1] = b;
+    detail.values[2] = c;
+    detail.text = text;
+    return status;
+}
+
+#endif // MEMORY_STATUS_H
@@ -0,0 +1,1533 @@
+/**
+ * Memory Manager Tests
+ * 
+ * Google Test suite for the invariants the managers must keep while they
+ * move, share and hand out frames: compaction keeps every job's
+ * translations, forked jobs keep share counts equal to their mappings, a
+ * saved and reloaded state image saves back byte for byte, and concurrent
+ * accept/translate/remove never gives one frame to two live jobs. `make test` builds and runs it.
+ * 
+ * Usage: memory_test [--gtest_filter=PATTERN]
+ */
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <gtest/gtest.h>
+
+#include "paged_memory.h"
+#include "concurrent_memory.h"
+#include "binary_trace.h"
+#include "access_analyzer.h"
+#include "occupancy_kernels.h"
+#include "trace_replay.h"
+
+using namespace std;
+
+static const uint32_t PAGE_SIZE = 4096;
+
+// Calls to operator new since the program started, for the tests that
+// check a steady state does not allocate; while failAllocations is set
+// every call throws instead, for the tests of out-of-memory paths
+static atomic<uint64_t> allocations(0);
+static atomic<bool> failAllocations(false);
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (failAllocations.load(memory_order_relaxed)) throw bad_alloc();
+    void* block = malloc(size ? size : 1);
+    if (!block) throw bad_alloc();
+    return block;
+}
+
+// Out of line so GCC does not pair free() with the operator new it inlined
+__attribute__((noinline)) void operator delete(void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { operator delete(block); }  // Sized form, used by libgtest
+
+/**
+ * Check that every address of the job translates onto a frame the frame
+ * table records as holding that very page
+ */
+static void expectJobTranslates(PagedMemoryManager& manager, int jobId) {
+    const Job* job = manager.findJob(jobId);
+    ASSERT_TRUE(job != NULL);
+    const FrameTable& frames = manager.getFrameTable();
+    for (PageId page = 0; page < job->pageCount; page++) {
+        Address offset = (page * 131) % PAGE_SIZE;
+        TranslationResult result = manager.resolveAddress(jobId, page * PAGE_SIZE + offset);
+        ASSERT_TRUE(result.success) << "job " << jobId << " page " << page;
+        EXPECT_EQ(Address(result.frameNumber) * PAGE_SIZE + offset, result.physicalAddress);
+        EXPECT_TRUE(frames.isOccupied(result.frameNumber));
+        EXPECT_EQ(jobId, frames.ownerOf(result.frameNumber));
+        EXPECT_EQ(job->firstPage + page, frames.pageOf(result.frameNumber));
+    }
+}
+
+/**
+ * Every job's resident pages and the frames holding them, by job ID
+ */
+static map<int, vector<pair<PageId, FrameId> > > residentPages(const PagedMemoryManager& manager) {
+    map<int, vector<pair<PageId, FrameId> > > pages;
+    vector<const Job*> jobs = manager.jobsById();
+    for (size_t j = 0; j < jobs.size(); j++) {
+        vector<pair<PageId, FrameId> >& jobPages = pages[jobs[j]->id];
+        jobs[j]->forEachResidentPage([&](PageId page, FrameId frame) { jobPages.push_back(make_pair(page, frame)); });
+    }
+    return pages;
+}
+
+/**
+ * Fragment memory, then compact it in small steps with translations in
+ * between; every page must stay reachable through every translation path
+ * and the free frames must end up in one run
+ */
+TEST(Compaction, PreservesEveryJobsTranslations) {
+    for (int mode = 0; mode < 3; mode++) {
+        SCOPED_TRACE(mode);
+        PagedMemoryManager manager(PAGE_SIZE, 1024);
+        manager.seedRandom(mode);
+        if (mode == 1) manager.configurePageTable(3);
+        if (mode == 2) manager.configureTlb(16, 4, Tlb::POLICY_LRU);
+        
+        mt19937 random(mode);
+        vector<int> jobIds;
+        for (;;) {
+            AcceptResult result = manager.acceptJob("job", (1 + random() % 24) * PAGE_SIZE);
+            if (!result.success) break;
+            jobIds.push_back(result.jobId);
+        }
+        vector<int> live;
+        for (size_t i = 0; i < jobIds.size(); i++) {
+            if (i % 2) manager.removeJob(jobIds[i]);
+            else live.push_back(jobIds[i]);
+        }
+        FrameId usedFrames = manager.getUsedFrames();
+        ASSERT_GT(manager.getExternalFragmentation(), 0.0);
+        
+        manager.startCompaction();
+        while (!manager.compactStep(8).finished) {
+            int jobId = live[random() % live.size()];
+            const Job* job = manager.findJob(jobId);
+            Address address = random() % job->size;
+            TranslationResult result = manager.resolveAddress(jobId, address);
+            ASSERT_TRUE(result.success);
+            EXPECT_EQ(jobId, manager.getFrameTable().ownerOf(result.frameNumber));
+            EXPECT_EQ(job->firstPage + address / PAGE_SIZE, manager.getFrameTable().pageOf(result.frameNumber));
+        }
+        
+        EXPECT_GT(manager.getFramesMigrated(), 0u);
+        EXPECT_EQ(usedFrames, manager.getUsedFrames());
+        EXPECT_EQ(0.0, manager.getExternalFragmentation());
+        for (size_t i = 0; i < live.size(); i++) expectJobTranslates(manager, live[i]);
+    }
+}
+
+/**
+ * A batch translates every address as one resolveAddress() call each
+ * would, on twin managers seeded alike: out-of-range addresses get the
+ * marker, the count is the addresses translated, and under demand paging
+ * both fault and evict the same pages. Covers the vectorizable flat loop
+ * and the TLB, radix, huge-page and demand-paging paths.
+ */
+TEST(BatchTranslation, MatchesSingleTranslations) {
+    for (int mode = 0; mode < 5; mode++) {
+        SCOPED_TRACE(mode);
+        PagedMemoryManager single(PAGE_SIZE, 1024);
+        PagedMemoryManager batch(PAGE_SIZE, 1024);
+        PagedMemoryManager* managers[] = {&single, &batch};
+        for (int m = 0; m < 2; m++) {
+            managers[m]->seedRandom(mode);
+            if (mode == 1) managers[m]->configureTlb(16, 4, Tlb::POLICY_LRU);
+            if (mode == 2) managers[m]->configurePageTable(3);
+            if (mode == 3) managers[m]->configureHugePages(PagedMemoryManager::HUGE_PAGES_2M);
+            if (mode == 4) managers[m]->configureDemandPaging(PageReplacer::POLICY_CLOCK);
+        }
+        Address size = (mode == 4 ? 3000 : 700) * Address(PAGE_SIZE) + 123;
+        int singleId = single.acceptJob("job", size).jobId;
+        int batchId = batch.acceptJob("job", size).jobId;
+        
+        mt19937 random(mode);
+        vector<Address> logical(4096);
+        for (size_t i = 0; i < logical.size(); i++) logical[i] = random() % (size + 2 * PAGE_SIZE);
+        vector<Address> expected(logical.size());
+        size_t translated = 0;
+        for (size_t i = 0; i < logical.size(); i++) {
+            TranslationResult result = single.resolveAddress(singleId, logical[i]);
+            expected[i] = result.success ? result.physicalAddress : TRANSLATION_OUT_OF_BOUNDS;
+            translated += result.success;
+        }
+        vector<Address> physical(logical.size());
+        EXPECT_EQ(translated, batch.resolveAddresses(batchId, logical.data(), logical.size(), physical.data()));
+        EXPECT_LT(translated, logical.size());
+        EXPECT_TRUE(expected == physical);
+        EXPECT_EQ(single.getPageFaults(), batch.getPageFaults());
+        EXPECT_EQ(single.getEvictions(), batch.getEvictions());
+        EXPECT_EQ(single.getTlb().hitCount(), batch.getTlb().hitCount());
+        
+        vector<Address> missing(3, 0);
+        EXPECT_EQ(0u, batch.resolveAddresses(batchId + 1, logical.data(), missing.size(), missing.data()));
+        EXPECT_EQ(TRANSLATION_NO_SUCH_JOB, missing[2]);
+    }
+}
+
+/**
+ * Every page-size split gives the page number and offset of a division:
+ * the 4 KB and 64 KB shift specializations, the generic shift for other
+ * powers of two, and the divide path for sizes that are not, one at a
+ * time and in batches
+ */
+TEST(PageSize, EverySplitDividesAlike) {
+    const uint32_t pageSizes[] = {4096, 65536, 1024, 1, 3000, 4095};
+    for (size_t s = 0; s < sizeof(pageSizes) / sizeof(pageSizes[0]); s++) {
+        uint32_t pageSize = pageSizes[s];
+        SCOPED_TRACE(pageSize);
+        PagedMemoryManager manager(pageSize, 512);
+        Address size = Address(pageSize) * 300 + pageSize / 2;
+        int jobId = manager.acceptJob("split", size).jobId;
+        const Job* job = manager.findJob(jobId);
+        const FrameTable& frames = manager.getFrameTable();
+        
+        mt19937_64 random(s);
+        vector<Address> logical(2000);
+        for (size_t i = 0; i < logical.size(); i++) logical[i] = random() % size;
+        logical[0] = 0;
+        logical[1] = size - 1;
+        logical[2] = Address(pageSize) * 7 - 1;
+        vector<Address> physical(logical.size());
+        ASSERT_EQ(logical.size(), manager.resolveAddresses(jobId, logical.data(), logical.size(), physical.data()));
+        for (size_t i = 0; i < logical.size(); i++) {
+            TranslationResult result = manager.resolveAddress(jobId, logical[i]);
+            ASSERT_TRUE(result.success);
+            EXPECT_EQ(logical[i] / pageSize, result.pageNumber);
+            EXPECT_EQ(logical[i] % pageSize, result.offset);
+            EXPECT_EQ(job->firstPage + logical[i] / pageSize, frames.pageOf(result.frameNumber));
+            EXPECT_EQ(Address(result.frameNumber) * pageSize + logical[i] % pageSize, result.physicalAddress);
+            EXPECT_EQ(result.physicalAddress, physical[i]);
+        }
+        EXPECT_FALSE(manager.resolveAddress(jobId, size).success);
+    }
+}
+
+/**
+ * Strings that leave the table have their entries and index nodes
+ * recycled, so a stream of distinct names (longer than any small-string
+ * buffer) stops allocating once the table has reached its peak size
+ */
+TEST(StringTable, RecyclesEntriesOfReleasedStrings) {
+    StringTable table;
+    string name(40, 'x');
+    vector<const string*> live;
+    live.reserve(8);
+    uint64_t before = 0;
+    for (int round = 0; round < 2000; round++) {
+        if (round == 1000) before = allocations.load();
+        snprintf(&name[0], 16, "%015d", round);
+        const string* interned = table.intern(name);
+        EXPECT_EQ(name, *interned);
+        live.push_back(interned);
+        if (live.size() == 8) {
+            table.release(live.front());
+            live.erase(live.begin());
+        }
+    }
+    EXPECT_EQ(0u, allocations.load() - before);
+    EXPECT_EQ(7u, table.size());
+    
+    // Interning a string already there shares it
+    const string* again = table.intern(*live.back());
+    EXPECT_EQ(live.back(), again);
+    table.release(again);
+    EXPECT_EQ(7u, table.size());
+}
+
+/**
+ * Replaying a text trace whose jobs all get distinct default names
+ * ("job<id>") costs the same allocations however long it runs
+ */
+TEST(TraceReplay, DistinctNamesDoNotAllocatePerJob) {
+    // Each job is accepted, translated once and removed eight jobs later
+    vector<TraceOp> ops;
+    string error;
+    uint64_t replayAllocations[2];
+    for (int run = 0; run < 2; run++) {
+        int jobs = run == 0 ? 400 : 1200;
+        ostringstream text;
+        for (int j = 1; j <= jobs; j++) {
+            text << "A " << j << " 8192\nR " << j << " 100\n";
+            if (j > 8) text << "X " << j - 8 << "\n";
+        }
+        ops.clear();
+        istringstream in(text.str());
+        ASSERT_TRUE(parseTextTrace(in, ops, error)) << error;
+        
+        PagedMemoryManager manager(PAGE_SIZE, 64);
+        replayTrace(manager, TextTraceSource(ops));
+        uint64_t before = allocations.load();
+        ReplayStats stats = replayTrace(manager, TextTraceSource(ops));
+        replayAllocations[run] = allocations.load() - before;
+        EXPECT_EQ(0u, stats.ops[TraceOp::ACCEPT].failures);
+        EXPECT_EQ(uint64_t(jobs), stats.ops[TraceOp::ACCEPT].count);
+    }
+    EXPECT_EQ(replayAllocations[0], replayAllocations[1]);
+}
+
+/**
+ * A text trace converted to the binary format decodes to the same
+ * operations and replays to the same outcome: the same counts and
+ * failures by status, the same frames and job names afterwards, and the
+ * same accesses seen by the analyzer
+ */
+TEST(TraceReplay, BinaryTraceMatchesTextSource) {
+    const char* names[] = {"", "db", "web server", "db", "batch job 7"};
+    mt19937 random(21);
+    ostringstream text;
+    text << "# generated\n\n";
+    for (int i = 0; i < 3000; i++) {
+        int jobId = 1 + random() % 40;
+        switch (random() % 8) {
+            case 0:
+            case 1:
+                text << "A " << jobId << " " << (random() % 20) * 3000 << " " << names[random() % 5] << "\n";
+                break;
+            case 2:
+                text << "X " << jobId << "\n";
+                break;
+            case 3:
+                text << "W " << jobId << " " << random() % 60000 << "  # write\n";
+                break;
+            case 4:
+                text << (random() % 2 ? "D\n" : "\n");
+                break;
+            default:
+                text << "R " << jobId << " " << int64_t(random() % 62000) - 1000 << "\n";
+                break;
+        }
+    }
+    
+    vector<TraceOp> ops;
+    string error;
+    istringstream parseIn(text.str());
+    ASSERT_TRUE(parseTextTrace(parseIn, ops, error)) << error;
+    const string path = testing::TempDir() + "memory_test_trace.bin";
+    istringstream convertIn(text.str());
+    uint64_t records = 0;
+    ASSERT_TRUE(convertTextTrace(convertIn, path, records, error)) << error;
+    MappedBinaryTrace binary;
+    ASSERT_TRUE(binary.open(path, error)) << error;
+    
+    TextTraceSource textSource(ops);
+    ASSERT_EQ(ops.size(), records);
+    ASSERT_EQ(textSource.size(), binary.size());
+    for (size_t i = 0; i < binary.size(); i++) {
+        TraceOpView expected = textSource[i];
+        TraceOpView actual = binary[i];
+        ASSERT_EQ(expected.kind, actual.kind) << "op " << i;
+        ASSERT_EQ(expected.jobId, actual.jobId) << "op " << i;
+        ASSERT_EQ(expected.value, actual.value) << "op " << i;
+        ASSERT_EQ(string(expected.name, expected.nameLength), string(actual.name, actual.nameLength)) << "op " << i;
+    }
+    
+    PagedMemoryManager fromText(PAGE_SIZE, 256);
+    PagedMemoryManager fromBinary(PAGE_SIZE, 256);
+    fromText.seedRandom(4);
+    fromBinary.seedRandom(4);
+    AccessAnalyzer textAnalyzer(16, 256);
+    AccessAnalyzer binaryAnalyzer(16, 256);
+    ReplayStats expected = replayTrace(fromText, textSource, &textAnalyzer);
+    ReplayStats actual = replayTrace(fromBinary, binary, &binaryAnalyzer);
+    binary.close();
+    remove(path.c_str());
+    
+    EXPECT_EQ(expected.totalOps, actual.totalOps);
+    for (int k = 0; k < TRACE_OP_KINDS; k++) {
+        EXPECT_EQ(expected.ops[k].count, actual.ops[k].count) << "kind " << k;
+        EXPECT_EQ(expected.ops[k].failures, actual.ops[k].failures) << "kind " << k;
+    }
+    EXPECT_GT(expected.ops[TraceOp::ACCEPT].failures, 0u);
+    EXPECT_GT(expected.ops[TraceOp::RESOLVE].failures, 0u);
+    for (int s = 0; s < STATUS_COUNT; s++) EXPECT_EQ(expected.failuresByStatus[s], actual.failuresByStatus[s]);
+    EXPECT_EQ(expected.lastUsedFrames, actual.lastUsedFrames);
+    
+    EXPECT_EQ(fromText.getJobCount(), fromBinary.getJobCount());
+    EXPECT_EQ(fromText.getUsedFrames(), fromBinary.getUsedFrames());
+    vector<const Job*> textJobs = fromText.jobsById();
+    vector<const Job*> binaryJobs = fromBinary.jobsById();
+    ASSERT_EQ(textJobs.size(), binaryJobs.size());
+    for (size_t j = 0; j < textJobs.size(); j++) {
+        EXPECT_EQ(*textJobs[j]->name, *binaryJobs[j]->name);
+        EXPECT_EQ(textJobs[j]->size, binaryJobs[j]->size);
+    }
+    EXPECT_TRUE(residentPages(fromText) == residentPages(fromBinary));
+    
+    EXPECT_EQ(textAnalyzer.accessCount(), binaryAnalyzer.accessCount());
+    EXPECT_EQ(textAnalyzer.beyondDepthCount(), binaryAnalyzer.beyondDepthCount());
+    for (int b = 0; b < AccessAnalyzer::DISTANCE_BUCKETS; b++) {
+        EXPECT_EQ(textAnalyzer.distanceCount(b), binaryAnalyzer.distanceCount(b)) << "bucket " << b;
+    }
+}
+
+/**
+ * Reuse distances and working sets match a brute-force count: the
+ * distance is the page's position in a move-to-front stack of every page
+ * seen, and a working set is the distinct pages among the job's last
+ * window accesses. The small depth makes the analyzer forget pages and
+ * renumber its slots many times over.
+ */
+TEST(AccessAnalyzer, MatchesBruteForce) {
+    const size_t depth = 24;
+    const uint64_t window = 10;
+    AccessAnalyzer analyzer(window, depth);
+    const int jobCount = 3;
+    const PageId pageCount = 40;
+    for (int j = 0; j < jobCount; j++) analyzer.trackJob(j + 1, pageCount);
+    
+    vector<uint64_t> stack;
+    uint64_t buckets[AccessAnalyzer::DISTANCE_BUCKETS] = {};
+    uint64_t beyond = 0;
+    vector<uint64_t> distances;
+    vector<vector<PageId> > history(jobCount);
+    vector<PageId> peak(jobCount, 0);
+    vector<double> sizeSum(jobCount, 0.0);
+    mt19937 random(5);
+    for (int i = 0; i < 20000; i++) {
+        int job = random() % jobCount;
+        // Mostly a hot set of 6 pages, sometimes the whole job
+        PageId page = random() % 4 ? random() % 6 : random() % pageCount;
+        analyzer.recordAccess(job + 1, page);
+        
+        uint64_t key = (uint64_t(job + 1) << 32) | page;
+        vector<uint64_t>::iterator it = find(stack.begin(), stack.end(), key);
+        if (it == stack.end()) {
+            beyond++;
+        } else {
+            uint64_t distance = it - stack.begin();
+            stack.erase(it);
+            if (distance < depth) {
+                buckets[distance == 0 ? 0 : 64 - __builtin_clzll(distance)]++;
+                distances.push_back(distance);
+            } else {
+                beyond++;
+            }
+        }
+        stack.insert(stack.begin(), key);
+        
+        history[job].push_back(page);
+        size_t start = history[job].size() > window ? history[job].size() - window : 0;
+        set<PageId> distinct(history[job].begin() + start, history[job].end());
+        peak[job] = max<PageId>(peak[job], distinct.size());
+        sizeSum[job] += distinct.size();
+    }
+    
+    EXPECT_EQ(20000u, analyzer.accessCount());
+    EXPECT_EQ(beyond, analyzer.beyondDepthCount());
+    for (int b = 0; b < AccessAnalyzer::DISTANCE_BUCKETS; b++) {
+        EXPECT_EQ(buckets[b], analyzer.distanceCount(b)) << "bucket " << b;
+    }
+    for (uint64_t capacity = 1; capacity <= depth; capacity *= 2) {
+        uint64_t hits = 0;
+        for (size_t i = 0; i < distances.size(); i++) hits += distances[i] < capacity;
+        EXPECT_EQ(hits, analyzer.lruHits(capacity)) << "capacity " << capacity;
+    }
+    
+    vector<AccessAnalyzer::JobWorkingSet> sets = analyzer.workingSets();
+    ASSERT_EQ(size_t(jobCount), sets.size());
+    for (int j = 0; j < jobCount; j++) {
+        SCOPED_TRACE(j);
+        size_t start = history[j].size() - window;
+        EXPECT_EQ(history[j].size(), sets[j].accesses);
+        EXPECT_EQ(set<PageId>(history[j].begin() + start, history[j].end()).size(), sets[j].current);
+        EXPECT_EQ(peak[j], sets[j].peak);
+        EXPECT_DOUBLE_EQ(sizeSum[j], sets[j].sizeSum);
+    }
+}
+
+static void expectSameHistogram(const FreeRunHistogram& expected, const FreeRunHistogram& actual) {
+    for (int b = 0; b < FreeRunHistogram::BUCKETS; b++) {
+        EXPECT_EQ(expected.buckets[b], actual.buckets[b]) << "bucket " << b;
+    }
+    EXPECT_EQ(expected.runCount, actual.runCount);
+    EXPECT_EQ(expected.largestRun, actual.largestRun);
+    EXPECT_EQ(expected.freeFrames, actual.freeFrames);
+}
+
+/**
+ * The dispatched occupancy kernels (AVX2 or NEON where available) must
+ * match the scalar ones, and both a bit-by-bit count, on bitmaps mixing
+ * free, full and random words so every block path runs, with frame counts
+ * that end mid-word and garbage in the bits past the last frame
+ */
+TEST(OccupancyKernels, MatchScalarOnRaggedBitmaps) {
+    mt19937_64 random(12);
+    for (int round = 0; round < 400; round++) {
+        SCOPED_TRACE(round);
+        FrameId frameCount = 1 + random() % 3000;
+        size_t wordCount = (frameCount + 63) / 64;
+        vector<uint64_t> words(wordCount);
+        for (size_t w = 0; w < wordCount; w++) {
+            switch (random() % 3) {
+                case 0: words[w] = 0; break;
+                case 1: words[w] = ~uint64_t(0); break;
+                default: words[w] = random() & random(); break;
+            }
+        }
+        
+        // Bit-by-bit reference over the frames that exist
+        uint64_t occupied = 0;
+        vector<FrameId> freeFrames;
+        FreeRunHistogram runs = FreeRunHistogram();
+        uint64_t run = 0;
+        for (FrameId f = 0; f <= frameCount; f++) {
+            bool isFree = f < frameCount && !((words[f / 64] >> (f % 64)) & 1);
+            if (f < frameCount && !isFree) occupied++;
+            if (isFree) {
+                freeFrames.push_back(f);
+                run++;
+                continue;
+            }
+            if (run == 0) continue;
+            runs.buckets[63 - __builtin_clzll(run)]++;
+            runs.runCount++;
+            runs.largestRun = max(runs.largestRun, run);
+            runs.freeFrames += run;
+            run = 0;
+        }
+        
+        EXPECT_EQ(scalarCountOccupied(words.data(), wordCount), occupancyCountOccupied(words.data(), wordCount));
+        if (frameCount % 64 == 0) {
+            EXPECT_EQ(occupied, occupancyCountOccupied(words.data(), wordCount));
+        }
+        size_t count = random() % (freeFrames.size() + 2);
+        vector<FrameId> scalarOut(count + 1), kernelOut(count + 1);
+        size_t scalarFound = scalarFindFreeFrames(words.data(), frameCount, count, scalarOut.data());
+        size_t kernelFound = occupancyFindFreeFrames(words.data(), frameCount, count, kernelOut.data());
+        ASSERT_EQ(min(count, freeFrames.size()), scalarFound);
+        ASSERT_EQ(scalarFound, kernelFound);
+        for (size_t i = 0; i < kernelFound; i++) {
+            EXPECT_EQ(freeFrames[i], scalarOut[i]);
+            EXPECT_EQ(freeFrames[i], kernelOut[i]);
+        }
+        expectSameHistogram(runs, scalarFreeRunHistogram(words.data(), frameCount));
+        expectSameHistogram(runs, occupancyFreeRunHistogram(words.data(), frameCount));
+    }
+}
+
+/**
+ * A demand-paged radix table pays for the pages touched, not the job's
+ * virtual size: each page touched in a fresh region adds one node per
+ * level below the root, and a walk reads one entry per level
+ */
+TEST(RadixPageTable, SparseJobScalesWithPagesTouched) {
+    for (int levels = RadixPageTable::MIN_LEVELS; levels <= RadixPageTable::MAX_LEVELS; levels++) {
+        SCOPED_TRACE(levels);
+        PagedMemoryManager manager(PAGE_SIZE, 64);
+        manager.configurePageTable(levels);
+        manager.configureDemandPaging(PageReplacer::POLICY_LRU);
+        EXPECT_EQ(levels, manager.getPageTableLevels());
+        
+        // One root entry (and so a separate subtree) per page touched
+        const int touched = 8;
+        const PageId stride = PageId(1) << (RadixPageTable::NODE_BITS * (levels - 1));
+        const uint64_t pageCount = uint64_t(stride) * touched;
+        int jobId = manager.acceptJob("sparse", pageCount * PAGE_SIZE).jobId;
+        size_t nodes;
+        size_t emptyBytes = RadixPageTable::emptyEntries(levels, pageCount) * sizeof(uint32_t);
+        EXPECT_LE(manager.pageTableBytes(nodes), 2 * emptyBytes);
+        EXPECT_EQ(1u, nodes);
+        
+        for (int i = 0; i < touched; i++) {
+            Address address = Address(stride) * i * PAGE_SIZE + 7;
+            TranslationResult fault = manager.resolveAddress(jobId, address);
+            ASSERT_TRUE(fault.success);
+            EXPECT_TRUE(fault.pageFault);
+            EXPECT_EQ(1, fault.walkDepth);  // The root entry was empty
+            TranslationResult hit = manager.resolveAddress(jobId, address);
+            EXPECT_FALSE(hit.pageFault);
+            EXPECT_EQ(levels, hit.walkDepth);
+            EXPECT_EQ(fault.physicalAddress, hit.physicalAddress);
+            
+            size_t bytes = manager.pageTableBytes(nodes);
+            size_t nodeBytes = RadixPageTable::NODE_ENTRIES * sizeof(uint32_t);
+            size_t usedBytes = emptyBytes + size_t(i + 1) * (levels - 1) * nodeBytes;
+            EXPECT_EQ(1u + size_t(i + 1) * (levels - 1), nodes);
+            EXPECT_GE(bytes, usedBytes);
+            EXPECT_LE(bytes, 4 * usedBytes);
+        }
+        size_t fullBytes = RadixPageTable::fullEntries(levels, pageCount) * sizeof(uint32_t);
+        if (levels > 2) {
+            EXPECT_LT(manager.pageTableBytes(nodes) * 100, fullBytes);
+        }
+        EXPECT_GT(manager.getAverageWalkDepth(), 1.0);
+        EXPECT_LT(manager.getAverageWalkDepth(), double(levels));
+    }
+}
+
+/**
+ * Every way an accept can fail comes back as its status, counted by the
+ * operation stats, with the numbers behind its message
+ */
+TEST(Status, AcceptReportsEachFailure) {
+    PagedMemoryManager manager(PAGE_SIZE, 16);
+    AcceptResult result = manager.acceptJob("empty", 0);
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(Status::InvalidSize, result.status);
+    
+    result = manager.acceptJob("large", 17 * PAGE_SIZE);
+    EXPECT_EQ(Status::OutOfFrames, result.status);
+    EXPECT_EQ(17u, result.detail.values[0]);
+    EXPECT_EQ(16u, result.detail.values[1]);
+    EXPECT_NE(string::npos, result.errorMessage().find("Need 17 frames"));
+    
+    // Every other frame taken: enough free frames, but no run of two
+    manager.setPlacement(PagedMemoryManager::PLACEMENT_FIRST_FIT);
+    vector<int> jobIds;
+    for (int i = 0; i < 16; i++) jobIds.push_back(manager.acceptJob("page", PAGE_SIZE).jobId);
+    for (int i = 0; i < 16; i += 2) manager.removeJob(jobIds[i]);
+    result = manager.acceptJob("pair", 2 * PAGE_SIZE);
+    EXPECT_EQ(Status::Fragmented, result.status);
+    EXPECT_EQ(-1, result.jobId);
+    EXPECT_EQ(8u, manager.getUsedFrames());
+    
+    PagedMemoryManager demand(PAGE_SIZE, 16);
+    demand.configureDemandPaging(PageReplacer::POLICY_LRU);
+    EXPECT_EQ(Status::TooLarge, demand.acceptJob("huge", ~Address(0)).status);
+    
+    StatCounters counters = manager.getOperationStats().counters();
+    EXPECT_EQ(16u, counters.accepts);
+    EXPECT_EQ(2u, counters.acceptRejects);
+    EXPECT_EQ(1u, counters.acceptFailures);
+}
+
+/**
+ * Translation failures, single and batched, leave the manager's counts of
+ * translations untouched and carry their status
+ */
+TEST(Status, TranslateReportsEachFailure) {
+    PagedMemoryManager manager(PAGE_SIZE, 16);
+    int jobId = manager.acceptJob("job", 2 * PAGE_SIZE + 1).jobId;
+    
+    TranslationResult result = manager.resolveAddress(jobId + 1, 0);
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(Status::NoSuchJob, result.status);
+    result = manager.resolveAddress(jobId, 2 * PAGE_SIZE + 1);
+    EXPECT_EQ(Status::OutOfBounds, result.status);
+    EXPECT_EQ(2u * PAGE_SIZE + 1, result.detail.values[2]);
+    EXPECT_EQ(Status::OutOfBounds, manager.resolveWrite(jobId, ~Address(0)).status);
+    EXPECT_EQ(0u, manager.getTranslations());
+    
+    Address logical[3] = {0, 2 * PAGE_SIZE, 3 * PAGE_SIZE};
+    Address physical[3];
+    EXPECT_EQ(2u, manager.resolveAddresses(jobId, logical, 3, physical));
+    EXPECT_EQ(TRANSLATION_OUT_OF_BOUNDS, physical[2]);
+    EXPECT_EQ(0u, manager.resolveAddresses(jobId + 1, logical, 3, physical));
+    for (int i = 0; i < 3; i++) EXPECT_EQ(TRANSLATION_NO_SUCH_JOB, physical[i]);
+    
+    StatCounters counters = manager.getOperationStats().counters();
+    EXPECT_EQ(2u, counters.translations);
+    EXPECT_EQ(7u, counters.translationFailures);
+}
+
+/**
+ * Removing a job that is not there fails without touching memory
+ */
+TEST(Status, RemoveReportsEachFailure) {
+    PagedMemoryManager manager(PAGE_SIZE, 16);
+    int jobId = manager.acceptJob("job", PAGE_SIZE).jobId;
+    
+    EXPECT_EQ(Status::InvalidJobId, manager.removeJob(0).status);
+    EXPECT_EQ(Status::InvalidJobId, manager.removeJob(-3).status);
+    EXPECT_EQ(Status::NoSuchJob, manager.removeJob(jobId + 1).status);
+    EXPECT_EQ(1u, manager.getUsedFrames());
+    
+    RemoveResult removed = manager.removeJob(jobId);
+    EXPECT_TRUE(removed.success);
+    EXPECT_EQ(1u, removed.framesFreed);
+    RemoveResult again = manager.removeJob(jobId);
+    EXPECT_EQ(Status::NoSuchJob, again.status);
+    EXPECT_NE(string::npos, again.errorMessage().find("not found"));
+    EXPECT_EQ(0u, manager.getUsedFrames());
+    EXPECT_EQ(4u, manager.getOperationStats().counters().removeFailures);
+}
+
+/**
+ * A fault whose radix nodes cannot be allocated reports NoMemory, serves
+ * no fault and evicts nothing; once memory is back the same page loads
+ */
+TEST(Status, FaultWithoutNodeMemoryReportsNoMemory) {
+    PagedMemoryManager manager(PAGE_SIZE, 4);
+    manager.configurePageTable(4);
+    manager.configureDemandPaging(PageReplacer::POLICY_LRU);
+    const Address spanPages = Address(1) << 28;
+    int jobId = manager.acceptJob("sparse", spanPages * PAGE_SIZE).jobId;
+    const vector<uint32_t>& storage = manager.findJob(jobId)->radixTable.nodeStorage();
+    
+    // Each page 2^18 apart needs a new leaf and a new node above it
+    const PageId stride = PageId(1) << 18;
+    PageId page = 0;
+    while (storage.size() + 2 * RadixPageTable::NODE_ENTRIES <= storage.capacity()) {
+        ASSERT_TRUE(manager.resolveAddress(jobId, Address(page) * PAGE_SIZE).success);
+        page += stride;
+    }
+    uint64_t faults = manager.getPageFaults();
+    uint64_t evictions = manager.getEvictions();
+    Address logical = Address(page) * PAGE_SIZE;
+    Address physical = 0;
+    
+    failAllocations = true;
+    TranslationResult result = manager.resolveAddress(jobId, logical);
+    size_t translated = manager.resolveAddresses(jobId, &logical, 1, &physical);
+    failAllocations = false;
+    
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(Status::NoMemory, result.status);
+    EXPECT_NE(string::npos, result.errorMessage().find("page-table nodes"));
+    EXPECT_EQ(0u, translated);
+    EXPECT_EQ(TRANSLATION_NO_MEMORY, physical);
+    EXPECT_EQ(faults, manager.getPageFaults());
+    EXPECT_EQ(evictions, manager.getEvictions());
+    
+    result = manager.resolveAddress(jobId, logical);
+    ASSERT_TRUE(result.success);
+    EXPECT_TRUE(result.pageFault);
+}
+
+/**
+ * A job of one 1 GB page, two 2 MB pages and some base pages translates
+ * every address exactly as the same job mapped with 4 KB pages only: on a
+ * fresh manager with first-fit placement both lay it out from frame 0, so
+ * the physical addresses must be equal, and the frame table must record
+ * each frame of a huge page as holding its base page. Checked through
+ * the page table, through the TLB's huge entries, and in batches.
+ */
+TEST(HugePages, TranslateLikeBasePages) {
+    const FrameId frameCount = FrameId(1) << 19;
+    const PageId pageCount = (PageId(1) << HUGE_PAGE_SHIFTS[0]) + (2 << HUGE_PAGE_SHIFTS[1]) + 37;
+    PagedMemoryManager huge(PAGE_SIZE, frameCount);
+    PagedMemoryManager base(PAGE_SIZE, frameCount);
+    huge.configureHugePages(PagedMemoryManager::HUGE_PAGES_ALL);
+    huge.configureTlb(64, 4, Tlb::POLICY_LRU);
+    huge.setPlacement(PagedMemoryManager::PLACEMENT_FIRST_FIT);
+    base.setPlacement(PagedMemoryManager::PLACEMENT_FIRST_FIT);
+    int hugeId = huge.acceptJob("huge", Address(pageCount) * PAGE_SIZE).jobId;
+    int baseId = base.acceptJob("base", Address(pageCount) * PAGE_SIZE).jobId;
+    const Job* job = huge.findJob(hugeId);
+    ASSERT_EQ(1u, job->hugeFrames[0].size());
+    ASSERT_EQ(2u, job->hugeFrames[1].size());
+    ASSERT_EQ(pageCount - 37, job->hugeCoveredPages);
+    
+    const FrameTable& frames = huge.getFrameTable();
+    vector<Address> addresses;
+    for (PageId page = 0; page < pageCount; page += page < job->hugeCoveredPages ? 97 : 1) {
+        addresses.push_back(Address(page) * PAGE_SIZE + (page * 131) % PAGE_SIZE);
+    }
+    addresses.push_back(Address(job->hugeCoveredPages) * PAGE_SIZE - 1);  // Last byte of the last huge page
+    for (int pass = 0; pass < 2; pass++) {
+        SCOPED_TRACE(pass);  // The second pass hits the TLB
+        size_t mismatches = 0;
+        for (size_t i = 0; i < addresses.size(); i++) {
+            TranslationResult expected = base.resolveAddress(baseId, addresses[i]);
+            TranslationResult actual = huge.resolveAddress(hugeId, addresses[i]);
+            ASSERT_TRUE(expected.success && actual.success);
+            mismatches += expected.physicalAddress != actual.physicalAddress ||
+                          expected.frameNumber != actual.frameNumber ||
+                          frames.ownerOf(actual.frameNumber) != hugeId ||
+                          frames.pageOf(actual.frameNumber) != job->firstPage + addresses[i] / PAGE_SIZE;
+        }
+        EXPECT_EQ(0u, mismatches);
+    }
+    EXPECT_GT(huge.getTlb().hitCount(), 0u);
+    EXPECT_GT(huge.getHugeTranslations(), 0u);
+    
+    vector<Address> expected(addresses.size()), actual(addresses.size());
+    EXPECT_EQ(addresses.size(), base.resolveAddresses(baseId, addresses.data(), addresses.size(), expected.data()));
+    EXPECT_EQ(addresses.size(), huge.resolveAddresses(hugeId, addresses.data(), addresses.size(), actual.data()));
+    EXPECT_TRUE(expected == actual);
+}
+
+/**
+ * On memory fragmented by churn each placement policy gives the layout it
+ * promises: first fit the lowest free run of the job's length (and
+ * Fragmented when none exists), buddy one run per set bit of the page
+ * count, largest first and aligned to its size, and NUMA-local only frames
+ * of the requested node while that node has room
+ */
+TEST(Placement, PoliciesKeepTheirLayout) {
+    const FrameId frameCount = 1024;
+    const int nodes = 4;
+    const FrameId nodeFrames = frameCount / nodes;
+    PagedMemoryManager manager(PAGE_SIZE, frameCount);
+    manager.configureNuma(nodes);
+    manager.seedRandom(3);
+    const FrameTable& frames = manager.getFrameTable();
+    mt19937 random(3);
+    vector<int> jobIds;
+    int checked[3] = {0, 0, 0};
+    for (int i = 0; i < 3000; i++) {
+        if (jobIds.size() > 8 && random() % 2) {
+            size_t victim = random() % jobIds.size();
+            manager.removeJob(jobIds[victim]);
+            jobIds.erase(jobIds.begin() + victim);
+            continue;
+        }
+        PagedMemoryManager::Placement policy = static_cast<PagedMemoryManager::Placement>(random() % 4);
+        FrameId pages = 1 + random() % 60;
+        int node = random() % nodes;
+        vector<bool> wasFree(frameCount);
+        for (FrameId f = 0; f < frameCount; f++) wasFree[f] = !frames.isOccupied(f);
+        FrameId lowestRun = INVALID_FRAME;
+        for (FrameId start = 0, run = 0; start < frameCount && lowestRun == INVALID_FRAME; start++) {
+            run = wasFree[start] ? run + 1 : 0;
+            if (run == pages) lowestRun = start + 1 - pages;
+        }
+        FrameId nodeFree = 0;
+        for (FrameId f = node * nodeFrames; f < (node + 1) * nodeFrames; f++) nodeFree += wasFree[f];
+        
+        AcceptResult result = manager.acceptJob("placed", Address(pages) * PAGE_SIZE, policy, node);
+        if (policy == PagedMemoryManager::PLACEMENT_FIRST_FIT && lowestRun == INVALID_FRAME) {
+            EXPECT_FALSE(result.success);
+            if (manager.getTotalFrames() - manager.getUsedFrames() >= pages) {
+                EXPECT_EQ(Status::Fragmented, result.status);
+            }
+        }
+        if (!result.success) continue;
+        jobIds.push_back(result.jobId);
+        const vector<FrameId>& placed = manager.findJob(result.jobId)->frameTable;
+        ASSERT_EQ(pages, placed.size());
+        for (size_t p = 0; p < placed.size(); p++) EXPECT_TRUE(wasFree[placed[p]]);
+        
+        switch (policy) {
+            case PagedMemoryManager::PLACEMENT_FIRST_FIT:
+                checked[0]++;
+                for (size_t p = 0; p < placed.size(); p++) EXPECT_EQ(lowestRun + p, placed[p]);
+                break;
+            case PagedMemoryManager::PLACEMENT_BUDDY: {
+                checked[1]++;
+                size_t p = 0;
+                for (int order = 31; order >= 0; order--) {
+                    FrameId block = FrameId(1) << order;
+                    if (!(pages & block)) continue;
+                    EXPECT_EQ(0u, placed[p] % block) << "block of " << block;
+                    for (FrameId b = 1; b < block; b++) EXPECT_EQ(placed[p] + b, placed[p + b]);
+                    p += block;
+                }
+                break;
+            }
+            case PagedMemoryManager::PLACEMENT_NUMA_LOCAL:
+                if (nodeFree < pages) break;
+                checked[2]++;
+                for (size_t p = 0; p < placed.size(); p++) EXPECT_EQ(node, int(placed[p] / nodeFrames));
+                break;
+            default:
+                break;
+        }
+    }
+    for (int c = 0; c < 3; c++) EXPECT_GT(checked[c], 50) << "policy " << c + 1;
+}
+
+/**
+ * Run a fixed mix of accepts, removals and fault-serving translations and
+ * return where every page ended up
+ */
+static map<int, vector<pair<PageId, FrameId> > > placeWithSeed(uint64_t seed, int mode) {
+    PagedMemoryManager manager(PAGE_SIZE, 512);
+    manager.configureNuma(4);
+    if (mode == 4) manager.configureDemandPaging(PageReplacer::POLICY_CLOCK);
+    else manager.setPlacement(static_cast<PagedMemoryManager::Placement>(mode));
+    manager.seedRandom(seed);
+    mt19937 random(99);
+    vector<int> jobIds;
+    for (int i = 0; i < 300; i++) {
+        if (jobIds.size() > 6 && random() % 3 == 0) {
+            size_t victim = random() % jobIds.size();
+            manager.removeJob(jobIds[victim]);
+            jobIds.erase(jobIds.begin() + victim);
+            continue;
+        }
+        Address size = (1 + random() % 40) * PAGE_SIZE;
+        AcceptResult result = manager.acceptJob("seeded", size);
+        if (!result.success) continue;
+        jobIds.push_back(result.jobId);
+        for (int t = 0; t < 8; t++) manager.resolveAddress(result.jobId, random() % size);
+    }
+    return residentPages(manager);
+}
+
+/**
+ * The same seed and placement give the same frames on every run, under
+ * every placement policy and for demand-paging faults; for the policies
+ * that draw random frames another seed gives other frames
+ */
+TEST(Placement, SeedReproducesFrames) {
+    for (int mode = 0; mode < 5; mode++) {
+        SCOPED_TRACE(mode);
+        map<int, vector<pair<PageId, FrameId> > > first = placeWithSeed(7, mode);
+        EXPECT_FALSE(first.empty());
+        EXPECT_TRUE(first == placeWithSeed(7, mode));
+        bool random = mode == PagedMemoryManager::PLACEMENT_RANDOM || mode == PagedMemoryManager::PLACEMENT_NUMA_LOCAL ||
+                      mode == 4;
+        if (random) {
+            EXPECT_FALSE(first == placeWithSeed(8, mode));
+        }
+    }
+}
+
+/**
+ * Faults Clock takes on reference with frameCount frames when the first
+ * faults land in firstFrames (the hand sweeps frames in number order, so
+ * unlike the list policies its count depends on where pages were placed)
+ */
+static uint64_t clockFaults(const vector<PageId>& reference, const vector<FrameId>& firstFrames,
+                            FrameId frameCount) {
+    map<PageId, FrameId> frameOf;
+    vector<PageId> pageIn(frameCount);
+    vector<bool> referenced(frameCount, false);
+    FrameId hand = 0;
+    uint64_t faults = 0;
+    for (size_t i = 0; i < reference.size(); i++) {
+        PageId page = reference[i];
+        if (frameOf.count(page)) {
+            referenced[frameOf[page]] = true;
+            continue;
+        }
+        FrameId frame;
+        if (faults < frameCount) {
+            frame = firstFrames[faults];
+        } else {
+            while (referenced[hand]) {
+                referenced[hand] = false;
+                hand = (hand + 1) % frameCount;
+            }
+            frame = hand;
+            hand = (hand + 1) % frameCount;
+            frameOf.erase(pageIn[frame]);
+        }
+        faults++;
+        frameOf[page] = frame;
+        pageIn[frame] = page;
+        referenced[frame] = true;
+    }
+    return faults;
+}
+
+/**
+ * Belady's reference string 1 2 3 4 1 2 5 1 2 3 4 5: with 3 frames FIFO
+ * faults 9 times and LRU 10; ARC fills T1, promotes 1 and 2 to T2, and
+ * adapts on 5's ghost hit for 10; FIFO with 4 frames shows the anomaly
+ * (10 faults). Every fault past the first frameCount is an eviction.
+ */
+TEST(Replacement, BeladyStringFaultCounts) {
+    const PageId belady[] = {1, 2, 3, 4, 1, 2, 5, 1, 2, 3, 4, 5};
+    const vector<PageId> reference(belady, belady + sizeof(belady) / sizeof(belady[0]));
+    struct Case { PageReplacer::Policy policy; FrameId frameCount; uint64_t faults; };
+    const Case cases[] = {
+        {PageReplacer::POLICY_FIFO, 3, 9},
+        {PageReplacer::POLICY_LRU, 3, 10},
+        {PageReplacer::POLICY_CLOCK, 3, 0},  // From clockFaults()
+        {PageReplacer::POLICY_ARC, 3, 10},
+        {PageReplacer::POLICY_FIFO, 4, 10}
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (uint64_t seed = 1; seed <= 6; seed++) {
+            SCOPED_TRACE(PageReplacer::policyName(cases[c].policy));
+            SCOPED_TRACE(cases[c].frameCount);
+            SCOPED_TRACE(seed);
+            PagedMemoryManager manager(PAGE_SIZE, cases[c].frameCount);
+            manager.seedRandom(seed);
+            manager.configureDemandPaging(cases[c].policy);
+            int jobId = manager.acceptJob("belady", 6 * PAGE_SIZE).jobId;
+            vector<FrameId> firstFrames;
+            for (size_t i = 0; i < reference.size(); i++) {
+                TranslationResult result = manager.resolveAddress(jobId, reference[i] * PAGE_SIZE);
+                ASSERT_TRUE(result.success);
+                if (result.pageFault && firstFrames.size() < cases[c].frameCount) {
+                    firstFrames.push_back(result.frameNumber);
+                }
+            }
+            uint64_t faults = cases[c].policy == PageReplacer::POLICY_CLOCK
+                                  ? clockFaults(reference, firstFrames, cases[c].frameCount)
+                                  : cases[c].faults;
+            EXPECT_EQ(faults, manager.getPageFaults());
+            EXPECT_EQ(faults - cases[c].frameCount, manager.getEvictions());
+        }
+    }
+}
+
+/**
+ * Random accesses to more pages than frames under every policy and page
+ * table: a page the owner no longer maps must fault (a stale TLB entry
+ * would hit instead), and each eviction unmaps exactly one page, whose
+ * frame the faulting page then occupies
+ */
+TEST(Replacement, EvictionUnmapsVictim) {
+    const PageReplacer::Policy policies[] = {PageReplacer::POLICY_FIFO, PageReplacer::POLICY_LRU,
+                                             PageReplacer::POLICY_CLOCK, PageReplacer::POLICY_ARC};
+    for (int mode = 0; mode < 8; mode++) {
+        SCOPED_TRACE(mode);
+        PagedMemoryManager manager(PAGE_SIZE, 4);
+        manager.seedRandom(mode);
+        manager.configureTlb(8, 8, Tlb::POLICY_LRU);
+        if (mode >= 4) manager.configurePageTable(2);
+        manager.configureDemandPaging(policies[mode % 4]);
+        int jobId = manager.acceptJob("evict", 10 * PAGE_SIZE).jobId;
+        const FrameTable& frames = manager.getFrameTable();
+        mt19937 random(mode);
+        for (int i = 0; i < 500; i++) {
+            PageId page = random() % 10;
+            vector<pair<PageId, FrameId> > before = residentPages(manager)[jobId];
+            bool wasResident = false;
+            for (size_t p = 0; p < before.size(); p++) wasResident |= before[p].first == page;
+            uint64_t evictions = manager.getEvictions();
+            
+            TranslationResult result = manager.resolveAddress(jobId, page * PAGE_SIZE);
+            ASSERT_TRUE(result.success);
+            EXPECT_EQ(!wasResident, result.pageFault) << "page " << page;
+            if (!wasResident) {
+                EXPECT_FALSE(result.tlbHit) << "page " << page;
+            }
+            EXPECT_EQ(jobId, frames.ownerOf(result.frameNumber));
+            EXPECT_EQ(manager.findJob(jobId)->firstPage + page, frames.pageOf(result.frameNumber));
+            
+            vector<pair<PageId, FrameId> > after = residentPages(manager)[jobId];
+            if (manager.getEvictions() == evictions) continue;
+            ASSERT_EQ(before.size(), after.size());
+            size_t unmapped = 0;
+            for (size_t p = 0; p < before.size(); p++) {
+                bool stillMapped = false;
+                for (size_t q = 0; q < after.size(); q++) stillMapped |= after[q] == before[p];
+                if (stillMapped) continue;
+                unmapped++;
+                EXPECT_EQ(result.frameNumber, before[p].second);
+            }
+            EXPECT_EQ(1u, unmapped);
+        }
+    }
+}
+
+/**
+ * Under ARC, a prefetched page enters T1 and its first demand access is
+ * its first reference: a sequential scan read ahead must leave T2 empty,
+ * while a second pass over the same pages promotes them
+ */
+TEST(Swap, PrefetchedScanStaysInRecencyList) {
+    PagedMemoryManager manager(PAGE_SIZE, 32);
+    manager.configureDemandPaging(PageReplacer::POLICY_ARC);
+    manager.configureSwap(10000, 4096, 4, 8);
+    int jobId = manager.acceptJob("scan", 256 * PAGE_SIZE).jobId;
+    for (PageId page = 0; page < 256; page++) {
+        ASSERT_TRUE(manager.resolveAddress(jobId, page * PAGE_SIZE).success);
+    }
+    const SwapStats& stats = manager.getSwap().stats();
+    EXPECT_GT(stats.prefetchHits, 200u);
+    EXPECT_EQ(0u, manager.getReplacer().frequentPages());
+    EXPECT_EQ(32u, manager.getReplacer().recentPages());
+    
+    for (PageId page = 256 - 8; page < 256; page++) manager.resolveAddress(jobId, page * PAGE_SIZE);
+    EXPECT_EQ(8u, manager.getReplacer().frequentPages());
+}
+
+/**
+ * Faults on an idle device each stall for the latency plus one page's
+ * transfer (4 KB at 4096 MB/s is 1000 ns), on top of the compute time
+ * every access costs; hits cost compute time only
+ */
+TEST(Swap, FaultsStallForLatencyAndTransfer) {
+    PagedMemoryManager manager(PAGE_SIZE, 16);
+    manager.configureDemandPaging(PageReplacer::POLICY_LRU);
+    manager.configureSwap(50000, 4096, 4, 0);
+    const SwapDevice& swap = manager.getSwap();
+    EXPECT_EQ(1000u, swap.transferTime());
+    EXPECT_EQ(51000u, swap.unloadedReadNs());
+    
+    int jobId = manager.acceptJob("stall", 16 * PAGE_SIZE).jobId;
+    for (int pass = 0; pass < 3; pass++) {
+        for (PageId page = 0; page < 16; page++) manager.resolveAddress(jobId, page * PAGE_SIZE);
+    }
+    const SwapStats& stats = swap.stats();
+    EXPECT_EQ(16u, stats.demandReads);
+    EXPECT_EQ(16u * 51000, stats.stallNs);
+    EXPECT_EQ(48u * SwapDevice::ACCESS_NS + stats.stallNs, stats.simulatedNs);
+    EXPECT_EQ(0u, stats.prefetchesIssued);
+}
+
+/**
+ * Only written pages are written back when evicted, one request per full
+ * batch; a batch counts once the device has finished it
+ */
+TEST(Swap, DirtyEvictionsWriteInBatches) {
+    PagedMemoryManager manager(PAGE_SIZE, 8);
+    manager.configureDemandPaging(PageReplacer::POLICY_FIFO);
+    manager.configureSwap(20000, 4096, 3, 0);
+    int jobId = manager.acceptJob("dirty", 64 * PAGE_SIZE).jobId;
+    
+    // Write 7 of the first 8 pages, then evict them all with clean reads
+    for (PageId page = 0; page < 8; page++) {
+        if (page == 5) manager.resolveAddress(jobId, page * PAGE_SIZE);
+        else manager.resolveWrite(jobId, page * PAGE_SIZE);
+    }
+    for (PageId page = 8; page < 64; page++) manager.resolveAddress(jobId, page * PAGE_SIZE);
+    
+    const SwapStats& stats = manager.getSwap().stats();
+    EXPECT_EQ(56u, manager.getEvictions());
+    EXPECT_EQ(7u, stats.dirtyEvictions);
+    EXPECT_EQ(2u, stats.writeBatches);  // The seventh page waits for a full batch
+    EXPECT_EQ(6u, stats.pagesWritten);
+}
+
+/**
+ * A prefetched page that arrived before its first access hides the whole
+ * fault latency; on a device too slow to keep up with the scan, accesses
+ * wait for part of it and only the rest is hidden
+ */
+TEST(Swap, PrefetchHitsHideLatencyTheyDidNotWaitFor) {
+    for (int slow = 0; slow < 2; slow++) {
+        SCOPED_TRACE(slow);
+        PagedMemoryManager manager(PAGE_SIZE, 128);
+        manager.configureDemandPaging(PageReplacer::POLICY_LRU);
+        manager.configureSwap(slow ? 20000 : 50, slow ? 4096 : 4096000, 4, 4);
+        int jobId = manager.acceptJob("scan", 64 * PAGE_SIZE).jobId;
+        for (PageId page = 0; page < 64; page++) manager.resolveAddress(jobId, page * PAGE_SIZE);
+        
+        const SwapStats& stats = manager.getSwap().stats();
+        uint64_t unloaded = manager.getSwap().unloadedReadNs();
+        EXPECT_EQ(64u, stats.demandReads + stats.prefetchHits);
+        EXPECT_EQ(0u, stats.prefetchesWasted);
+        EXPECT_GT(stats.prefetchHits, 50u);
+        if (slow) {
+            EXPECT_GT(stats.hiddenNs, 0u);
+            EXPECT_LT(stats.hiddenNs, stats.prefetchHits * unloaded);
+        } else {
+            EXPECT_EQ(stats.prefetchHits * unloaded, stats.hiddenNs);
+        }
+        
+        // Stalls are the waits for prefetched pages (the latency not hidden)
+        // plus the faults, each at least the unloaded latency (a read may
+        // also queue behind the 4 pages of a prefetch window on the channel)
+        uint64_t prefetchWaits = stats.prefetchHits * unloaded - stats.hiddenNs;
+        EXPECT_GE(stats.stallNs, prefetchWaits + stats.demandReads * unloaded);
+        EXPECT_LE(stats.stallNs, prefetchWaits + stats.demandReads * (unloaded + 4 * manager.getSwap().transferTime()));
+    }
+}
+
+/**
+ * Check the frame table against the page tables: a frame is occupied
+ * exactly when some job maps it, its mapping count is the number of jobs
+ * that do, and its owner is one of them; every frame is either in use or
+ * free, but never both or neither
+ */
+static void expectSharesMatchMappings(const PagedMemoryManager& manager) {
+    const FrameTable& frames = manager.getFrameTable();
+    map<FrameId, vector<pair<int, PageId> > > mappings;
+    vector<const Job*> jobs = manager.jobsById();
+    for (size_t j = 0; j < jobs.size(); j++) {
+        int jobId = jobs[j]->id;
+        jobs[j]->forEachResidentPage([&](PageId page, FrameId frame) {
+            mappings[frame].push_back(make_pair(jobId, page));
+        });
+    }
+    uint64_t sharedMappings = 0;
+    for (FrameId frame = 0; frame < manager.getTotalFrames(); frame++) {
+        map<FrameId, vector<pair<int, PageId> > >::const_iterator it = mappings.find(frame);
+        if (it == mappings.end()) {
+            EXPECT_FALSE(frames.isOccupied(frame)) << "frame " << frame;
+            continue;
+        }
+        ASSERT_TRUE(frames.isOccupied(frame)) << "frame " << frame;
+        EXPECT_EQ(it->second.size(), frames.mappingCount(frame)) << "frame " << frame;
+        sharedMappings += it->second.size() - 1;
+        bool ownerMaps = false;
+        for (size_t i = 0; i < it->second.size(); i++) {
+            EXPECT_EQ(it->second[0].second, it->second[i].second);
+            if (it->second[i].first == frames.ownerOf(frame)) ownerMaps = true;
+        }
+        EXPECT_TRUE(ownerMaps) << "frame " << frame;
+    }
+    EXPECT_EQ(sharedMappings, manager.getFramesSavedByCow());
+    EXPECT_EQ(mappings.size(), manager.getUsedFrames());
+    EXPECT_EQ(mappings.size(), frames.countOccupied());
+}
+
+/**
+ * Random accepts, forks, writes and removals; a write must leave the page
+ * private to the writer, and once every job is gone every frame must have
+ * been freed exactly once
+ */
+TEST(Fork, SharesMatchMappingsAndFramesFreeOnce) {
+    for (int mode = 0; mode < 3; mode++) {
+        SCOPED_TRACE(mode);
+        PagedMemoryManager manager(256, 512);
+        manager.seedRandom(mode);
+        if (mode == 1) manager.configurePageTable(3);
+        if (mode == 2) manager.configureTlb(16, 4, Tlb::POLICY_LRU);
+        
+        mt19937 random(mode);
+        vector<int> jobIds;
+        for (int step = 0; step < 5000; step++) {
+            int op = random() % 10;
+            if (op < 2 || jobIds.empty()) {
+                AcceptResult result = manager.acceptJob("job", 1 + random() % 4000);
+                if (result.success) jobIds.push_back(result.jobId);
+            } else if (op < 4) {
+                AcceptResult result = manager.forkJob(jobIds[random() % jobIds.size()]);
+                ASSERT_TRUE(result.success) << result.errorMessage();
+                jobIds.push_back(result.jobId);
+            } else if (op < 8) {
+                int jobId = jobIds[random() % jobIds.size()];
+                Address address = random() % manager.findJob(jobId)->size;
+                TranslationResult write = manager.resolveWrite(jobId, address);
+                if (write.success) {
+                    EXPECT_FALSE(manager.getFrameTable().isShared(write.frameNumber));
+                    EXPECT_EQ(jobId, manager.getFrameTable().ownerOf(write.frameNumber));
+                    TranslationResult read = manager.resolveAddress(jobId, address);
+                    ASSERT_TRUE(read.success);
+                    EXPECT_EQ(write.frameNumber, read.frameNumber);
+                } else {
+                    EXPECT_EQ(Status::OutOfFrames, write.status);
+                }
+            } else {
+                size_t victim = random() % jobIds.size();
+                EXPECT_TRUE(manager.removeJob(jobIds[victim]).success);
+                jobIds.erase(jobIds.begin() + victim);
+            }
+            if (step % 50 == 0) {
+                expectSharesMatchMappings(manager);
+                if (HasFatalFailure()) return;
+            }
+        }
+        EXPECT_GT(manager.getCowCopies(), 0u);
+        
+        while (!jobIds.empty()) {
+            EXPECT_TRUE(manager.removeJob(jobIds.back()).success);
+            jobIds.pop_back();
+            expectSharesMatchMappings(manager);
+        }
+        EXPECT_EQ(0u, manager.getUsedFrames());
+        EXPECT_EQ(0u, manager.getFramesSavedByCow());
+    }
+}
+
+/**
+ * A fork is instrumented like an accept, and once the pools are warm a
+ * fork/remove cycle takes all of its storage from them
+ */
+TEST(Fork, CountsAsAcceptAndReusesPooledStorage) {
+    for (int mode = 0; mode < 2; mode++) {
+        SCOPED_TRACE(mode);
+        PagedMemoryManager manager(256, 512);
+        if (mode == 1) manager.configurePageTable(3);
+        AcceptResult parent = manager.acceptJob("parent", 100 * 256);
+        ASSERT_TRUE(parent.success);
+        
+        for (int round = 0; round < 4; round++) manager.removeJob(manager.forkJob(parent.jobId).jobId);
+        uint64_t accepts = manager.getOperationStats().counters().accepts;
+        uint64_t before = allocations.load();
+        for (int round = 0; round < 100; round++) {
+            AcceptResult child = manager.forkJob(parent.jobId);
+            ASSERT_TRUE(child.success);
+            manager.removeJob(child.jobId);
+        }
+        EXPECT_EQ(0u, allocations.load() - before);
+        EXPECT_EQ(accepts + 100, manager.getOperationStats().counters().accepts);
+        EXPECT_EQ(Status::NoSuchJob, manager.forkJob(99).status);
+        EXPECT_EQ(1u, manager.getOperationStats().counters().acceptFailures);
+    }
+}
+
+/**
+ * Read a whole file into a string, empty if it cannot be read
+ */
+static string readFile(const string& path) {
+    ifstream in(path.c_str(), ios::binary);
+    ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+/**
+ * Fill a manager with accepts, forks, writes and removals under each
+ * configuration an image records, save it, load the image into a fresh
+ * manager and save that again: the two images must match byte for byte
+ * and both managers must translate every address alike
+ */
+TEST(StateImage, SaveLoadSaveRoundTrips) {
+    const string firstPath = testing::TempDir() + "memory_test_first.img";
+    const string secondPath = testing::TempDir() + "memory_test_second.img";
+    for (int mode = 0; mode < 5; mode++) {
+        SCOPED_TRACE(mode);
+        uint32_t pageSize = mode == 2 ? 64 : 256;
+        FrameId totalFrames = mode == 2 ? 1 << 16 : 2048;
+        bool demand = mode == 3;
+        bool forks = mode != 2 && !demand;
+        PagedMemoryManager original(pageSize, totalFrames);
+        original.seedRandom(mode);
+        if (mode == 1) original.configurePageTable(3);
+        if (mode == 2) original.configureHugePages(PagedMemoryManager::HUGE_PAGES_2M);
+        if (mode == 3) original.configureDemandPaging(PageReplacer::POLICY_CLOCK);
+        if (mode == 4) {
+            original.configureNuma(4);
+            original.setPlacement(PagedMemoryManager::PLACEMENT_NUMA_LOCAL);
+        }
+        
+        mt19937 random(mode);
+        vector<int> jobIds;
+        for (int step = 0; step < 3000; step++) {
+            int op = random() % 10;
+            if (op < 2 || jobIds.empty()) {
+                AcceptResult result = original.acceptJob(step % 3 ? "job" : "other", 1 + random() % (pageSize * 40));
+                if (result.success) jobIds.push_back(result.jobId);
+            } else if (op < 3 && forks) {
+                AcceptResult result = original.forkJob(jobIds[random() % jobIds.size()]);
+                if (result.success) jobIds.push_back(result.jobId);
+            } else if (op < 8) {
+                int jobId = jobIds[random() % jobIds.size()];
+                Address address = random() % original.findJob(jobId)->size;
+                if (op & 1) original.resolveWrite(jobId, address);
+                else original.resolveAddress(jobId, address);
+            } else {
+                size_t victim = random() % jobIds.size();
+                original.removeJob(jobIds[victim]);
+                jobIds.erase(jobIds.begin() + victim);
+            }
+        }
+        
+        string error;
+        ASSERT_TRUE(original.saveState(firstPath, error)) << error;
+        MemoryImage image;
+        ASSERT_TRUE(image.open(firstPath, error)) << error;
+        PagedMemoryManager loaded(pageSize, totalFrames);
+        ASSERT_TRUE(loaded.loadState(image, error)) << error;
+        ASSERT_TRUE(loaded.saveState(secondPath, error)) << error;
+        
+        string firstImage = readFile(firstPath);
+        ASSERT_FALSE(firstImage.empty());
+        EXPECT_TRUE(firstImage == readFile(secondPath)) << "images differ";
+        EXPECT_EQ(original.getJobCount(), loaded.getJobCount());
+        EXPECT_EQ(original.getUsedFrames(), loaded.getUsedFrames());
+        EXPECT_EQ(original.getFramesSavedByCow(), loaded.getFramesSavedByCow());
+        EXPECT_TRUE(residentPages(original) == residentPages(loaded));
+        if (!demand) {
+            for (size_t i = 0; i < jobIds.size(); i++) {
+                const Job* job = original.findJob(jobIds[i]);
+                for (Address address = 0; address < job->size; address += pageSize / 2 + 1) {
+                    TranslationResult expected = original.resolveAddress(jobIds[i], address);
+                    TranslationResult actual = loaded.resolveAddress(jobIds[i], address);
+                    ASSERT_TRUE(expected.success && actual.success);
+                    EXPECT_EQ(expected.physicalAddress, actual.physicalAddress);
+                }
+            }
+        }
+        
+        // An image only loads into an empty manager of the same geometry
+        EXPECT_FALSE(loaded.loadState(image, error));
+        PagedMemoryManager larger(pageSize, totalFrames + 1);
+        EXPECT_FALSE(larger.loadState(image, error));
+        
+        // A truncated image is rejected rather than loaded
+        ofstream(secondPath.c_str(), ios::binary) << firstImage.substr(0, firstImage.size() - 4);
+        MemoryImage truncated;
+        PagedMemoryManager empty(pageSize, totalFrames);
+        EXPECT_FALSE(truncated.open(secondPath, error) && empty.loadState(truncated, error));
+        EXPECT_EQ(0u, empty.getUsedFrames());
+    }
+    remove(firstPath.c_str());
+    remove(secondPath.c_str());
+}
+
+static const MemoryImageJob& imageJob(const string& image, size_t j) {
+    const MemoryImageHeader& header = *reinterpret_cast<const MemoryImageHeader*>(image.data());
+    return reinterpret_cast<const MemoryImageJob*>(&image[header.sections[IMAGE_JOBS].offset])[j];
+}
+
+/**
+ * Entry i of job j's arrays in an image's page lists section (page
+ * numbers, frame table, radix nodes and huge frames, back to back)
+ */
+static uint32_t imageListEntry(const string& image, size_t j, uint64_t i) {
+    const MemoryImageHeader& header = *reinterpret_cast<const MemoryImageHeader*>(image.data());
+    uint64_t at = header.sections[IMAGE_PAGE_LISTS].offset + (imageJob(image, j).listOffset + i) * sizeof(uint32_t);
+    uint32_t entry;
+    memcpy(&entry, &image[at], sizeof(entry));
+    return entry;
+}
+
+static void setImageListEntry(string& image, size_t j, uint64_t i, uint32_t entry) {
+    const MemoryImageHeader& header = *reinterpret_cast<const MemoryImageHeader*>(image.data());
+    uint64_t at = header.sections[IMAGE_PAGE_LISTS].offset + (imageJob(image, j).listOffset + i) * sizeof(uint32_t);
+    memcpy(&image[at], &entry, sizeof(entry));
+}
+
+/**
+ * Corrupted images are rejected and leave the manager exactly as it was,
+ * its own settings included: a frame table entry flipped to another
+ * job's frame, to a free frame or past memory, and a radix child index
+ * past the job's nodes. The intact image then loads into the same manager.
+ */
+TEST(StateImage, RejectsCorruptedImagesAndLeavesManagerUnchanged) {
+    const string path = testing::TempDir() + "memory_test_corrupt.img";
+    const uint32_t pageSize = 256;
+    const FrameId totalFrames = 1024;
+    for (int mode = 0; mode < 2; mode++) {
+        SCOPED_TRACE(mode);
+        PagedMemoryManager original(pageSize, totalFrames);
+        original.seedRandom(mode);
+        if (mode == 1) original.configurePageTable(3);
+        for (int j = 0; j < 6; j++) original.acceptJob("job", (20 + 7 * j) * pageSize);
+        original.removeJob(2);
+        string error;
+        ASSERT_TRUE(original.saveState(path, error)) << error;
+        const string intact = readFile(path);
+        
+        vector<string> corrupted;
+        if (mode == 0) {
+            uint64_t firstTable = imageJob(intact, 0).pageListLength;
+            FrameId otherJobsFrame = imageListEntry(intact, 1, imageJob(intact, 1).pageListLength + 3);
+            FrameId freeFrame = 0;
+            while (original.getFrameTable().isOccupied(freeFrame)) freeFrame++;
+            FrameId flipped[] = {otherJobsFrame, freeFrame, totalFrames + 3};
+            for (size_t f = 0; f < 3; f++) {
+                corrupted.push_back(intact);
+                setImageListEntry(corrupted.back(), 0, firstTable + 5, flipped[f]);
+            }
+        } else {
+            const MemoryImageJob& first = imageJob(intact, 0);
+            uint64_t root = 0;
+            while (imageListEntry(intact, 0, root) == 0) root++;
+            ASSERT_LT(root, first.radixRootEntries);
+            uint32_t pastLastNode = static_cast<uint32_t>(first.radixEntries / RadixPageTable::NODE_ENTRIES);
+            uint32_t children[] = {pastLastNode, pastLastNode + 1000, ~uint32_t(0)};
+            for (size_t c = 0; c < 3; c++) {
+                corrupted.push_back(intact);
+                setImageListEntry(corrupted.back(), 0, root, children[c]);
+            }
+        }
+        
+        PagedMemoryManager target(pageSize, totalFrames);
+        target.configureNuma(2);
+        target.setPlacement(PagedMemoryManager::PLACEMENT_BUDDY);
+        target.configureDemandPaging(PageReplacer::POLICY_ARC);
+        for (size_t c = 0; c < corrupted.size(); c++) {
+            SCOPED_TRACE(c);
+            ofstream(path.c_str(), ios::binary) << corrupted[c];
+            MemoryImage image;
+            ASSERT_TRUE(image.open(path, error)) << error;
+            EXPECT_FALSE(target.loadState(image, error));
+            EXPECT_FALSE(error.empty());
+            EXPECT_EQ(0u, target.getJobCount());
+            EXPECT_EQ(0u, target.getUsedFrames());
+            EXPECT_EQ(2, target.getNumaNodes());
+            EXPECT_EQ(PagedMemoryManager::PLACEMENT_BUDDY, target.getPlacement());
+            EXPECT_EQ(1, target.getPageTableLevels());
+            EXPECT_TRUE(target.demandPagingEnabled());
+            EXPECT_EQ(PageReplacer::POLICY_ARC, target.getReplacementPolicy());
+        }
+        
+        ofstream(path.c_str(), ios::binary) << intact;
+        MemoryImage image;
+        ASSERT_TRUE(image.open(path, error)) << error;
+        ASSERT_TRUE(target.loadState(image, error)) << error;
+        EXPECT_EQ(original.getUsedFrames(), target.getUsedFrames());
+        EXPECT_EQ(mode == 1 ? 3 : 1, target.getPageTableLevels());
+        EXPECT_TRUE(target.demandPagingEnabled());
+        EXPECT_TRUE(residentPages(original) == residentPages(target));
+    }
+    remove(path.c_str());
+}
+
+/**
+ * Writers accept jobs, claim every frame their translations land on and
+ * release the claims before removing the job, while readers translate
+ * against whichever jobs happen to be live. A failed claim means a frame
+ * was handed to two live jobs at once.
+ */
+TEST(ConcurrentManager, ChurnNeverSharesAFrame) {
+    const FrameId totalFrames = 4096;
+    const int writerCount = 4;
+    const int readerCount = 2;
+    const int roundsPerWriter = 2000;
+    ConcurrentPagedMemoryManager manager(PAGE_SIZE, totalFrames, writerCount);
+    manager.seedRandom(7);
+    
+    vector<atomic<int> > claims(totalFrames);
+    for (FrameId f = 0; f < totalFrames; f++) claims[f].store(0);
+    atomic<int> doubleClaims(0);
+    atomic<int> badTranslations(0);
+    atomic<int> writersDone(0);
+    
+    vector<thread> threads;
+    for (int w = 0; w < writerCount; w++) {
+        threads.push_back(thread([&, w]() {
+            Xoshiro256 random(100 + w);
+            int reader = manager.registerReader();
+            vector<pair<int, PageId> > live;
+            for (int round = 0; round < roundsPerWriter; round++) {
+                if (live.size() < 8 && (live.empty() || (random() % 3) != 0)) {
+                    PageId pages = 1 + random() % 32;
+                    AcceptResult result = manager.acceptJob("job", pages * PAGE_SIZE);
+                    if (!result.success) continue;
+                    for (PageId p = 0; p < pages; p++) {
+                        Address physical = manager.translate(reader, result.jobId, p * PAGE_SIZE);
+                        FrameId frame = physical / PAGE_SIZE;
+                        int expected = 0;
+                        if (frame >= totalFrames || !claims[frame].compare_exchange_strong(expected, result.jobId)) {
+                            doubleClaims++;
+                        }
+                    }
+                    live.push_back(make_pair(result.jobId, pages));
+                } else {
+                    size_t victim = random() % live.size();
+                    int jobId = live[victim].first;
+                    for (PageId p = 0; p < live[victim].second; p++) {
+                        FrameId frame = manager.translate(reader, jobId, p * PAGE_SIZE) / PAGE_SIZE;
+                        int expected = jobId;
+                        if (frame >= totalFrames || !claims[frame].compare_exchange_strong(expected, 0)) {
+                            doubleClaims++;
+                        }
+                    }
+                    EXPECT_EQ(Status::Ok, manager.removeJob(jobId).status);
+                    live[victim] = live.back();
+                    live.pop_back();
+                }
+            }
+            for (size_t i = 0; i < live.size(); i++) {
+                for (PageId p = 0; p < live[i].second; p++) {
+                    claims[manager.translate(reader, live[i].first, p * PAGE_SIZE) / PAGE_SIZE].store(0);
+                }
+                manager.removeJob(live[i].first);
+            }
+            manager.unregisterReader(reader);
+            writersDone++;
+        }));
+    }
+    for (int r = 0; r < readerCount; r++) {
+        threads.push_back(thread([&, r]() {
+            Xoshiro256 random(200 + r);
+            int reader = manager.registerReader();
+            while (writersDone.load() < writerCount) {
+                int jobId = 1 + (random() % (writerCount * roundsPerWriter));
+                Address physical = manager.translate(reader, jobId, (random() % 32) * PAGE_SIZE);
+                if (physical != TRANSLATION_NO_SUCH_JOB && physical != TRANSLATION_OUT_OF_BOUNDS &&
+                    physical / PAGE_SIZE >= totalFrames) {
+                    badTranslations++;
+                }
+            }
+            manager.unregisterReader(reader);
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+    
+    EXPECT_EQ(0, doubleClaims.load());
+    EXPECT_EQ(0, badTranslations.load());
+    EXPECT_EQ(0u, manager.getUsedFrames());
+    for (FrameId f = 0; f < totalFrames; f++) EXPECT_EQ(0, claims[f].load());
+}
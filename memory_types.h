@@ -0,0 +1,27 @@
+/**
+ * Memory Model Types
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef MEMORY_TYPES_H
+#define MEMORY_TYPES_H
+
+#include <cstdint>
+
+// Byte addresses and sizes are 64-bit so hosts well beyond 4GB can be modelled
+typedef uint64_t Address;
+
+// Frame and page identifiers are 32-bit to keep per-frame/per-page arrays compact
+typedef uint32_t FrameId;
+typedef uint32_t PageId;
+
+const FrameId INVALID_FRAME = 0xFFFFFFFFu;  // Sentinel: no frame
+const FrameId MAX_FRAMES = 0xFFFFFFFEu;     // Largest frame count (INVALID_FRAME stays reserved)
+
+// Huge page size classes, largest first: a class-c huge page spans
+// 2^HUGE_PAGE_SHIFTS[c] base pages (1GB and 2MB with 4KB pages, as on x86-64)
+const int HUGE_PAGE_CLASSES = 2;
+const int HUGE_PAGE_SHIFTS[HUGE_PAGE_CLASSES] = {18, 9};
+
+#endif // MEMORY_TYPES_H
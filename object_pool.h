@@ -0,0 +1,276 @@
+/**
+ * Object Pools
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Fixed-size blocks carved from large chunks and recycled through a free
+ * list
+ * 
+ * The block size is taken from the first single-object allocation, which
+ * for a node-based container is its node. Freed blocks are reused before a
+ * new chunk is carved, so a container whose size stays bounded stops
+ * calling the allocator once it has reached its peak. Chunks are returned
+ * only when the pool is destroyed.
+ */
+class BlockPool {
+private:
+    static const size_t BLOCKS_PER_CHUNK = 256;
+    
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    
+    std::vector<std::unique_ptr<unsigned char[]>> chunks;
+    FreeBlock* freeList;
+    size_t objectBytes;   // Size served; 0 until the first allocation fixes it
+    size_t blockBytes;    // objectBytes rounded up for alignment and the free-list link
+    size_t carved;        // Blocks handed out from the newest chunk
+    
+    BlockPool(const BlockPool&);
+    BlockPool& operator=(const BlockPool&);
+
+public:
+    BlockPool() : freeList(nullptr), objectBytes(0), blockBytes(0), carved(BLOCKS_PER_CHUNK) {}
+    
+    /**
+     * @return Whether blocks of the given size come from this pool
+     */
+    bool serves(size_t bytes) const { return objectBytes == 0 || bytes == objectBytes; }
+    
+    void* allocate(size_t bytes) {
+        if (objectBytes == 0) {
+            // Round up so every block can hold a free-list link, suitably aligned
+            size_t align = alignof(std::max_align_t);
+            objectBytes = bytes;
+            blockBytes = bytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : bytes;
+            blockBytes = (blockBytes + align - 1) / align * align;
+        }
+        if (freeList) {
+            FreeBlock* block = freeList;
+            freeList = block->next;
+            return block;
+        }
+        if (carved == BLOCKS_PER_CHUNK) {
+            chunks.emplace_back(new unsigned char[blockBytes * BLOCKS_PER_CHUNK]);
+            carved = 0;
+        }
+        return chunks.back().get() + blockBytes * carved++;
+    }
+    
+    void deallocate(void* pointer) {
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = freeList;
+        freeList = block;
+    }
+};
+
+/**
+ * Standard allocator that takes single objects from a BlockPool (and
+ * anything else, such as hash bucket arrays, from operator new)
+ * 
+ * Copies and rebinds share the pool, which must outlive every container
+ * using it.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+    
+    BlockPool* pool;
+    
+    explicit PoolAllocator(BlockPool* blockPool) : pool(blockPool) {}
+    
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool(other.pool) {}
+    
+    T* allocate(size_t n) {
+        if (n == 1 && pool->serves(sizeof(T))) return static_cast<T*>(pool->allocate(sizeof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    
+    void deallocate(T* pointer, size_t n) {
+        if (n == 1 && pool->serves(sizeof(T))) pool->deallocate(pointer);
+        else ::operator delete(pointer);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) { return a.pool == b.pool; }
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) { return a.pool != b.pool; }
+
+/**
+ * Recycled storage for 32-bit page lists (page numbers, frame tables and
+ * radix node pools are all uint32_t arrays)
+ * 
+ * Spare arrays are binned by capacity in powers of two and new arrays are
+ * reserved at a power of two, so a job of n pages reuses any spare array
+ * freed by a job of similar size. Reserved but unused capacity is never
+ * written, so it costs address space rather than resident memory. Spare
+ * arrays are kept for the pool's lifetime, bounded by the peak page lists
+ * live at once.
+ */
+class PageListPool {
+private:
+    static const int CLASSES = 33;  // Capacities 2^0 ... 2^32
+    
+    std::vector<std::vector<uint32_t>> spares[CLASSES];
+    
+    // Smallest class whose arrays all hold at least count entries
+    static int classFor(size_t count) {
+        int sizeClass = 0;
+        while (sizeClass < CLASSES - 1 && (size_t(1) << sizeClass) < count) sizeClass++;
+        return sizeClass;
+    }
+    
+    // Class an array of this capacity is filed under
+    static int classOf(size_t capacity) {
+        int sizeClass = 0;
+        while (sizeClass < CLASSES - 1 && (size_t(2) << sizeClass) <= capacity) sizeClass++;
+        return sizeClass;
+    }
+
+public:
+    /**
+     * Replace list with empty storage for at least count entries, taken from
+     * the spares when one is large enough (list's own storage is recycled)
+     */
+    void acquire(std::vector<uint32_t>& list, size_t count) {
+        release(list);
+        if (count == 0) return;
+        for (int c = classFor(count); c < CLASSES; c++) {
+            if (!spares[c].empty()) {
+                list.swap(spares[c].back());
+                spares[c].pop_back();
+                return;
+            }
+        }
+        list.reserve(size_t(1) << classFor(count));
+    }
+    
+    /**
+     * Keep a list's storage for reuse, leaving the list empty; never throws
+     * (if the spare list cannot grow, the storage is freed instead)
+     */
+    void release(std::vector<uint32_t>& list) noexcept {
+        if (list.capacity() == 0) return;
+        list.clear();
+        std::vector<std::vector<uint32_t>>& bin = spares[classOf(list.capacity())];
+        try {
+            bin.emplace_back();
+        } catch (const std::bad_alloc&) {
+            std::vector<uint32_t>().swap(list);
+            return;
+        }
+        bin.back().swap(list);
+    }
+};
+
+/**
+ * Reference-counted interned strings: each distinct string is stored once
+ * and handed out as a stable pointer
+ * 
+ * Looking up a string already in the table does not allocate. Every
+ * intern() or retain() is balanced by a release(); a string leaves the
+ * table (and its pointer dangles) when its last reference is released, so
+ * the table holds only the strings in use. Released entries are recycled,
+ * string storage included, and the index's nodes come from a BlockPool,
+ * so interning a new string while the table stays within its peak size
+ * does not allocate either (unless the string outgrows every spare one).
+ */
+class StringTable {
+private:
+    struct Entry {
+        std::string text;
+        size_t references;
+        Entry* nextFree;      // Next recycled entry (free entries only)
+    };
+    
+    // The index is keyed by pointers to the entries' strings, hashed and
+    // compared by content, so a lookup needs no copy of the text
+    struct TextHash {
+        size_t operator()(const std::string* text) const { return std::hash<std::string>()(*text); }
+    };
+    struct TextEqual {
+        bool operator()(const std::string* a, const std::string* b) const { return *a == *b; }
+    };
+    typedef std::unordered_map<const std::string*, Entry*, TextHash, TextEqual,
+                               PoolAllocator<std::pair<const std::string* const, Entry*>>> Index;
+    
+    std::deque<Entry> entries;   // Grows at the end only, so entries never move
+    Entry* freeEntries;
+    BlockPool indexNodes;        // Declared before the index, which uses it
+    Index index;
+    
+    StringTable(const StringTable&);
+    StringTable& operator=(const StringTable&);
+
+public:
+    StringTable() : freeEntries(nullptr), index(0, TextHash(), TextEqual(), Index::allocator_type(&indexNodes)) {}
+    
+    const std::string* intern(const std::string& text) {
+        Index::iterator it = index.find(&text);
+        if (it == index.end()) {
+            Entry* entry = freeEntries;
+            if (entry) {
+                entry->text.assign(text);
+                freeEntries = entry->nextFree;
+            } else {
+                entries.push_back(Entry());
+                entry = &entries.back();
+                entry->text.assign(text);
+            }
+            entry->references = 0;
+            try {
+                it = index.emplace(&entry->text, entry).first;
+            } catch (...) {
+                entry->nextFree = freeEntries;
+                freeEntries = entry;
+                throw;
+            }
+        }
+        it->second->references++;
+        return it->first;
+    }
+    
+    /**
+     * Add a reference to a string already interned here
+     */
+    void retain(const std::string* text) noexcept {
+        index.find(text)->second->references++;
+    }
+    
+    /**
+     * Drop a reference (a no-op for null), recycling the string after the last
+     */
+    void release(const std::string* text) noexcept {
+        if (!text) return;
+        Index::iterator it = index.find(text);
+        Entry* entry = it->second;
+        if (--entry->references > 0) return;
+        index.erase(it);
+        entry->text.clear();
+        entry->nextFree = freeEntries;
+        freeEntries = entry;
+    }
+    
+    size_t size() const { return index.size(); }
+};
+
+#endif // OBJECT_POOL_H
@@ -0,0 +1,357 @@
+/**
+ * Occupancy Bitmap Kernels
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ * 
+ * Word-parallel scans over a frame occupancy bitmap (bit set = frame in
+ * use) used for monitoring statistics on large configurations:
+ * - counting occupied frames
+ * - finding the first N free frames
+ * - building a histogram of free-run lengths (external fragmentation)
+ * 
+ * Each kernel has a portable scalar implementation. On x86-64 an AVX2
+ * version is selected at runtime when the CPU supports it (the rest of the
+ * program does not need to be built with -mavx2); on AArch64 a NEON
+ * version is always used.
+ */
+
+#ifndef OCCUPANCY_KERNELS_H
+#define OCCUPANCY_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "memory_types.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define OCCUPANCY_HAVE_AVX2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define OCCUPANCY_HAVE_NEON 1
+#endif
+
+/**
+ * Histogram of maximal runs of consecutive free frames
+ * 
+ * Bucket b counts runs whose length lies in [2^b, 2^(b+1)).
+ */
+struct FreeRunHistogram {
+    static const int BUCKETS = 33;
+    
+    uint64_t buckets[BUCKETS];
+    uint64_t runCount;      // Number of free runs
+    uint64_t largestRun;    // Length of the longest free run in frames
+    uint64_t freeFrames;    // Total free frames across all runs
+};
+
+/**
+ * Streaming accumulator of free runs, fed one word class at a time
+ */
+class FreeRunAccumulator {
+private:
+    FreeRunHistogram histogram;
+    uint64_t currentRun;    // Length of the run in progress (0 = none)
+    
+    void closeRun() {
+        if (currentRun == 0) return;
+        histogram.buckets[63 - __builtin_clzll(currentRun)]++;
+        histogram.runCount++;
+        histogram.freeFrames += currentRun;
+        if (currentRun > histogram.largestRun) histogram.largestRun = currentRun;
+        currentRun = 0;
+    }
+
+public:
+    FreeRunAccumulator() : currentRun(0) {
+        std::memset(&histogram, 0, sizeof(histogram));
+    }
+    
+    // A span of frames that are all free
+    void addFree(uint64_t frames) { currentRun += frames; }
+    
+    // A span of frames that are all occupied
+    void addOccupied() { closeRun(); }
+    
+    /**
+     * Feed one 64-frame occupancy word, splitting it into runs bit by bit
+     */
+    void addWord(uint64_t occupied) {
+        if (occupied == 0) {
+            addFree(64);
+            return;
+        }
+        if (occupied == ~uint64_t(0)) {
+            closeRun();
+            return;
+        }
+        
+        uint64_t freeBits = ~occupied;
+        int position = 0;
+        while (position < 64) {
+            uint64_t rest = freeBits >> position;
+            if (rest & 1) {
+                // Extend the current run by the block of free bits at position
+                uint64_t inverted = ~rest;
+                int length = inverted ? __builtin_ctzll(inverted) : 64 - position;
+                if (length > 64 - position) length = 64 - position;
+                currentRun += static_cast<uint64_t>(length);
+                position += length;
+            } else {
+                closeRun();
+                if (rest == 0) break;
+                position += __builtin_ctzll(rest);
+            }
+        }
+    }
+    
+    FreeRunHistogram finish() {
+        closeRun();
+        return histogram;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Scalar implementations
+// ---------------------------------------------------------------------------
+
+inline uint64_t scalarCountOccupied(const uint64_t* words, size_t wordCount) {
+    uint64_t used = 0;
+    for (size_t i = 0; i < wordCount; i++) {
+        used += static_cast<uint64_t>(__builtin_popcountll(words[i]));
+    }
+    return used;
+}
+
+/**
+ * Append the free frames of one word to out (at most count in total)
+ */
+inline size_t collectFreeBits(uint64_t occupied, uint64_t baseFrame, FrameId frameCount,
+                              size_t found, size_t count, FrameId* out) {
+    uint64_t freeBits = ~occupied;
+    while (freeBits && found < count) {
+        uint64_t frame = baseFrame + static_cast<uint64_t>(__builtin_ctzll(freeBits));
+        if (frame >= frameCount) break;
+        out[found++] = static_cast<FrameId>(frame);
+        freeBits &= freeBits - 1;  // Clear lowest set bit
+    }
+    return found;
+}
+
+inline size_t scalarFindFreeFrames(const uint64_t* words, FrameId frameCount, size_t count, FrameId* out) {
+    size_t wordCount = (static_cast<size_t>(frameCount) + 63) / 64;
+    size_t found = 0;
+    for (size_t i = 0; i < wordCount && found < count; i++) {
+        if (words[i] != ~uint64_t(0)) {
+            found = collectFreeBits(words[i], i * 64, frameCount, found, count, out);
+        }
+    }
+    return found;
+}
+
+/**
+ * Occupancy word at index i with bits past the last frame forced to occupied
+ */
+inline uint64_t maskedTailWord(const uint64_t* words, size_t i, FrameId frameCount) {
+    uint64_t word = words[i];
+    uint64_t validBits = static_cast<uint64_t>(frameCount) - i * 64;
+    if (validBits < 64) word |= ~uint64_t(0) << validBits;
+    return word;
+}
+
+inline FreeRunHistogram scalarFreeRunHistogram(const uint64_t* words, FrameId frameCount) {
+    FreeRunAccumulator runs;
+    size_t fullWords = frameCount / 64;
+    for (size_t i = 0; i < fullWords; i++) runs.addWord(words[i]);
+    if (frameCount % 64) runs.addWord(maskedTailWord(words, fullWords, frameCount));
+    return runs.finish();
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 implementations (x86-64, selected at runtime)
+// ---------------------------------------------------------------------------
+
+#ifdef OCCUPANCY_HAVE_AVX2
+
+/**
+ * Popcount four words at a time with the nibble-lookup (vpshufb) method
+ */
+__attribute__((target("avx2")))
+inline uint64_t avx2CountOccupied(const uint64_t* words, size_t wordCount) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+    __m256i total = _mm256_setzero_si256();
+    
+    size_t i = 0;
+    for (; i + 4 <= wordCount; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        __m256i lo = _mm256_and_si256(v, lowNibble);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble);
+        __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalarCountOccupied(words + i, wordCount - i);
+}
+
+/**
+ * Skip blocks of four fully occupied words with one test per block
+ */
+__attribute__((target("avx2")))
+inline size_t avx2FindFreeFrames(const uint64_t* words, FrameId frameCount, size_t count, FrameId* out) {
+    const __m256i allOnes = _mm256_set1_epi64x(-1);
+    size_t wordCount = (static_cast<size_t>(frameCount) + 63) / 64;
+    size_t found = 0;
+    
+    size_t i = 0;
+    while (i + 4 <= wordCount && found < count) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        if (!_mm256_testc_si256(v, allOnes)) {
+            for (size_t w = i; w < i + 4 && found < count; w++) {
+                found = collectFreeBits(words[w], w * 64, frameCount, found, count, out);
+            }
+        }
+        i += 4;
+    }
+    for (; i < wordCount && found < count; i++) {
+        found = collectFreeBits(words[i], i * 64, frameCount, found, count, out);
+    }
+    return found;
+}
+
+/**
+ * Classify four words at a time; only mixed blocks are split bit by bit
+ */
+__attribute__((target("avx2")))
+inline FreeRunHistogram avx2FreeRunHistogram(const uint64_t* words, FrameId frameCount) {
+    const __m256i allOnes = _mm256_set1_epi64x(-1);
+    FreeRunAccumulator runs;
+    size_t fullWords = frameCount / 64;
+    
+    size_t i = 0;
+    for (; i + 4 <= fullWords; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        if (_mm256_testz_si256(v, v)) {
+            runs.addFree(256);
+        } else if (_mm256_testc_si256(v, allOnes)) {
+            runs.addOccupied();
+        } else {
+            for (size_t w = i; w < i + 4; w++) runs.addWord(words[w]);
+        }
+    }
+    for (; i < fullWords; i++) runs.addWord(words[i]);
+    if (frameCount % 64) runs.addWord(maskedTailWord(words, fullWords, frameCount));
+    return runs.finish();
+}
+
+inline bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#endif // OCCUPANCY_HAVE_AVX2
+
+// ---------------------------------------------------------------------------
+// NEON implementations (AArch64)
+// ---------------------------------------------------------------------------
+
+#ifdef OCCUPANCY_HAVE_NEON
+
+inline uint64_t neonCountOccupied(const uint64_t* words, size_t wordCount) {
+    uint64x2_t total = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 2 <= wordCount; i += 2) {
+        uint8x16_t bytes = vcntq_u8(vreinterpretq_u8_u64(vld1q_u64(words + i)));
+        total = vaddq_u64(total, vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(bytes))));
+    }
+    return vaddvq_u64(total) + scalarCountOccupied(words + i, wordCount - i);
+}
+
+inline size_t neonFindFreeFrames(const uint64_t* words, FrameId frameCount, size_t count, FrameId* out) {
+    size_t wordCount = (static_cast<size_t>(frameCount) + 63) / 64;
+    size_t found = 0;
+    
+    size_t i = 0;
+    while (i + 2 <= wordCount && found < count) {
+        uint32x4_t v = vreinterpretq_u32_u64(vld1q_u64(words + i));
+        if (vminvq_u32(v) != 0xFFFFFFFFu) {
+            found = collectFreeBits(words[i], i * 64, frameCount, found, count, out);
+            found = collectFreeBits(words[i + 1], (i + 1) * 64, frameCount, found, count, out);
+        }
+        i += 2;
+    }
+    for (; i < wordCount && found < count; i++) {
+        found = collectFreeBits(words[i], i * 64, frameCount, found, count, out);
+    }
+    return found;
+}
+
+inline FreeRunHistogram neonFreeRunHistogram(const uint64_t* words, FrameId frameCount) {
+    FreeRunAccumulator runs;
+    size_t fullWords = frameCount / 64;
+    
+    size_t i = 0;
+    for (; i + 2 <= fullWords; i += 2) {
+        uint32x4_t v = vreinterpretq_u32_u64(vld1q_u64(words + i));
+        if (vmaxvq_u32(v) == 0) {
+            runs.addFree(128);
+        } else if (vminvq_u32(v) == 0xFFFFFFFFu) {
+            runs.addOccupied();
+        } else {
+            runs.addWord(words[i]);
+            runs.addWord(words[i + 1]);
+        }
+    }
+    for (; i < fullWords; i++) runs.addWord(words[i]);
+    if (frameCount % 64) runs.addWord(maskedTailWord(words, fullWords, frameCount));
+    return runs.finish();
+}
+
+#endif // OCCUPANCY_HAVE_NEON
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+/**
+ * Number of set bits (occupied frames) in the bitmap
+ */
+inline uint64_t occupancyCountOccupied(const uint64_t* words, size_t wordCount) {
+#if defined(OCCUPANCY_HAVE_AVX2)
+    if (cpuHasAvx2()) return avx2CountOccupied(words, wordCount);
+#elif defined(OCCUPANCY_HAVE_NEON)
+    return neonCountOccupied(words, wordCount);
+#endif
+    return scalarCountOccupied(words, wordCount);
+}
+
+/**
+ * Lowest-numbered free frames, in ascending order
+ * @return Number of frames written to out (at most count)
+ */
+inline size_t occupancyFindFreeFrames(const uint64_t* words, FrameId frameCount, size_t count, FrameId* out) {
+#if defined(OCCUPANCY_HAVE_AVX2)
+    if (cpuHasAvx2()) return avx2FindFreeFrames(words, frameCount, count, out);
+#elif defined(OCCUPANCY_HAVE_NEON)
+    return neonFindFreeFrames(words, frameCount, count, out);
+#endif
+    return scalarFindFreeFrames(words, frameCount, count, out);
+}
+
+/**
+ * Histogram of free-run lengths over the first frameCount frames
+ */
+inline FreeRunHistogram occupancyFreeRunHistogram(const uint64_t* words, FrameId frameCount) {
+#if defined(OCCUPANCY_HAVE_AVX2)
+    if (cpuHasAvx2()) return avx2FreeRunHistogram(words, frameCount);
+#elif defined(OCCUPANCY_HAVE_NEON)
+    return neonFreeRunHistogram(words, frameCount);
+#endif
+    return scalarFreeRunHistogram(words, frameCount);
+}
+
+#endif // OCCUPANCY_KERNELS_H
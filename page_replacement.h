@@ -0,0 +1,495 @@
+/**
+ * Page Replacement Engines
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef PAGE_REPLACEMENT_H
+#define PAGE_REPLACEMENT_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "memory_types.h"
+
+/**
+ * Doubly linked lists threaded through a shared array of slot links
+ * 
+ * Each slot is on at most one list at a time, so several lists (for example
+ * ARC's T1 and T2 over the same frames) can share one pair of link arrays.
+ * Every operation is O(1) and nothing allocates after construction.
+ */
+class SlotLists {
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+    
+    struct List {
+        uint32_t head;   // Oldest slot
+        uint32_t tail;   // Newest slot
+        size_t size;
+    };
+
+private:
+    std::vector<uint32_t> prev;
+    std::vector<uint32_t> next;
+
+public:
+    explicit SlotLists(size_t slots = 0) : prev(slots, uint32_t(NONE)), next(slots, uint32_t(NONE)) {}
+    
+    static List empty() {
+        List list = {NONE, NONE, 0};
+        return list;
+    }
+    
+    void pushBack(List& list, uint32_t slot) {
+        prev[slot] = list.tail;
+        next[slot] = NONE;
+        if (list.tail != NONE) next[list.tail] = slot;
+        else list.head = slot;
+        list.tail = slot;
+        list.size++;
+    }
+    
+    void remove(List& list, uint32_t slot) {
+        if (prev[slot] != NONE) next[prev[slot]] = next[slot];
+        else list.head = next[slot];
+        if (next[slot] != NONE) prev[next[slot]] = prev[slot];
+        else list.tail = prev[slot];
+        prev[slot] = NONE;
+        next[slot] = NONE;
+        list.size--;
+    }
+    
+    uint32_t popFront(List& list) {
+        uint32_t slot = list.head;
+        remove(list, slot);
+        return slot;
+    }
+    
+    /**
+     * Put slot `to` (on no list) in place of slot `from`, keeping its position
+     */
+    void replace(List& list, uint32_t from, uint32_t to) {
+        prev[to] = prev[from];
+        next[to] = next[from];
+        if (prev[to] != NONE) next[prev[to]] = to;
+        else list.head = to;
+        if (next[to] != NONE) prev[next[to]] = to;
+        else list.tail = to;
+        prev[from] = NONE;
+        next[from] = NONE;
+    }
+    
+    void moveToBack(List& list, uint32_t slot) {
+        remove(list, slot);
+        pushBack(list, slot);
+    }
+};
+
+/**
+ * Fixed-capacity hash map from page key to ARC ghost node
+ * 
+ * Open addressing with linear probing and backward-shift deletion, sized
+ * at configuration to at least twice the entries it can hold, so lookups,
+ * inserts and erases never allocate and probe chains stay short.
+ */
+class GhostIndex {
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+private:
+    static const uint64_t EMPTY = ~uint64_t(0);  // Never a page key (job IDs are positive)
+    
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> nodes;
+    size_t mask;
+    
+    size_t home(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    }
+    
+    size_t slotOf(uint64_t key) const {
+        size_t slot = home(key);
+        while (keys[slot] != key && keys[slot] != EMPTY) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+public:
+    GhostIndex() : mask(0) {}
+    
+    /**
+     * Empty the map and size it for up to entries keys
+     */
+    void reset(size_t entries) {
+        size_t capacity = 2;
+        while (capacity < 2 * entries) capacity *= 2;
+        keys.assign(capacity, uint64_t(EMPTY));
+        nodes.assign(capacity, uint32_t(NONE));
+        mask = capacity - 1;
+    }
+    
+    /**
+     * @return Node stored for key, or NONE
+     */
+    uint32_t find(uint64_t key) const {
+        size_t slot = slotOf(key);
+        return keys[slot] == key ? nodes[slot] : uint32_t(NONE);
+    }
+    
+    void insert(uint64_t key, uint32_t node) {
+        size_t slot = slotOf(key);
+        keys[slot] = key;
+        nodes[slot] = node;
+    }
+    
+    void erase(uint64_t key) {
+        size_t hole = slotOf(key);
+        if (keys[hole] != key) return;
+        
+        // Pull later entries of the probe chain back over the hole unless
+        // that would move them before their home slot
+        size_t next = hole;
+        while (true) {
+            next = (next + 1) & mask;
+            if (keys[next] == EMPTY) break;
+            size_t wanted = home(keys[next]);
+            bool stays = hole <= next ? (hole < wanted && wanted <= next) : (hole < wanted || wanted <= next);
+            if (stays) continue;
+            keys[hole] = keys[next];
+            nodes[hole] = nodes[next];
+            hole = next;
+        }
+        keys[hole] = EMPTY;
+        nodes[hole] = NONE;
+    }
+};
+
+/**
+ * Victim selection for demand paging
+ * 
+ * Tracks resident pages by the frame holding them. The manager drives it
+ * with a fixed protocol:
+ *   onAccess(frame)       every translation of a resident page
+ *   onFault(key)          a page fault for the page identified by key, or
+ *   onPrefetch(key)       a speculative load of that page, not a fault
+ *   evict()               only when no frame is free: pick and detach a victim
+ *   onLoad(frame, key)    the faulting or prefetched page now occupies frame
+ *   onFree(frame)         a resident page went away without eviction
+ * Keys identify pages across evictions (ARC remembers recently evicted
+ * keys). All operations are O(1); Clock's hand sweep is amortized O(1).
+ * Nothing allocates after configure.
+ */
+class PageReplacer {
+public:
+    enum Policy {
+        POLICY_FIFO,   // Evict the page resident the longest
+        POLICY_LRU,    // Evict the least recently used page
+        POLICY_CLOCK,  // Second chance: skip pages referenced since the last sweep
+        POLICY_ARC     // Adaptive Replacement Cache (recency/frequency balance)
+    };
+
+private:
+    // ARC list membership of a resident frame
+    enum ArcList { ARC_NONE, ARC_T1, ARC_T2 };
+    
+    // ARC ghost list membership of an evicted page
+    enum GhostList { GHOST_B1, GHOST_B2 };
+    
+    Policy policy;
+    FrameId capacity;
+    
+    // FIFO/LRU queue and ARC T1/T2, threaded through frames
+    SlotLists frameLinks;
+    SlotLists::List queue;
+    SlotLists::List t1;
+    SlotLists::List t2;
+    std::vector<uint8_t> arcList;        // Frame -> ArcList
+    std::vector<uint64_t> frameKey;      // Frame -> key of the resident page (ARC)
+    std::vector<uint8_t> prefetched;     // Frame -> prefetched and not yet accessed (ARC)
+    
+    // Clock
+    std::vector<uint8_t> referenced;
+    std::vector<uint8_t> resident;
+    FrameId hand;
+    
+    // ARC ghosts: a fixed pool of nodes threaded into B1 and B2
+    SlotLists ghostLinks;
+    SlotLists::List b1;
+    SlotLists::List b2;
+    std::vector<uint64_t> ghostKey;      // Node -> page key
+    std::vector<uint8_t> ghostList;      // Node -> GhostList
+    std::vector<uint32_t> freeGhosts;    // Unused nodes
+    GhostIndex ghostIndex;               // Key -> node
+    FrameId target;                      // ARC's adaptive target size for T1
+    bool faultFromB2;                    // Faulting key was a B2 ghost (REPLACE tie-break)
+    bool faultGhostHit;                  // Faulting key was found in B1 or B2
+    bool loadingPrefetch;                // The page being loaded is a prefetch
+    
+    void dropGhost(uint32_t node) {
+        SlotLists::List& list = ghostList[node] == GHOST_B1 ? b1 : b2;
+        ghostLinks.remove(list, node);
+        ghostIndex.erase(ghostKey[node]);
+        freeGhosts.push_back(node);
+    }
+    
+    void addGhost(SlotLists::List& list, GhostList which, uint64_t key) {
+        uint32_t node = freeGhosts.back();
+        freeGhosts.pop_back();
+        ghostKey[node] = key;
+        ghostList[node] = static_cast<uint8_t>(which);
+        ghostLinks.pushBack(list, node);
+        ghostIndex.insert(key, node);
+    }
+    
+    /**
+     * ARC REPLACE: evict from T1 while it exceeds the target, else from T2;
+     * the victim's key is remembered in the matching ghost list
+     */
+    FrameId arcEvict() {
+        bool fromT1 = t1.size > 0 && (t1.size > target || (faultFromB2 && t1.size == target) || t2.size == 0);
+        SlotLists::List& list = fromT1 ? t1 : t2;
+        FrameId victim = frameLinks.popFront(list);
+        arcList[victim] = ARC_NONE;
+        prefetched[victim] = 0;
+        
+        // Ghost lists together hold at most capacity keys
+        if (freeGhosts.empty()) dropGhost((b1.size > 0 ? b1 : b2).head);
+        if (fromT1) addGhost(b1, GHOST_B1, frameKey[victim]);
+        else addGhost(b2, GHOST_B2, frameKey[victim]);
+        return victim;
+    }
+
+public:
+    PageReplacer() : policy(POLICY_LRU), capacity(0), queue(SlotLists::empty()), t1(SlotLists::empty()),
+                     t2(SlotLists::empty()), hand(0), b1(SlotLists::empty()), b2(SlotLists::empty()),
+                     target(0), faultFromB2(false), faultGhostHit(false), loadingPrefetch(false) {}
+    
+    /**
+     * Reset for a memory of frameCount frames, all free
+     */
+    void configure(Policy replacement, FrameId frameCount) {
+        policy = replacement;
+        capacity = frameCount;
+        frameLinks = SlotLists(frameCount);
+        queue = t1 = t2 = SlotLists::empty();
+        hand = 0;
+        target = 0;
+        faultFromB2 = false;
+        faultGhostHit = false;
+        loadingPrefetch = false;
+        
+        std::vector<uint8_t>(policy == POLICY_CLOCK ? frameCount : 0, 0).swap(referenced);
+        std::vector<uint8_t>(policy == POLICY_CLOCK ? frameCount : 0, 0).swap(resident);
+        
+        size_t arcFrames = policy == POLICY_ARC ? frameCount : 0;
+        std::vector<uint8_t>(arcFrames, ARC_NONE).swap(arcList);
+        std::vector<uint64_t>(arcFrames, 0).swap(frameKey);
+        std::vector<uint8_t>(arcFrames, 0).swap(prefetched);
+        ghostLinks = SlotLists(arcFrames);
+        b1 = b2 = SlotLists::empty();
+        std::vector<uint64_t>(arcFrames, 0).swap(ghostKey);
+        std::vector<uint8_t>(arcFrames, GHOST_B1).swap(ghostList);
+        freeGhosts.clear();
+        for (size_t i = arcFrames; i > 0; i--) freeGhosts.push_back(static_cast<uint32_t>(i - 1));
+        ghostIndex.reset(arcFrames);
+    }
+    
+    Policy replacementPolicy() const { return policy; }
+    
+    // ARC list sizes: pages referenced once (T1) and more than once (T2)
+    size_t recentPages() const { return t1.size; }
+    size_t frequentPages() const { return t2.size; }
+    
+    /**
+     * A resident page was translated
+     */
+    void onAccess(FrameId frame) {
+        switch (policy) {
+            case POLICY_LRU:
+                frameLinks.moveToBack(queue, frame);
+                break;
+            case POLICY_CLOCK:
+                referenced[frame] = 1;
+                break;
+            case POLICY_ARC:
+                if (prefetched[frame]) {
+                    // First demand use of a prefetched page: its first reference,
+                    // so it stays in the recency list
+                    prefetched[frame] = 0;
+                    frameLinks.moveToBack(t1, frame);
+                    break;
+                }
+                // Any repeat use promotes to (or refreshes in) the frequency list
+                frameLinks.remove(arcList[frame] == ARC_T1 ? t1 : t2, frame);
+                frameLinks.pushBack(t2, frame);
+                arcList[frame] = ARC_T2;
+                break;
+            default:
+                break;
+        }
+    }
+    
+    /**
+     * A page fault is being served; ARC adapts its target on ghost hits
+     */
+    void onFault(uint64_t key) {
+        if (policy != POLICY_ARC) return;
+        
+        faultFromB2 = false;
+        faultGhostHit = false;
+        loadingPrefetch = false;
+        uint32_t node = ghostIndex.find(key);
+        if (node == GhostIndex::NONE) return;
+        
+        if (ghostList[node] == GHOST_B1) {
+            // Recently evicted from T1: recency deserved more room
+            FrameId step = b1.size >= b2.size ? 1 : static_cast<FrameId>(b2.size / b1.size);
+            target = target + step < capacity ? target + step : capacity;
+        } else {
+            // Recently evicted from T2: frequency deserved more room
+            FrameId step = b2.size >= b1.size ? 1 : static_cast<FrameId>(b1.size / b2.size);
+            target = target > step ? target - step : 0;
+            faultFromB2 = true;
+        }
+        
+        // The page is about to become resident in T2; forget its ghost now
+        // so a full ghost pool cannot recycle it during the eviction
+        dropGhost(node);
+        faultGhostHit = true;
+    }
+    
+    /**
+     * A page is being prefetched; it becomes resident without counting as a
+     * fault, so ARC neither adapts its target nor treats a ghost hit as
+     * reuse: the page enters T1, and its first access counts as its first
+     * reference (it stays in T1), so a prefetched scan never reaches T2
+     */
+    void onPrefetch(uint64_t key) {
+        if (policy != POLICY_ARC) return;
+        
+        faultFromB2 = false;
+        faultGhostHit = false;
+        loadingPrefetch = true;
+        uint32_t node = ghostIndex.find(key);
+        if (node != GhostIndex::NONE) dropGhost(node);
+    }
+    
+    /**
+     * Choose a victim among resident pages and stop tracking it
+     * (only called when every frame is resident)
+     */
+    FrameId evict() {
+        switch (policy) {
+            case POLICY_CLOCK:
+                while (true) {
+                    FrameId frame = hand;
+                    hand = hand + 1 < capacity ? hand + 1 : 0;
+                    if (!resident[frame]) continue;
+                    if (referenced[frame]) {
+                        referenced[frame] = 0;
+                        continue;
+                    }
+                    resident[frame] = 0;
+                    return frame;
+                }
+            case POLICY_ARC:
+                return arcEvict();
+            default:
+                return frameLinks.popFront(queue);
+        }
+    }
+    
+    /**
+     * The faulting or prefetched page now occupies frame
+     */
+    void onLoad(FrameId frame, uint64_t key) {
+        switch (policy) {
+            case POLICY_CLOCK:
+                resident[frame] = 1;
+                referenced[frame] = 1;
+                break;
+            case POLICY_ARC:
+                frameKey[frame] = key;
+                prefetched[frame] = loadingPrefetch;
+                loadingPrefetch = false;
+                if (faultGhostHit) {
+                    // Ghost hit: the page has been used before, so it is frequent
+                    faultGhostHit = false;
+                    frameLinks.pushBack(t2, frame);
+                    arcList[frame] = ARC_T2;
+                } else {
+                    // New page: keep |T1| + |B1| <= c and the directory <= 2c
+                    if (t1.size + b1.size >= capacity && b1.size > 0) {
+                        dropGhost(b1.head);
+                    } else if (t1.size + t2.size + b1.size + b2.size >= 2 * static_cast<size_t>(capacity) &&
+                               b2.size > 0) {
+                        dropGhost(b2.head);
+                    }
+                    frameLinks.pushBack(t1, frame);
+                    arcList[frame] = ARC_T1;
+                }
+                break;
+            default:
+                frameLinks.pushBack(queue, frame);
+                break;
+        }
+    }
+    
+    /**
+     * A resident page was discarded without eviction (its job was removed)
+     */
+    void onFree(FrameId frame) {
+        switch (policy) {
+            case POLICY_CLOCK:
+                resident[frame] = 0;
+                referenced[frame] = 0;
+                break;
+            case POLICY_ARC:
+                frameLinks.remove(arcList[frame] == ARC_T1 ? t1 : t2, frame);
+                arcList[frame] = ARC_NONE;
+                prefetched[frame] = 0;
+                break;
+            default:
+                frameLinks.remove(queue, frame);
+                break;
+        }
+    }
+    
+    /**
+     * A resident page was migrated from one frame to another (free) frame;
+     * it keeps its place in the replacement order
+     */
+    void onMove(FrameId from, FrameId to) {
+        switch (policy) {
+            case POLICY_CLOCK:
+                resident[to] = resident[from];
+                referenced[to] = referenced[from];
+                resident[from] = 0;
+                referenced[from] = 0;
+                break;
+            case POLICY_ARC:
+                frameLinks.replace(arcList[from] == ARC_T1 ? t1 : t2, from, to);
+                arcList[to] = arcList[from];
+                frameKey[to] = frameKey[from];
+                prefetched[to] = prefetched[from];
+                arcList[from] = ARC_NONE;
+                prefetched[from] = 0;
+                break;
+            default:
+                frameLinks.replace(queue, from, to);
+                break;
+        }
+    }
+    
+    static const char* policyName(Policy p) {
+        switch (p) {
+            case POLICY_FIFO: return "FIFO";
+            case POLICY_CLOCK: return "Clock";
+            case POLICY_ARC: return "ARC";
+            default: return "LRU";
+        }
+    }
+};
+
+#endif // PAGE_REPLACEMENT_H
@@ -0,0 +1,54 @@
+/**
+ * Page/Offset Splitters
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef PAGE_SPLIT_H
+#define PAGE_SPLIT_H
+
+#include <cstdint>
+
+#include "memory_types.h"
+
+/**
+ * Page/offset splitters used by address translation
+ * 
+ * Each splitter maps a logical address to its page number and offset and
+ * turns a frame number back into a frame base address. The manager picks
+ * one at construction; translation code is templated on the splitter so
+ * the power-of-two variants compile down to shifts and masks.
+ */
+
+// General splitter for any page size (runtime divide and modulo)
+struct DividePageSplit {
+    uint64_t pageSize;
+    
+    explicit DividePageSplit(uint64_t pageSize) : pageSize(pageSize) {}
+    uint64_t pageOf(Address address) const { return address / pageSize; }
+    uint64_t offsetOf(Address address) const { return address % pageSize; }
+    Address frameBase(FrameId frameNumber) const { return static_cast<Address>(frameNumber) * pageSize; }
+};
+
+// Splitter for power-of-two page sizes known only at runtime
+struct ShiftPageSplit {
+    int shift;
+    uint64_t mask;
+    
+    explicit ShiftPageSplit(int shift) : shift(shift), mask((uint64_t(1) << shift) - 1) {}
+    uint64_t pageOf(Address address) const { return address >> shift; }
+    uint64_t offsetOf(Address address) const { return address & mask; }
+    Address frameBase(FrameId frameNumber) const { return static_cast<Address>(frameNumber) << shift; }
+};
+
+// Splitter for power-of-two page sizes fixed at compile time
+template <int Shift>
+struct FixedShiftPageSplit {
+    static constexpr uint64_t mask = (uint64_t(1) << Shift) - 1;
+    
+    uint64_t pageOf(Address address) const { return address >> Shift; }
+    uint64_t offsetOf(Address address) const { return address & mask; }
+    Address frameBase(FrameId frameNumber) const { return static_cast<Address>(frameNumber) << Shift; }
+};
+
+#endif // PAGE_SPLIT_H
@@ -6,459 +6,940 @@
  * - Address translation (logical to physical)
  * - Internal fragmentation calculation
  * - Random frame allocation
+ * - Demand paging with FIFO, LRU, Clock or ARC replacement
  * - Memory management operations
  * 
+ * This file is the interactive front end; the memory manager itself lives
+ * in the header-only library paged_memory.h and performs no console I/O.
+ * 
  * Author: OS Lab Project
  * Version: 2.0 (Fixed)
  */
 
 #include <iostream>
-#include <vector>
-#include <random>
 #include <iomanip>
-#include <algorithm>
-#include <map>
+#include <string>
 #include <limits>  // For input validation
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <chrono>
+
+#include "paged_memory.h"
+#include "trace_replay.h"
+#include "binary_trace.h"
+#include "memory_snapshot.h"
 
 using namespace std;
 
+// Largest page size accepted (1GB, the largest common huge page)
+const long long MAX_PAGE_SIZE = 1LL << 30;
+
 /**
- * Structure to represent a job/process in the system
- * Contains job metadata and page assignments
+ * Bytes in a huge page of the given class
  */
-struct Job {
-    int id;              // Unique job identifier
-    string name;         // Human-readable job name
-    int size;           // Job size in bytes
-    vector<int> pages;  // Page numbers assigned to this job
-};
+Address hugePageBytes(const PagedMemoryManager& manager, int sizeClass) {
+    return static_cast<Address>(manager.getPageSize()) << HUGE_PAGE_SHIFTS[sizeClass];
+}
 
 /**
- * Structure to represent a logical page
- * Maps logical pages to physical frames
+ * Page size as a short label (4K, 2M, 1G), in bytes if not a whole unit
  */
-struct Page {
-    int pageNumber;   // Logical page number
-    int frameNumber;  // Physical frame number
-    bool isValid;     // Page validity flag
-    int jobId;        // ID of job owning this page
-    int offset;       // Offset within the page
-};
+string formatPageSize(Address bytes) {
+    const char* units[] = {"", "K", "M", "G", "T"};
+    int unit = 0;
+    while (unit < 4 && bytes >= 1024 && bytes % 1024 == 0) {
+        bytes /= 1024;
+        unit++;
+    }
+    return to_string(bytes) + units[unit];
+}
 
 /**
- * Structure to represent a physical page frame
- * Represents actual memory blocks in physical RAM
+ * Display the outcome of accepting a job
  */
-struct PageFrame {
-    int frameNumber;  // Physical frame number
-    bool isOccupied;  // Whether frame is in use
-    int jobId;        // ID of job using this frame
-    int pageNumber;   // Logical page number stored here
-    int size;         // Frame size in bytes (equal to page size)
-};
+void printAcceptResult(const PagedMemoryManager& manager, const AcceptResult& result, Address jobSize) {
+    if (!result.success) {
+        cout << "Error: " << result.errorMessage() << endl;
+        return;
+    }
+    
+    const Job* job = manager.findJob(result.jobId);
+    
+    // Display comprehensive job allocation information
+    cout << "\n=== Job Allocated Successfully ===" << endl;
+    cout << "Job ID: " << result.jobId << endl;
+    cout << "Job Name: " << *job->name << endl;
+    cout << "Job Size: " << jobSize << " bytes" << endl;
+    cout << "Pages Allocated: " << result.pagesAllocated << endl;
+    
+    // Display fragmentation information
+    if (result.internalFragmentation > 0) {
+        cout << "Internal Fragmentation: " << result.internalFragmentation << " bytes" << endl;
+        cout << "Fragmentation Percentage: " << fixed << setprecision(2) 
+             << (double)result.internalFragmentation / jobSize * 100 << "%" << endl;
+    } else {
+        cout << "Internal Fragmentation: 0 bytes (perfect fit)" << endl;
+    }
+    
+    if (job->hugeCoveredPages > 0) {
+        cout << "Huge Pages:";
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+            if (!job->hugeFrames[c].empty()) {
+                cout << " " << job->hugeFrames[c].size() << " x " << formatPageSize(hugePageBytes(manager, c));
+            }
+        }
+        cout << " (covering " << job->hugeCoveredPages << " pages)" << endl;
+    }
+    
+    cout << "Page Numbers: ";
+    if (job->pages.size() != job->pageCount) {
+        // Multi-level tables and huge pages keep no list for some or all
+        // pages; the numbers are consecutive
+        cout << job->firstPage << "-" << job->firstPage + job->pageCount - 1;
+        if (!job->pages.empty()) cout << " (base pages: ";
+    }
+    for (PageId pageNum : job->pages) {
+        cout << pageNum << " ";
+    }
+    if (!job->pages.empty() && job->pages.size() != job->pageCount) cout << ")";
+    cout << endl;
+}
 
 /**
- * Paged Memory Manager Class
- * 
- * Manages the entire paged memory system including:
- * - Physical frame allocation
- * - Logical page management
- * - Address translation
- * - Job lifecycle management
+ * Display the outcome of an address resolution
  */
-class PagedMemoryManager {
-private:
-    // System configuration
-    int pageSize;        // Size of each page/frame in bytes
-    int totalFrames;     // Total number of physical frames available
-    
-    // Data structures for memory management
-    vector<PageFrame> frames;    // Physical memory frames
-    vector<Page> pages;          // Logical pages
-    vector<Job> jobs;            // Active jobs/processes
-    map<int, int> pageTable;     // Page number -> Frame number mapping
-    
-    // ID generators for unique identification
-    int nextJobId;       // Next available job ID
-    int nextPageNumber;  // Next available page number
-    
-public:
-    /**
-     * Constructor - Initialize the paged memory manager
-     * @param pageSize Size of each page/frame in bytes
-     * @param totalFrames Total number of physical frames
-     */
-    PagedMemoryManager(int pageSize, int totalFrames) 
-        : pageSize(pageSize), totalFrames(totalFrames), nextJobId(1), nextPageNumber(1) {
-        
-        // Validate input parameters
-        if (pageSize <= 0 || totalFrames <= 0) {
-            throw invalid_argument("Page size and frame count must be positive");
+void printTranslationResult(const PagedMemoryManager& manager, const TranslationResult& result,
+                            int jobId, Address logicalAddress) {
+    if (!result.success) {
+        cout << "Error: " << result.errorMessage() << endl;
+        return;
+    }
+    
+    // Display comprehensive address resolution information
+    cout << "\n=== Address Resolution ===" << endl;
+    cout << "Job ID: " << jobId << endl;
+    cout << "Logical Address: " << logicalAddress << endl;
+    cout << "Page Number: " << result.pageNumber << endl;
+    cout << "Page Offset: " << result.offset << endl;
+    cout << "Actual Page Number: " << result.actualPageNumber << endl;
+    cout << "Frame Number: " << result.frameNumber << endl;
+    if (manager.getTlb().enabled()) {
+        cout << "TLB: " << (result.tlbHit ? "Hit" : "Miss") << endl;
+    }
+    if (manager.demandPagingEnabled()) {
+        cout << "Page Fault: " << (result.pageFault ? "Yes (page loaded)" : "No") << endl;
+    }
+    if (result.copiedOnWrite) cout << "Copy-on-Write: Yes (page copied to a private frame)" << endl;
+    cout << "Physical Address: " << result.physicalAddress << endl;
+    
+    // Verify the translation is correct
+    cout << "Verification: Frame " << result.frameNumber << " * " << manager.getPageSize() 
+         << " + " << result.offset << " = " << result.physicalAddress << endl;
+}
+
+/**
+ * Display the outcome of removing a job
+ */
+void printRemoveResult(const RemoveResult& result, int jobId) {
+    if (!result.success) {
+        cout << "Error: " << result.errorMessage() << endl;
+        return;
+    }
+    
+    cout << "Freeing " << result.framesFreed << " frames for job " << jobId << "..." << endl;
+    cout << "Job " << jobId << " ('" << *result.jobName << "') removed successfully." << endl;
+    cout << "Freed " << result.pagesFreed << " pages and " << result.framesFreed << " frames." << endl;
+}
+
+/**
+ * Display demand-paging statistics
+ */
+void printPageFaultStats(const PagedMemoryManager& manager) {
+    cout << "Demand Paging: " << PageReplacer::policyName(manager.getReplacementPolicy()) << " replacement" << endl;
+    cout << "Page Faults: " << manager.getPageFaults() << " of " << manager.getDemandAccesses()
+         << " accesses (" << fixed << setprecision(2) << manager.getPageFaultRate() * 100
+         << "% fault rate), Evictions: " << manager.getEvictions() << endl;
+}
+
+/**
+ * Display the swap device's simulated timing: fault stalls, prefetch and
+ * the latency it hid, and batched writeback
+ */
+void printSwapStats(const PagedMemoryManager& manager) {
+    const SwapDevice& swap = manager.getSwap();
+    const SwapStats& stats = swap.stats();
+    uint64_t exposed = stats.stallNs;
+    uint64_t faultLatency = stats.hiddenNs + exposed;
+    
+    cout << "Swap Device: " << swap.accessLatency() << " ns latency, " << swap.transferTime()
+         << " ns transfer per page, writeback batches of " << swap.writebackBatch()
+         << ", prefetch window " << swap.prefetchWindow() << endl;
+    cout << "Simulated Time: " << fixed << setprecision(3) << stats.simulatedNs / 1e6 << " ms, Stalled: "
+         << stats.stallNs / 1e6 << " ms (" << stats.demandReads << " demand reads)" << endl;
+    cout << "Prefetch: " << stats.prefetchesIssued << " issued, " << stats.prefetchHits << " hits, "
+         << stats.prefetchesWasted << " wasted; Fault Latency Hidden: " << stats.hiddenNs / 1e6 << " of "
+         << faultLatency / 1e6 << " ms (" << setprecision(1)
+         << (faultLatency ? 100.0 * stats.hiddenNs / faultLatency : 0.0) << "%)" << endl;
+    cout << "Writeback: " << stats.dirtyEvictions << " dirty evictions, " << stats.pagesWritten
+         << " pages written in " << stats.writeBatches << " batches" << endl;
+}
+
+/**
+ * Display page-table shape, memory and walk statistics
+ */
+void printPageTableStats(const PagedMemoryManager& manager) {
+    size_t nodes;
+    size_t bytes = manager.pageTableBytes(nodes);
+    cout << "Page Table: ";
+    if (manager.getPageTableLevels() > 1) {
+        cout << manager.getPageTableLevels() << "-level radix, " << nodes << " nodes, ";
+    } else {
+        cout << "flat, ";
+    }
+    cout << fixed << setprecision(1) << bytes / 1024.0 << " KB" << endl;
+    cout << "Page Walks: " << manager.getPageWalks() << " (average depth " << fixed << setprecision(2)
+         << manager.getAverageWalkDepth() << "), Memory References per Translation: "
+         << manager.getMemoryRefsPerTranslation() << endl;
+    
+    if (manager.getHugePages() != PagedMemoryManager::HUGE_PAGES_NONE) {
+        size_t basePageEntries;
+        size_t entries = manager.pageTableEntries(basePageEntries);
+        cout << "Huge Pages: ";
+        const char* separator = "";
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+            if (manager.getHugePages() & (1 << c)) {
+                cout << separator << manager.hugePagesInUse(c) << " x " << formatPageSize(hugePageBytes(manager, c));
+                separator = ", ";
+            }
         }
-        
-        // Initialize all frames as free
-        frames.resize(totalFrames);
-        for (int i = 0; i < totalFrames; i++) {
-            frames[i] = {i, false, -1, -1, pageSize};
+        cout << ", Page-Table Entries: " << entries << " (" << basePageEntries << " with "
+             << formatPageSize(manager.getPageSize()) << " pages only)" << endl;
+        uint64_t walks = manager.getPageWalks();
+        cout << "Huge Page Walks: " << manager.getHugeTranslations() << " of " << walks << " ("
+             << fixed << setprecision(1)
+             << (walks ? 100.0 * manager.getHugeTranslations() / walks : 0.0) << "%)" << endl;
+    }
+}
+
+/**
+ * Display external fragmentation: free runs by length and compaction work
+ */
+void printFragmentationStats(const PagedMemoryManager& manager) {
+    FreeRunHistogram freeRuns = manager.getFreeRunHistogram();
+    cout << "Free Runs: " << freeRuns.runCount << " (largest: " << freeRuns.largestRun << " frames)"
+         << ", External Fragmentation: " << fixed << setprecision(1)
+         << manager.getExternalFragmentation() * 100 << "%" << endl;
+    if (freeRuns.runCount > 1) {
+        // Bucket b holds runs of 2^b to 2^(b+1) - 1 frames
+        cout << "Free Run Lengths: ";
+        const char* separator = "";
+        for (int b = 0; b < FreeRunHistogram::BUCKETS; b++) {
+            if (freeRuns.buckets[b] == 0) continue;
+            cout << separator << (uint64_t(1) << b);
+            separator = ", ";
+            if (b > 0) cout << "-" << (uint64_t(2) << b) - 1;
+            cout << ": " << freeRuns.buckets[b];
         }
+        cout << endl;
+    }
+    if (manager.getFramesMigrated() > 0) {
+        cout << "Compaction: " << manager.getFramesMigrated() << " pages migrated" << endl;
+    }
+}
+
+/**
+ * Compact memory in steps of at most budget migrations, reporting how the
+ * work was spread
+ */
+void runCompaction(PagedMemoryManager& manager, FrameId budget) {
+    typedef chrono::steady_clock Clock;
+    
+    FreeRunHistogram before = manager.getFreeRunHistogram();
+    LatencyHistogram stepLatency;
+    uint64_t moved = 0;
+    manager.startCompaction();
+    while (true) {
+        Clock::time_point start = Clock::now();
+        CompactionStep step = manager.compactStep(budget);
+        stepLatency.record(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count());
+        moved += step.framesMoved;
+        if (step.finished) break;
+    }
+    FreeRunHistogram after = manager.getFreeRunHistogram();
+    
+    cout << "\n=== Compaction Complete ===" << endl;
+    cout << "Pages Migrated: " << moved << " in " << stepLatency.count() << " steps of at most "
+         << budget << endl;
+    cout << "Step Latency (ns): p50 " << stepLatency.percentile(50.0) << ", p99 " << stepLatency.percentile(99.0)
+         << ", max " << stepLatency.max() << endl;
+    cout << "Largest Free Run: " << before.largestRun << " -> " << after.largestRun << " frames ("
+         << before.runCount << " -> " << after.runCount << " free runs)" << endl;
+}
+
+/**
+ * Display the manager's operation counters and latency histograms
+ */
+void printOperationStats(const PagedMemoryManager& manager) {
+    static const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+    
+    cout << "\n=== Operation Statistics ===" << endl;
+    if (!OperationStats::ENABLED) {
+        cout << "Instrumentation was compiled out (PAGED_MEMORY_STATS=0)." << endl;
+        return;
     }
     
-    /**
-     * Accept a new job and allocate memory pages for it
-     * @param jobName Name of the job/process
-     * @param jobSize Size of the job in bytes
-     * @return true if job was successfully allocated, false otherwise
-     */
-    bool acceptJob(string jobName, int jobSize) {
+    const OperationStats& stats = manager.getOperationStats();
+    const StatCounters& counters = stats.counters();
+    cout << "Accepts: " << counters.accepts << ", Rejected for lack of frames: " << counters.acceptRejects
+         << ", Other failures: " << counters.acceptFailures << endl;
+    cout << "Translations: " << counters.translations << ", Failed: " << counters.translationFailures
+         << ", Page Faults: " << counters.pageFaults << endl;
+    cout << "Removals: " << counters.removals << ", Failed: " << counters.removeFailures << endl;
+    
+    cout << "\nLatency (ns; translations sampled 1 in "
+         << OperationStats::TRANSLATE_SAMPLE_INTERVAL << "):" << endl;
+    cout << setw(16) << "Op" << setw(12) << "Samples" << setw(10) << "p50" << setw(10) << "p90"
+         << setw(10) << "p99" << setw(10) << "p99.9" << setw(10) << "max" << endl;
+    cout << string(78, '-') << endl;
+    for (int op = 0; op < STAT_OP_KINDS; op++) {
+        const LatencyHistogram& latency = stats.latency(static_cast<StatOp>(op));
+        if (latency.count() == 0) continue;
         
-        // Input validation - reject negative or zero job sizes
-        if (jobSize <= 0) {
-            cout << "Error: Job size must be positive. Got: " << jobSize << " bytes" << endl;
-            return false;
+        cout << setw(16) << statOpName(static_cast<StatOp>(op)) << setw(12) << latency.count();
+        for (double p : percentiles) {
+            cout << setw(10) << latency.percentile(p);
         }
-        
-        // Input validation - check for reasonable job size limits
-        const int MAX_JOB_SIZE = 100 * 1024 * 1024; // 100MB limit
-        if (jobSize > MAX_JOB_SIZE) {
-            cout << "Error: Job size too large. Maximum allowed: " << MAX_JOB_SIZE << " bytes" << endl;
-            return false;
+        cout << setw(10) << latency.max() << endl;
+    }
+}
+
+/**
+ * Display comprehensive memory state information
+ * Shows frame allocation, page table, and job information
+ */
+void displayMemoryState(const PagedMemoryManager& manager) {
+    FrameId totalFrames = manager.getTotalFrames();
+    const Tlb& tlb = manager.getTlb();
+    
+    cout << "\n=== Memory State ===" << endl;
+    cout << "Page Size: " << manager.getPageSize() << " bytes" << endl;
+    cout << "Total Frames: " << totalFrames << endl;
+    cout << "Memory Efficiency: ";
+    
+    // Calculate memory utilization statistics (vectorized popcount over the occupancy bitmap)
+    FrameId usedFrames = manager.getFrameTable().countOccupied();
+    
+    double utilization = (double)usedFrames / totalFrames * 100;
+    cout << usedFrames << " / " << totalFrames << " (" << fixed << setprecision(1) 
+         << utilization << "% used)" << endl;
+    
+    cout << "Placement: " << PagedMemoryManager::placementName(manager.getPlacement());
+    if (manager.getNumaNodes() > 1) cout << " (" << manager.getNumaNodes() << " NUMA nodes)";
+    cout << endl;
+    
+    if (manager.demandPagingEnabled()) {
+        printPageFaultStats(manager);
+    }
+    if (manager.getSwap().enabled()) {
+        printSwapStats(manager);
+    }
+    
+    printPageTableStats(manager);
+    
+    printFragmentationStats(manager);
+    
+    if (manager.getFramesSavedByCow() > 0 || manager.getCowCopies() > 0) {
+        cout << "Copy-on-Write: " << manager.getFramesSavedByCow() << " frames saved by sharing, "
+             << manager.getCowCopies() << " pages copied on write" << endl;
+    }
+    
+    if (tlb.enabled()) {
+        cout << "TLB: " << tlb.entryCount() << " entries, " << tlb.associativity() << "-way, "
+             << Tlb::policyName(tlb.replacementPolicy()) << " replacement" << endl;
+        cout << "TLB Hits: " << tlb.hitCount() << ", Misses: " << tlb.missCount()
+             << " (" << fixed << setprecision(1) << tlb.hitRate() * 100 << "% hit rate)" << endl;
+        cout << "Effective Access Time: " << fixed << setprecision(2)
+             << tlb.effectiveAccessTimeNs() << " ns" << endl;
+    }
+    
+    cout << "\nFrame Allocation:" << endl;
+    cout << setw(8) << "Frame" << setw(10) << "Job ID" << setw(12) << "Page #" << setw(8) << "Status" << endl;
+    cout << string(40, '-') << endl;
+    
+    const FrameTable& frames = manager.getFrameTable();
+    for (FrameId frame = 0; frame < totalFrames; frame++) {
+        bool occupied = frames.isOccupied(frame);
+        cout << setw(8) << frame 
+             << setw(10) << (occupied ? to_string(frames.ownerOf(frame)) : "-")
+             << setw(12) << (occupied ? to_string(frames.pageOf(frame)) : "-")
+             << setw(8) << (!occupied ? "Free" : frames.isShared(frame) ? "Shared" : "Used") << endl;
+    }
+    
+    vector<const Job*> sortedJobs = manager.jobsById();
+    
+    // Page numbers grow with job IDs, so this view is ordered by page number
+    cout << "\nPage Table:" << endl;
+    cout << setw(10) << "Page #" << setw(12) << "Frame #" << endl;
+    cout << string(25, '-') << endl;
+    for (const Job* job : sortedJobs) {
+        if (job->radixTable.levels() > 0 || job->hugeCoveredPages > 0) {
+            // Multi-level tables list only the pages they map; huge pages
+            // list each base page they cover
+            job->forEachResidentPage([job](PageId index, FrameId frame) {
+                cout << setw(10) << job->firstPage + index << setw(12) << frame << endl;
+            });
+            continue;
         }
-        
-        // Calculate number of pages needed using ceiling division
-        int pagesNeeded = (jobSize + pageSize - 1) / pageSize;
-        
-        // Check if we have enough free frames for this job
-        int freeFrames = 0;
-        for (const auto& frame : frames) {
-            if (!frame.isOccupied) freeFrames++;
+        for (size_t i = 0; i < job->frameTable.size(); i++) {
+            FrameId frame = job->frameTable[i];
+            cout << setw(10) << job->pages[i]
+                 << setw(12) << (frame != INVALID_FRAME ? to_string(frame) : "-") << endl;
         }
-        
-        if (freeFrames < pagesNeeded) {
-            cout << "Error: Not enough free frames. Need " << pagesNeeded 
-                 << " frames, but only " << freeFrames << " are available." << endl;
+    }
+    
+    cout << "\nJobs:" << endl;
+    cout << setw(8) << "Job ID" << setw(15) << "Job Name" << setw(10) << "Size" 
+         << setw(15) << "Pages" << endl;
+    cout << string(50, '-') << endl;
+    
+    for (const Job* jobPtr : sortedJobs) {
+        const Job& job = *jobPtr;
+        cout << setw(8) << job.id 
+             << setw(15) << *job.name 
+             << setw(10) << job.size
+             << setw(15) << job.pageCount << endl;
+    }
+}
+
+/**
+ * Manager settings chosen on the command line
+ */
+struct SimulatorOptions {
+    int tlbEntries;                              // 0 = no TLB
+    int tlbWays;                                 // 0 = fully associative
+    Tlb::Policy tlbPolicy;
+    PagedMemoryManager::Placement placement;
+    int numaNodes;
+    bool demandPaging;                           // Whether replacement was given
+    PageReplacer::Policy replacement;            // Page replacement under demand paging
+    int pageTableLevels;                         // 1 = flat, 2-4 = radix
+    int hugePages;                               // PagedMemoryManager::HugePages flags
+    bool seeded;                                 // Whether seed was given
+    uint64_t seed;                               // Frame selection seed
+    long long swapLatencyNs;                     // Swap device latency (-1 = no swap device)
+    long long swapBandwidthMBps;
+    long long writebackBatch;                    // Dirty pages per swap write
+    long long prefetchPages;                     // Swap read-ahead window
+    string loadStatePath;                        // State image to start from (empty = none)
+    string saveStatePath;                        // State image to write on exit (empty = none)
+};
+
+/**
+ * Map the state image named by --load-state, if any, and take the memory
+ * geometry from it
+ * @return false (after printing why) if the image cannot be used
+ */
+bool openStateImage(const SimulatorOptions& options, MemoryImage& image, long long& pageSize,
+                    long long& totalFrames) {
+    if (options.loadStatePath.empty()) return true;
+    string error;
+    if (!image.open(options.loadStatePath, error)) {
+        cout << "Error: " << error << endl;
+        return false;
+    }
+    pageSize = image.header().pageSize;
+    totalFrames = image.header().totalFrames;
+    return true;
+}
+
+/**
+ * Write the state image named by --save-state, if any
+ * @return false (after printing why) if it could not be written
+ */
+bool saveStateImage(const PagedMemoryManager& manager, const SimulatorOptions& options) {
+    if (options.saveStatePath.empty()) return true;
+    string error;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (!manager.saveState(options.saveStatePath, error)) {
+        cout << "Error: " << error << endl;
+        return false;
+    }
+    double millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Saved state (" << manager.getJobCount() << " jobs) to " << options.saveStatePath << " in "
+         << fixed << setprecision(2) << millis << " ms" << endl;
+    return true;
+}
+
+/**
+ * Apply command-line settings to a freshly constructed manager
+ * 
+ * With a state image the manager is restored from it instead, and the
+ * image's NUMA, placement, page-table, huge-page and demand-paging
+ * settings take the place of the command-line ones.
+ * @param image Mapped state image, or an unopened one to start empty
+ * @return false (after printing why) if the settings do not fit the manager
+ */
+bool configureManager(PagedMemoryManager& manager, const SimulatorOptions& options, const MemoryImage& image) {
+    if (options.tlbEntries > 0) {
+        manager.configureTlb(options.tlbEntries, options.tlbWays > 0 ? options.tlbWays : options.tlbEntries,
+                             options.tlbPolicy);
+    }
+    if (image.isOpen()) {
+        string error;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (!manager.loadState(image, error)) {
+            cout << "Error: " << error << endl;
             return false;
         }
-        
-        // Create new job object with validated parameters
-        Job newJob;
-        newJob.id = nextJobId++;
-        newJob.name = jobName;
-        newJob.size = jobSize;
-        
-        // Calculate internal fragmentation (wasted space in last page)
-        int internalFragmentation = 0;
-        if (jobSize % pageSize != 0) {
-            // If job doesn't fill the last page completely, there's fragmentation
-            internalFragmentation = pageSize - (jobSize % pageSize);
+        double millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Loaded state (" << manager.getJobCount() << " jobs) from " << options.loadStatePath
+             << " in " << fixed << setprecision(2) << millis << " ms" << endl;
+    } else {
+        if (static_cast<FrameId>(options.numaNodes) > manager.getTotalFrames()) {
+            cout << "Error: More NUMA nodes (" << options.numaNodes << ") than frames" << endl;
+            return false;
         }
-        
-        // Collect all available (free) frames
-        vector<int> availableFrames;
-        for (int i = 0; i < totalFrames; i++) {
-            if (!frames[i].isOccupied) {
-                availableFrames.push_back(i);
+        manager.configureNuma(options.numaNodes);
+        manager.setPlacement(options.placement);
+        manager.configurePageTable(options.pageTableLevels);
+        if (options.hugePages != PagedMemoryManager::HUGE_PAGES_NONE) {
+            if (options.demandPaging || options.pageTableLevels > 1) {
+                cout << "Error: Huge pages need eager allocation and a flat page table" << endl;
+                return false;
             }
+            manager.configureHugePages(options.hugePages);
         }
-        
-        // Randomize frame selection to prevent clustering and demonstrate
-        // non-contiguous memory allocation (key feature of paging)
-        random_device rd;
-        mt19937 g(rd());
-        shuffle(availableFrames.begin(), availableFrames.end(), g);
-        
-        // Allocate pages to randomly selected frames
-        for (int i = 0; i < pagesNeeded; i++) {
-            int frameNumber = availableFrames[i];
-            
-            // Create new logical page
-            Page newPage;
-            newPage.pageNumber = nextPageNumber++;
-            newPage.frameNumber = frameNumber;
-            newPage.isValid = true;
-            newPage.jobId = newJob.id;
-            newPage.offset = i * pageSize;
-            
-            // Add page to system
-            pages.push_back(newPage);
-            newJob.pages.push_back(newPage.pageNumber);
-            
-            // Mark frame as occupied and update frame metadata
-            frames[frameNumber].isOccupied = true;
-            frames[frameNumber].jobId = newJob.id;
-            frames[frameNumber].pageNumber = newPage.pageNumber;
-            
-            // Update page table for address translation
-            pageTable[newPage.pageNumber] = frameNumber;
+        if (options.demandPaging) manager.configureDemandPaging(options.replacement);
+    }
+    if (options.swapLatencyNs >= 0) {
+        if (!manager.demandPagingEnabled()) {
+            cout << "Error: A swap device needs --demand-paging" << endl;
+            return false;
+        }
+        manager.configureSwap(static_cast<uint64_t>(options.swapLatencyNs),
+                              static_cast<uint64_t>(options.swapBandwidthMBps),
+                              static_cast<uint32_t>(options.writebackBatch),
+                              static_cast<uint32_t>(options.prefetchPages));
+    }
+    if (options.seeded) manager.seedRandom(options.seed);
+    return true;
+}
+
+/**
+ * Print command-line usage
+ */
+void printUsage(const char* program) {
+    cout << "Usage: " << program << " [options]" << endl;
+    cout << "  --tlb-entries N     Simulate a TLB with N entries (default: no TLB)" << endl;
+    cout << "  --tlb-ways N        TLB associativity (default: fully associative)" << endl;
+    cout << "  --tlb-policy P      TLB replacement policy: lru, fifo or random (default: lru)" << endl;
+    cout << "  --placement P       Frame placement: random, first-fit, buddy or numa (default: random)" << endl;
+    cout << "  --numa-nodes N      Split memory into N NUMA nodes for numa placement (default: 1)" << endl;
+    cout << "  --demand-paging P   Load pages on first touch, replacing with fifo, lru, clock or arc" << endl;
+    cout << "  --page-table-levels N  Page-table levels: 1 (flat, default) or a 2-4 level radix tree" << endl;
+    cout << "  --huge-pages S      Back large jobs with huge pages: 2m, 1g or all (2^9 and 2^18" << endl;
+    cout << "                      base pages; default: none)" << endl;
+    cout << "  --swap-latency NS   Back demand paging with a simulated swap device of this latency" << endl;
+    cout << "  --swap-bandwidth N  Swap device bandwidth in MB/s (default: 500)" << endl;
+    cout << "  --writeback-batch N Dirty pages written back per swap request (default: 32)" << endl;
+    cout << "  --prefetch N        Pages read ahead of sequential accesses (default: 8, 0 = off)" << endl;
+    cout << "  --seed N            Seed frame selection for reproducible runs (default: from entropy)" << endl;
+    cout << "  --load-state FILE   Start from a saved state image; its memory size and allocation" << endl;
+    cout << "                      settings replace the corresponding options" << endl;
+    cout << "  --save-state FILE   Save the final state as an image on exit or after trace replay" << endl;
+    cout << "  --trace FILE        Replay a text or binary trace non-interactively and report timings" << endl;
+    cout << "  --page-size N       Page size in bytes for trace replay (default: 4096)" << endl;
+    cout << "  --frames N          Number of page frames for trace replay (default: 1024)" << endl;
+    cout << "  --analyze-window N  During trace replay, report reuse distances and working sets over" << endl;
+    cout << "                      windows of N accesses per job" << endl;
+    cout << "  --analyze-depth N   Pages tracked for reuse distances (default: 1048576)" << endl;
+    cout << "  --compact-budget N  During trace replay, compact memory after removals in steps of at" << endl;
+    cout << "                      most N page migrations, one step between operations" << endl;
+    cout << "  --snapshot F        Show memory state as compact text, json or binary snapshots" << endl;
+    cout << "                      instead of full tables (trace replay: one per poll)" << endl;
+    cout << "  --snapshot-mode M   full (default) or delta: after the first, only changed frames" << endl;
+    cout << "  --snapshot-file F   Append snapshots to a file instead of standard output" << endl;
+    cout << "  --top-jobs N        Largest jobs listed per snapshot (default: 10)" << endl;
+    cout << "  --convert-trace IN OUT  Convert a text trace to the binary trace format" << endl;
+}
+
+/**
+ * Convert a text trace to the memory-mappable binary format
+ * @return Process exit status
+ */
+int runConvertTrace(const string& inPath, const string& outPath) {
+    ifstream in(inPath.c_str());
+    if (!in) {
+        cout << "Error: Cannot open trace file " << inPath << endl;
+        return 1;
+    }
+    
+    uint64_t records = 0;
+    string error;
+    if (!convertTextTrace(in, outPath, records, error)) {
+        cout << "Error: " << error << endl;
+        return 1;
+    }
+    
+    cout << "Wrote " << records << " records to " << outPath << endl;
+    return 0;
+}
+
+/**
+ * Non-interactive mode: replay a trace file and report throughput/latency
+ * @param analyzeWindow Working-set window for access analysis (0 = no analysis)
+ * @param analyzeDepth Pages tracked for reuse distances
+ * @param snapshots Writes a snapshot at every poll, if given
+ * @param compactBudget Pages per compaction step run between operations after removals (0 = none)
+ * @return Process exit status
+ */
+int runTrace(const string& path, long long pageSize, long long totalFrames, const SimulatorOptions& options,
+             long long analyzeWindow, long long analyzeDepth, SnapshotWriter* snapshots, long long compactBudget) {
+    MemoryImage image;
+    if (!openStateImage(options, image, pageSize, totalFrames)) return 1;
+    if (pageSize <= 0 || totalFrames <= 0) {
+        cout << "Error: Page size and frame count must be positive" << endl;
+        return 1;
+    }
+    if (pageSize > MAX_PAGE_SIZE || totalFrames > static_cast<long long>(MAX_FRAMES)) {
+        cout << "Error: Page size (max " << MAX_PAGE_SIZE << ") or frame count (max "
+             << MAX_FRAMES << ") too large" << endl;
+        return 1;
+    }
+    
+    if (analyzeWindow < 0 || analyzeDepth <= 0) {
+        cout << "Error: Analysis window and depth must be positive" << endl;
+        return 1;
+    }
+    if (compactBudget < 0 || compactBudget > static_cast<long long>(MAX_FRAMES)) {
+        cout << "Error: Compaction budget must be between 0 and " << MAX_FRAMES << endl;
+        return 1;
+    }
+    
+    PagedMemoryManager manager(static_cast<uint32_t>(pageSize), static_cast<FrameId>(totalFrames));
+    if (!configureManager(manager, options, image)) return 1;
+    image.close();
+    
+    unique_ptr<AccessAnalyzer> analyzer;
+    if (analyzeWindow > 0) {
+        analyzer.reset(new AccessAnalyzer(static_cast<uint64_t>(analyzeWindow), static_cast<size_t>(analyzeDepth)));
+    }
+    
+    string error;
+    ReplayStats stats;
+    if (MappedBinaryTrace::isBinaryTrace(path)) {
+        // Binary traces are replayed in place from the mapping
+        MappedBinaryTrace trace;
+        if (!trace.open(path, error)) {
+            cout << "Error: " << error << endl;
+            return 1;
         }
         
-        // Add job to active jobs list
-        jobs.push_back(newJob);
-        
-        // Display comprehensive job allocation information
-        cout << "\n=== Job Allocated Successfully ===" << endl;
-        cout << "Job ID: " << newJob.id << endl;
-        cout << "Job Name: " << newJob.name << endl;
-        cout << "Job Size: " << jobSize << " bytes" << endl;
-        cout << "Pages Allocated: " << pagesNeeded << endl;
-        
-        // Display fragmentation information
-        if (internalFragmentation > 0) {
-            cout << "Internal Fragmentation: " << internalFragmentation << " bytes" << endl;
-            cout << "Fragmentation Percentage: " << fixed << setprecision(2) 
-                 << (double)internalFragmentation / jobSize * 100 << "%" << endl;
-        } else {
-            cout << "Internal Fragmentation: 0 bytes (perfect fit)" << endl;
+        cout << "Replaying " << trace.size() << " binary records from " << path << " ("
+             << pageSize << "-byte pages, " << totalFrames << " frames)" << endl;
+        stats = replayTrace(manager, trace, analyzer.get(), snapshots, static_cast<FrameId>(compactBudget));
+    } else {
+        ifstream file(path.c_str());
+        if (!file) {
+            cout << "Error: Cannot open trace file " << path << endl;
+            return 1;
         }
         
-        cout << "Page Numbers: ";
-        for (int pageNum : newJob.pages) {
-            cout << pageNum << " ";
+        vector<TraceOp> ops;
+        if (!parseTextTrace(file, ops, error)) {
+            cout << "Error: " << error << endl;
+            return 1;
         }
-        cout << endl;
         
-        return true;
+        cout << "Replaying " << ops.size() << " operations from " << path << " ("
+             << pageSize << "-byte pages, " << totalFrames << " frames)" << endl;
+        stats = replayTrace(manager, TextTraceSource(ops), analyzer.get(), snapshots,
+                            static_cast<FrameId>(compactBudget));
     }
+    printReplayReport(cout, stats);
     
-    /**
-     * Perform address resolution from logical to physical address
-     * @param jobId ID of the job
-     * @param logicalAddress Logical address to resolve
-     * @return true if resolution successful, false otherwise
-     */
-    bool resolveAddress(int jobId, int logicalAddress) {
-        
-        // Input validation - reject negative addresses
-        if (logicalAddress < 0) {
-            cout << "Error: Logical address cannot be negative. Got: " << logicalAddress << endl;
-            return false;
+    const Tlb& tlb = manager.getTlb();
+    if (tlb.enabled()) {
+        cout << "\nTLB Hits: " << tlb.hitCount() << ", Misses: " << tlb.missCount()
+             << " (" << fixed << setprecision(1) << tlb.hitRate() * 100 << "% hit rate)" << endl;
+    }
+    if (manager.demandPagingEnabled()) {
+        cout << endl;
+        printPageFaultStats(manager);
+        if (manager.getSwap().enabled()) printSwapStats(manager);
+    }
+    cout << endl;
+    printPageTableStats(manager);
+    printFragmentationStats(manager);
+    if (analyzer) printAccessReport(cout, *analyzer);
+    
+    if (!options.saveStatePath.empty()) cout << endl;
+    return saveStateImage(manager, options) ? 0 : 1;
+}
+
+/**
+ * Main function - Entry point of the program
+ * Handles user interaction and menu system
+ */
+int main(int argc, char* argv[]) {
+    // Parse command-line options
+    SimulatorOptions options = {0, 0, Tlb::POLICY_LRU, PagedMemoryManager::PLACEMENT_RANDOM, 1,
+                                false, PageReplacer::POLICY_LRU, 1, PagedMemoryManager::HUGE_PAGES_NONE,
+                                false, 0, -1, 500, 32, 8, "", ""};
+    string tracePath;
+    long long tracePageSize = 4096;
+    long long traceFrames = 1024;
+    long long analyzeWindow = 0;
+    long long analyzeDepth = 1 << 20;
+    string snapshotFormat;
+    string snapshotMode = "full";
+    string snapshotFile;
+    long long topJobs = 10;
+    long long compactBudget = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if (option == "--help" || option == "-h") {
+            printUsage(argv[0]);
+            return 0;
         }
-        
-        // Find the job by ID
-        Job* job = nullptr;
-        for (auto& j : jobs) {
-            if (j.id == jobId) {
-                job = &j;
-                break;
+        if (option == "--convert-trace") {
+            if (i + 2 >= argc) {
+                cout << "Error: --convert-trace needs an input and an output file" << endl;
+                return 1;
             }
+            return runConvertTrace(argv[i + 1], argv[i + 2]);
         }
-        
-        if (!job) {
-            cout << "Error: Job ID " << jobId << " not found." << endl;
-            return false;
-        }
-        
-        // Check if logical address is within job bounds
-        if (logicalAddress >= job->size) {
-            cout << "Error: Logical address " << logicalAddress 
-                 << " is out of bounds for job " << jobId << " (size: " << job->size << ")" << endl;
-            return false;
+        if (i + 1 >= argc) {
+            cout << "Error: Missing value for option " << option << endl;
+            printUsage(argv[0]);
+            return 1;
         }
         
-        // Perform address translation (logical -> physical)
-        // Step 1: Extract page number and offset from logical address
-        int pageNumber = logicalAddress / pageSize;
-        int offset = logicalAddress % pageSize;
-        
-        // Step 2: Validate page number is within job's allocated pages
-        if (pageNumber >= static_cast<int>(job->pages.size())) {
-            cout << "Error: Page number " << pageNumber << " is out of bounds." << endl;
-            return false;
+        string value = argv[++i];
+        if (option == "--tlb-entries") {
+            options.tlbEntries = atoi(value.c_str());
+        } else if (option == "--tlb-ways") {
+            options.tlbWays = atoi(value.c_str());
+        } else if (option == "--tlb-policy") {
+            if (value == "lru") {
+                options.tlbPolicy = Tlb::POLICY_LRU;
+            } else if (value == "fifo") {
+                options.tlbPolicy = Tlb::POLICY_FIFO;
+            } else if (value == "random") {
+                options.tlbPolicy = Tlb::POLICY_RANDOM;
+            } else {
+                cout << "Error: Unknown TLB policy '" << value << "'" << endl;
+                return 1;
+            }
+        } else if (option == "--placement") {
+            if (value == "random") {
+                options.placement = PagedMemoryManager::PLACEMENT_RANDOM;
+            } else if (value == "first-fit") {
+                options.placement = PagedMemoryManager::PLACEMENT_FIRST_FIT;
+            } else if (value == "buddy") {
+                options.placement = PagedMemoryManager::PLACEMENT_BUDDY;
+            } else if (value == "numa") {
+                options.placement = PagedMemoryManager::PLACEMENT_NUMA_LOCAL;
+            } else {
+                cout << "Error: Unknown placement policy '" << value << "'" << endl;
+                return 1;
+            }
+        } else if (option == "--numa-nodes") {
+            options.numaNodes = atoi(value.c_str());
+        } else if (option == "--demand-paging") {
+            options.demandPaging = true;
+            if (value == "fifo") {
+                options.replacement = PageReplacer::POLICY_FIFO;
+            } else if (value == "lru") {
+                options.replacement = PageReplacer::POLICY_LRU;
+            } else if (value == "clock") {
+                options.replacement = PageReplacer::POLICY_CLOCK;
+            } else if (value == "arc") {
+                options.replacement = PageReplacer::POLICY_ARC;
+            } else {
+                cout << "Error: Unknown replacement policy '" << value << "'" << endl;
+                return 1;
+            }
+        } else if (option == "--page-table-levels") {
+            options.pageTableLevels = atoi(value.c_str());
+        } else if (option == "--huge-pages") {
+            if (value == "none") {
+                options.hugePages = PagedMemoryManager::HUGE_PAGES_NONE;
+            } else if (value == "2m") {
+                options.hugePages = PagedMemoryManager::HUGE_PAGES_2M;
+            } else if (value == "1g") {
+                options.hugePages = PagedMemoryManager::HUGE_PAGES_1G;
+            } else if (value == "all") {
+                options.hugePages = PagedMemoryManager::HUGE_PAGES_ALL;
+            } else {
+                cout << "Error: Unknown huge page size '" << value << "'" << endl;
+                return 1;
+            }
+        } else if (option == "--swap-latency") {
+            options.swapLatencyNs = atoll(value.c_str());
+        } else if (option == "--swap-bandwidth") {
+            options.swapBandwidthMBps = atoll(value.c_str());
+        } else if (option == "--writeback-batch") {
+            options.writebackBatch = atoll(value.c_str());
+        } else if (option == "--prefetch") {
+            options.prefetchPages = atoll(value.c_str());
+        } else if (option == "--load-state") {
+            options.loadStatePath = value;
+        } else if (option == "--save-state") {
+            options.saveStatePath = value;
+        } else if (option == "--seed") {
+            options.seeded = true;
+            options.seed = strtoull(value.c_str(), nullptr, 0);
+        } else if (option == "--trace") {
+            tracePath = value;
+        } else if (option == "--page-size") {
+            tracePageSize = atoll(value.c_str());
+        } else if (option == "--frames") {
+            traceFrames = atoll(value.c_str());
+        } else if (option == "--snapshot") {
+            snapshotFormat = value;
+        } else if (option == "--snapshot-mode") {
+            snapshotMode = value;
+        } else if (option == "--snapshot-file") {
+            snapshotFile = value;
+        } else if (option == "--top-jobs") {
+            topJobs = atoll(value.c_str());
+        } else if (option == "--analyze-window") {
+            analyzeWindow = atoll(value.c_str());
+        } else if (option == "--analyze-depth") {
+            analyzeDepth = atoll(value.c_str());
+        } else if (option == "--compact-budget") {
+            compactBudget = atoll(value.c_str());
+        } else {
+            cout << "Error: Unknown option " << option << endl;
+            printUsage(argv[0]);
+            return 1;
         }
-        
-        // Step 3: Get actual page number from job's page list
-        int actualPageNumber = job->pages[pageNumber];
-        
-        // Step 4: Look up frame number in page table
-        auto it = pageTable.find(actualPageNumber);
-        if (it == pageTable.end()) {
-            cout << "Error: Page " << actualPageNumber << " not found in page table." << endl;
-            return false;
+    }
+    
+    if (options.tlbEntries < 0 || options.tlbWays < 0 ||
+        (options.tlbEntries > 0 && options.tlbWays > 0 && options.tlbEntries % options.tlbWays != 0)) {
+        cout << "Error: TLB entry count must be a positive multiple of its associativity" << endl;
+        return 1;
+    }
+    if (options.numaNodes < 1) {
+        cout << "Error: NUMA node count must be positive" << endl;
+        return 1;
+    }
+    if (options.pageTableLevels < 1 || options.pageTableLevels > RadixPageTable::MAX_LEVELS) {
+        cout << "Error: Page table levels must be between 1 and " << RadixPageTable::MAX_LEVELS << endl;
+        return 1;
+    }
+    if (options.swapBandwidthMBps <= 0 || options.writebackBatch <= 0 ||
+        options.writebackBatch > static_cast<long long>(MAX_FRAMES)) {
+        cout << "Error: Swap bandwidth and writeback batch must be positive" << endl;
+        return 1;
+    }
+    if (options.prefetchPages < 0 || options.prefetchPages > static_cast<long long>(SwapDevice::QUEUE_DEPTH)) {
+        cout << "Error: Prefetch window must be between 0 and " << SwapDevice::QUEUE_DEPTH << " pages" << endl;
+        return 1;
+    }
+    
+    unique_ptr<SnapshotWriter> snapshots;
+    if (!snapshotFormat.empty()) {
+        SnapshotWriter::Format format;
+        if (snapshotFormat == "text") {
+            format = SnapshotWriter::FORMAT_TEXT;
+        } else if (snapshotFormat == "json") {
+            format = SnapshotWriter::FORMAT_JSON;
+        } else if (snapshotFormat == "binary") {
+            format = SnapshotWriter::FORMAT_BINARY;
+        } else {
+            cout << "Error: Unknown snapshot format '" << snapshotFormat << "'" << endl;
+            return 1;
         }
-        
-        // Step 5: Calculate physical address
-        int frameNumber = it->second;
-        int physicalAddress = frameNumber * pageSize + offset;
-        
-        // Display comprehensive address resolution information
-        cout << "\n=== Address Resolution ===" << endl;
-        cout << "Job ID: " << jobId << endl;
-        cout << "Logical Address: " << logicalAddress << endl;
-        cout << "Page Number: " << pageNumber << endl;
-        cout << "Page Offset: " << offset << endl;
-        cout << "Actual Page Number: " << actualPageNumber << endl;
-        cout << "Frame Number: " << frameNumber << endl;
-        cout << "Physical Address: " << physicalAddress << endl;
-        
-        // Verify the translation is correct
-        cout << "Verification: Frame " << frameNumber << " * " << pageSize 
-             << " + " << offset << " = " << physicalAddress << endl;
-        
-        return true;
-    }
-    
-    /**
-     * Display comprehensive memory state information
-     * Shows frame allocation, page table, and job information
-     */
-    void displayMemoryState() {
-        cout << "\n=== Memory State ===" << endl;
-        cout << "Page Size: " << pageSize << " bytes" << endl;
-        cout << "Total Frames: " << totalFrames << endl;
-        cout << "Memory Efficiency: ";
-        
-        // Calculate memory utilization statistics
-        int usedFrames = 0;
-        for (const auto& frame : frames) {
-            if (frame.isOccupied) {
-                usedFrames++;
-            }
+        if (snapshotMode != "full" && snapshotMode != "delta") {
+            cout << "Error: Unknown snapshot mode '" << snapshotMode << "'" << endl;
+            return 1;
         }
-        
-        double utilization = (double)usedFrames / totalFrames * 100;
-        cout << usedFrames << " / " << totalFrames << " (" << fixed << setprecision(1) 
-             << utilization << "% used)" << endl;
-        
-        cout << "\nFrame Allocation:" << endl;
-        cout << setw(8) << "Frame" << setw(10) << "Job ID" << setw(12) << "Page #" << setw(8) << "Status" << endl;
-        cout << string(40, '-') << endl;
-        
-        for (const auto& frame : frames) {
-            cout << setw(8) << frame.frameNumber 
-                 << setw(10) << (frame.isOccupied ? to_string(frame.jobId) : "-")
-                 << setw(12) << (frame.isOccupied ? to_string(frame.pageNumber) : "-")
-                 << setw(8) << (frame.isOccupied ? "Used" : "Free") << endl;
+        if (topJobs < 0) {
+            cout << "Error: Top job count must not be negative" << endl;
+            return 1;
         }
         
-        cout << "\nPage Table:" << endl;
-        cout << setw(10) << "Page #" << setw(12) << "Frame #" << endl;
-        cout << string(25, '-') << endl;
-        for (const auto& entry : pageTable) {
-            cout << setw(10) << entry.first << setw(12) << entry.second << endl;
+        snapshots.reset(new SnapshotWriter(format, snapshotMode == "delta", static_cast<size_t>(topJobs)));
+        string error;
+        if (!snapshotFile.empty() && !snapshots->openFile(snapshotFile, error)) {
+            cout << "Error: " << error << endl;
+            return 1;
         }
-        
-        cout << "\nJobs:" << endl;
-        cout << setw(8) << "Job ID" << setw(15) << "Job Name" << setw(10) << "Size" 
-             << setw(15) << "Pages" << endl;
-        cout << string(50, '-') << endl;
-        for (const auto& job : jobs) {
-            cout << setw(8) << job.id 
-                 << setw(15) << job.name 
-                 << setw(10) << job.size
-                 << setw(15) << job.pages.size() << endl;
+        if (format == SnapshotWriter::FORMAT_BINARY && !snapshots->writesToFile()) {
+            cout << "Error: Binary snapshots need --snapshot-file" << endl;
+            return 1;
         }
     }
     
-    /**
-     * Remove a job and free all its allocated frames
-     * @param jobId ID of the job to remove
-     * @return true if job was successfully removed, false otherwise
-     */
-    bool removeJob(int jobId) {
-        // Input validation - reject negative job IDs
-        if (jobId <= 0) {
-            cout << "Error: Job ID must be positive. Got: " << jobId << endl;
-            return false;
-        }
-        
-        // Find the job to remove
-        auto it = find_if(jobs.begin(), jobs.end(), 
-                         [jobId](const Job& job) { return job.id == jobId; });
-        
-        if (it == jobs.end()) {
-            cout << "Error: Job ID " << jobId << " not found." << endl;
-            return false;
-        }
-        
-        Job job = *it;
-        
-        // Free all frames used by this job
-        cout << "Freeing " << job.pages.size() << " frames for job " << jobId << "..." << endl;
-        
-        for (int pageNumber : job.pages) {
-            auto pageTableIt = pageTable.find(pageNumber);
-            if (pageTableIt != pageTable.end()) {
-                int frameNumber = pageTableIt->second;
-                
-                // Mark frame as free
-                frames[frameNumber].isOccupied = false;
-                frames[frameNumber].jobId = -1;
-                frames[frameNumber].pageNumber = -1;
-                
-                // Remove from page table
-                pageTable.erase(pageTableIt);
-            }
-        }
-        
-        // Remove all pages belonging to this job
-        pages.erase(remove_if(pages.begin(), pages.end(),
-                            [jobId](const Page& page) { return page.jobId == jobId; }),
-                   pages.end());
-        
-        // Remove job from active jobs list
-        jobs.erase(it);
-        
-        cout << "Job " << jobId << " ('" << job.name << "') removed successfully." << endl;
-        cout << "Freed " << job.pages.size() << " pages and " << job.pages.size() << " frames." << endl;
-        
-        return true;
+    if (!tracePath.empty()) {
+        return runTrace(tracePath, tracePageSize, traceFrames, options, analyzeWindow, analyzeDepth,
+                        snapshots.get(), compactBudget);
     }
-};
-
-/**
- * Main function - Entry point of the program
- * Handles user interaction and menu system
- */
-int main() {
+    
     cout << "=== Paged Memory Allocation Simulator v2.0 ===" << endl;
     cout << "Fixed version with comprehensive input validation and error handling" << endl;
     cout << endl;
     
     // Get system configuration with input validation
-    int pageSize, totalFrames;
+    // (read as signed 64-bit so negative input can be reported)
+    long long pageSize, totalFrames;
     
-    // Get and validate page size
-    do {
-        cout << "Enter page size (bytes): ";
-        if (!(cin >> pageSize)) {
-            cout << "Error: Invalid input. Please enter a number." << endl;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            continue;
-        }
+    // A state image supplies its own memory size
+    MemoryImage image;
+    if (!openStateImage(options, image, pageSize, totalFrames)) return 1;
+    if (!image.isOpen()) {
+        // Get and validate page size
+        do {
+            cout << "Enter page size (bytes): ";
+            if (!(cin >> pageSize)) {
+                cout << "Error: Invalid input. Please enter a number." << endl;
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                continue;
+            }
         
-        if (pageSize <= 0) {
-            cout << "Error: Page size must be positive. Got: " << pageSize << endl;
-        } else if (pageSize > 1024 * 1024) { // 1MB limit
-            cout << "Error: Page size too large. Maximum: 1MB" << endl;
-        } else {
-            break;
-        }
-    } while (true);
-    
-    // Get and validate frame count
-    do {
-        cout << "Enter total number of page frames: ";
-        if (!(cin >> totalFrames)) {
-            cout << "Error: Invalid input. Please enter a number." << endl;
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            continue;
-        }
+            if (pageSize <= 0) {
+                cout << "Error: Page size must be positive. Got: " << pageSize << endl;
+            } else if (pageSize > MAX_PAGE_SIZE) { // 1GB limit (largest huge page)
+                cout << "Error: Page size too large. Maximum: 1GB" << endl;
+            } else {
+                break;
+            }
+        } while (true);
         
-        if (totalFrames <= 0) {
-            cout << "Error: Frame count must be positive. Got: " << totalFrames << endl;
-        } else if (totalFrames > 1000) { // Reasonable limit
-            cout << "Error: Too many frames. Maximum: 1000" << endl;
-        } else {
-            break;
-        }
-    } while (true);
+        // Get and validate frame count
+        do {
+            cout << "Enter total number of page frames: ";
+            if (!(cin >> totalFrames)) {
+                cout << "Error: Invalid input. Please enter a number." << endl;
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                continue;
+            }
+        
+            if (totalFrames <= 0) {
+                cout << "Error: Frame count must be positive. Got: " << totalFrames << endl;
+            } else if (totalFrames > static_cast<long long>(MAX_FRAMES)) { // 32-bit frame IDs
+                cout << "Error: Too many frames. Maximum: " << MAX_FRAMES << endl;
+            } else {
+                break;
+            }
+        } while (true);
+        
+    }
     
     // Initialize memory manager with validated parameters
-    PagedMemoryManager manager(pageSize, totalFrames);
+    PagedMemoryManager manager(static_cast<uint32_t>(pageSize), static_cast<FrameId>(totalFrames));
+    if (!configureManager(manager, options, image)) return 1;
+    image.close();
     
     cout << "\nSystem initialized successfully!" << endl;
-    cout << "Total memory: " << (pageSize * totalFrames) << " bytes" << endl;
+    cout << "Total memory: " << manager.getTotalMemory() << " bytes" << endl;
     
     // Main program loop
     int choice;
@@ -468,7 +949,11 @@ int main() {
         cout << "2. Resolve address" << endl;
         cout << "3. Display memory state" << endl;
         cout << "4. Remove a job" << endl;
-        cout << "5. Exit" << endl;
+        cout << "5. Show operation statistics" << endl;
+        cout << "6. Compact memory" << endl;
+        cout << "7. Fork a job" << endl;
+        cout << "8. Write to an address" << endl;
+        cout << "9. Exit" << endl;
         cout << "Enter your choice: ";
         
         // Validate menu choice input
@@ -484,7 +969,7 @@ int main() {
             case 1: {
                 // Accept new job
                 string jobName;
-                int jobSize;
+                long long jobSize;
                 
                 cout << "Enter job name: ";
                 cin.ignore(); // Clear input buffer
@@ -498,12 +983,18 @@ int main() {
                     break;
                 }
                 
-                manager.acceptJob(jobName, jobSize);
+                if (jobSize <= 0) {
+                    cout << "Error: Job size must be positive. Got: " << jobSize << " bytes" << endl;
+                    break;
+                }
+                
+                printAcceptResult(manager, manager.acceptJob(jobName, jobSize), jobSize);
                 break;
             }
             case 2: {
                 // Resolve logical address to physical address
-                int jobId, logicalAddress;
+                int jobId;
+                long long logicalAddress;
                 
                 cout << "Enter job ID: ";
                 if (!(cin >> jobId)) {
@@ -521,11 +1012,22 @@ int main() {
                     break;
                 }
                 
-                manager.resolveAddress(jobId, logicalAddress);
+                if (logicalAddress < 0) {
+                    cout << "Error: Logical address cannot be negative. Got: " << logicalAddress << endl;
+                    break;
+                }
+                
+                printTranslationResult(manager, manager.resolveAddress(jobId, logicalAddress),
+                                       jobId, logicalAddress);
                 break;
             }
             case 3: {
-                manager.displayMemoryState();
+                string error;
+                if (!snapshots) {
+                    displayMemoryState(manager);
+                } else if (!snapshots->write(manager, error)) {
+                    cout << "Error: " << error << endl;
+                }
                 break;
             }
             case 4: {
@@ -540,18 +1042,88 @@ int main() {
                     break;
                 }
                 
-                manager.removeJob(jobId);
+                printRemoveResult(manager.removeJob(jobId), jobId);
                 break;
             }
             case 5: {
+                printOperationStats(manager);
+                break;
+            }
+            case 6: {
+                long long budget;
+                
+                cout << "Enter pages to move per step: ";
+                if (!(cin >> budget) || budget <= 0 || budget > static_cast<long long>(MAX_FRAMES)) {
+                    cout << "Error: Step budget must be a positive number." << endl;
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    break;
+                }
+                
+                runCompaction(manager, static_cast<FrameId>(budget));
+                break;
+            }
+            case 7: {
+                // Fork a job copy-on-write
+                int jobId;
+                
+                cout << "Enter job ID to fork: ";
+                if (!(cin >> jobId)) {
+                    cout << "Error: Invalid job ID. Please enter a number." << endl;
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    break;
+                }
+                
+                AcceptResult result = manager.forkJob(jobId);
+                if (result.success) {
+                    cout << "Job " << jobId << " forked as job " << result.jobId << " (" << result.pagesAllocated
+                         << " pages shared copy-on-write)" << endl;
+                } else {
+                    cout << "Error: " << result.errorMessage() << endl;
+                }
+                break;
+            }
+            case 8: {
+                // Resolve an address for a write, copying a shared page first
+                int jobId;
+                long long logicalAddress;
+                
+                cout << "Enter job ID: ";
+                if (!(cin >> jobId)) {
+                    cout << "Error: Invalid job ID. Please enter a number." << endl;
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    break;
+                }
+                
+                cout << "Enter logical address: ";
+                if (!(cin >> logicalAddress)) {
+                    cout << "Error: Invalid logical address. Please enter a number." << endl;
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    break;
+                }
+                
+                if (logicalAddress < 0) {
+                    cout << "Error: Logical address cannot be negative. Got: " << logicalAddress << endl;
+                    break;
+                }
+                
+                printTranslationResult(manager, manager.resolveWrite(jobId, logicalAddress),
+                                       jobId, logicalAddress);
+                break;
+            }
+            case 9: {
                 cout << "Exiting..." << endl;
+                if (!saveStateImage(manager, options)) return 1;
                 break;
             }
             default: {
-                cout << "Invalid choice. Please enter a number between 1 and 5." << endl;
+                cout << "Invalid choice. Please enter a number between 1 and 9." << endl;
             }
         }
-    } while (choice != 5);
+    } while (choice != 9);
     
     cout << "\nThank you for using the Paged Memory Allocation Simulator!" << endl;
     cout << "Program terminated successfully." << endl;
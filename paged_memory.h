@@ -0,0 +1,2186 @@
+/**
+ * Paged Memory Allocation Library
+ * 
+ * Header-only core of the Paged Memory Allocation Simulator:
+ * - Page allocation and deallocation
+ * - Address translation (logical to physical)
+ * - Internal fragmentation calculation
+ * - Random frame allocation
+ * - Optional demand paging with pluggable page replacement
+ * - Optional 2- to 4-level page tables for sparse address spaces
+ * - Optional huge pages mixed with base pages
+ * 
+ * The manager performs no console I/O. Every operation reports its outcome
+ * through a result structure so callers (the interactive front end, load
+ * tools, benchmarks) decide what, if anything, to print.
+ */
+
+#ifndef PAGED_MEMORY_H
+#define PAGED_MEMORY_H
+
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "memory_types.h"
+#include "free_frame_pool.h"
+#include "frame_table.h"
+#include "tlb.h"
+#include "fast_random.h"
+#include "page_replacement.h"
+#include "radix_page_table.h"
+#include "object_pool.h"
+#include "memory_status.h"
+#include "memory_stats.h"
+#include "page_split.h"
+#include "swap_device.h"
+#include "memory_image.h"
+
+// Error codes written by the batch translator in place of a physical address
+// (all lie above any physical address a manager can produce)
+const Address TRANSLATION_OUT_OF_BOUNDS = ~Address(0);      // Address past the job's end
+const Address TRANSLATION_NO_SUCH_JOB = ~Address(0) - 1;    // Job ID not found
+const Address TRANSLATION_NO_MEMORY = ~Address(0) - 2;      // Fault's page-table nodes could not be allocated
+
+/**
+ * Structure to represent a job/process in the system
+ * Contains job metadata and page assignments
+ * 
+ * A job owns its page records outright (page numbers and page table), so
+ * freeing it touches only its own pages. A job's page numbers are
+ * consecutive, starting at firstPage.
+ * 
+ * With a multi-level page table the job keeps only radixTable: pages and
+ * frameTable stay empty, so its memory follows the pages it maps.
+ * 
+ * With huge pages the job's leading pages are mapped by hugeFrames (largest
+ * class first, each entry covering a whole aligned run of frames) and pages
+ * and frameTable hold only the remaining pages, from hugeCoveredPages on.
+ * 
+ * A forked job starts with a copy of its parent's page table, sharing every
+ * frame copy-on-write. Jobs related by forks are linked in a ring so that a
+ * shared frame can be handed to another sharer when its owner leaves; all
+ * of them map a shared frame at the same page index.
+ */
+struct Job {
+    int id;              // Unique job identifier
+    const std::string* name;  // Human-readable job name (interned by the manager)
+    Address size;        // Job size in bytes
+    PageId pageCount;    // Pages in the job
+    PageId firstPage;    // System-wide number of the job's page 0
+    std::vector<PageId> pages;  // Page numbers assigned to this job (flat page table only)
+    std::vector<FrameId> frameTable;  // Page table: job-relative page index -> frame number
+                                      // (INVALID_FRAME = not resident under demand paging)
+    RadixPageTable radixTable;        // Multi-level page table, when configured
+    std::vector<FrameId> hugeFrames[HUGE_PAGE_CLASSES];  // First frame of each huge page, per class
+    PageId hugeCoveredPages;          // Leading pages mapped by hugeFrames
+    int forkNext;                     // Ring of jobs forked from one another, by ID
+    int forkPrev;                     // (both the job's own ID when it was never forked)
+    PageId lastPage;                  // Sequential-access detector for swap prefetch: last page
+    uint32_t sequentialRun;           // accessed, consecutive pages accessed in order before it,
+    PageId prefetchEnd;               // and the page after the last one prefetched
+    
+    /**
+     * Call visit(pageIndex, frame) for every page that holds a frame, in
+     * page order
+     */
+    template <typename Visit>
+    void forEachResidentPage(Visit visit) const {
+        if (radixTable.levels() > 0) {
+            radixTable.forEachMapped(visit);
+            return;
+        }
+        PageId page = 0;
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+            PageId span = PageId(1) << HUGE_PAGE_SHIFTS[c];
+            for (FrameId firstFrame : hugeFrames[c]) {
+                for (PageId i = 0; i < span; i++) visit(page++, firstFrame + i);
+            }
+        }
+        for (size_t i = 0; i < frameTable.size(); i++) {
+            if (frameTable[i] != INVALID_FRAME) visit(static_cast<PageId>(hugeCoveredPages + i), frameTable[i]);
+        }
+    }
+    
+    /**
+     * Page-table entries held by the job (a huge page needs one entry)
+     */
+    size_t pageTableEntries() const {
+        if (radixTable.levels() > 0) return static_cast<size_t>(radixTable.mappedCount());
+        size_t entries = frameTable.size();
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) entries += hugeFrames[c].size();
+        return entries;
+    }
+};
+
+/**
+ * Outcome of acceptJob
+ */
+struct AcceptResult {
+    bool success;                // Whether the job was allocated
+    Status status;               // Ok, or why the operation failed
+    Diagnostic detail;           // Values behind errorMessage()
+    int jobId;                   // ID of the new job
+    PageId pagesAllocated;       // Number of pages (and frames) allocated
+    Address internalFragmentation;  // Wasted bytes in the job's last page
+    
+    // Reason for failure (empty on success), formatted on demand
+    std::string errorMessage() const { return formatDiagnostic(status, detail); }
+};
+
+/**
+ * Outcome of resolveAddress
+ */
+struct TranslationResult {
+    bool success;                // Whether the address was translated
+    Status status;               // Ok, or why the operation failed
+    Diagnostic detail;           // Values behind errorMessage()
+    PageId pageNumber;           // Job-relative page number
+    Address offset;              // Offset within the page
+    PageId actualPageNumber;     // System-wide page number
+    FrameId frameNumber;         // Physical frame holding the page
+    Address physicalAddress;     // Translated address
+    bool tlbHit;                 // Whether the TLB supplied the frame
+    bool pageFault;              // Whether the page had to be loaded (demand paging)
+    bool copiedOnWrite;          // Whether a write gave the page its own copy of a shared frame
+    int walkDepth;               // Page-table entries read (0 on a TLB hit)
+    
+    // Reason for failure (empty on success), formatted on demand
+    std::string errorMessage() const { return formatDiagnostic(status, detail); }
+};
+
+/**
+ * Outcome of removeJob
+ */
+struct RemoveResult {
+    bool success;                // Whether the job was removed
+    Status status;               // Ok, or why the operation failed
+    Diagnostic detail;           // Values behind errorMessage()
+    const std::string* jobName;  // Name of the removed job (interned; valid until the next removal)
+    PageId pagesFreed;           // Number of pages released
+    FrameId framesFreed;         // Frames returned to the free pool (fewer when some were
+                                 // not resident or are still shared with forked jobs)
+    
+    // Reason for failure (empty on success), formatted on demand
+    std::string errorMessage() const { return formatDiagnostic(status, detail); }
+};
+
+/**
+ * Outcome of one incremental compaction step
+ */
+struct CompactionStep {
+    FrameId framesMoved;         // Pages migrated by this step (at most the budget)
+    bool finished;               // Whether the pass is complete (or none was running)
+};
+
+/**
+ * Paged Memory Manager Class
+ * 
+ * Manages the entire paged memory system including:
+ * - Physical frame allocation
+ * - Logical page management
+ * - Address translation
+ * - Job lifecycle management
+ */
+class PagedMemoryManager {
+public:
+    /**
+     * How acceptJob chooses frames for a job's pages
+     */
+    enum Placement {
+        PLACEMENT_RANDOM,      // Uniformly random free frames (non-contiguous)
+        PLACEMENT_FIRST_FIT,   // Lowest run of contiguous free frames
+        PLACEMENT_BUDDY,       // Power-of-two runs, each aligned to its size
+        PLACEMENT_NUMA_LOCAL   // Random frames within one NUMA node
+    };
+    
+    /**
+     * Huge page sizes acceptJob may back jobs with (combine as bit flags)
+     */
+    enum HugePages {
+        HUGE_PAGES_NONE = 0,
+        HUGE_PAGES_1G = 1 << 0,   // Class 0: 2^18 base pages
+        HUGE_PAGES_2M = 1 << 1,   // Class 1: 2^9 base pages
+        HUGE_PAGES_ALL = HUGE_PAGES_1G | HUGE_PAGES_2M
+    };
+    
+    // In-order page accesses after which the swap prefetcher reads ahead
+    static const uint32_t SEQUENTIAL_RUN = 2;
+
+private:
+    // System configuration
+    uint32_t pageSize;   // Size of each page/frame in bytes
+    FrameId totalFrames; // Total number of physical frames available
+    
+    // Address translation path chosen from the page size at construction
+    enum PageSplitMode {
+        SPLIT_DIVIDE,    // Any page size: divide and modulo
+        SPLIT_SHIFT,     // Other power-of-two sizes: runtime shift and mask
+        SPLIT_SHIFT_4K,  // 4096-byte pages: compile-time shift by 12
+        SPLIT_SHIFT_64K  // 65536-byte pages: compile-time shift by 16
+    };
+    PageSplitMode splitMode;
+    int pageShift;       // log2(pageSize) for power-of-two page sizes
+    Placement placement; // Default placement policy for acceptJob
+    int numaNodes;       // Frames are split into this many equal NUMA nodes
+    Xoshiro256 rng;      // Frame selection; seeded once, reproducible via seedRandom
+    bool demandPaging;   // Pages get frames on first touch instead of at acceptJob
+    int pageTableLevels; // 1 = flat frameTable, 2-4 = RadixPageTable
+    int hugePages;       // HugePages flags enabled for acceptJob
+    
+    // Data structures for memory management
+    FrameTable frames;                // Physical frame metadata (occupancy bitmap + owners)
+    FreeFramePool freeFrames;         // Frames available for allocation
+    Tlb tlb;                          // Simulated TLB (disabled until configured)
+    PageReplacer replacer;            // Victim selection under demand paging
+    SwapDevice swap;                  // Backing store under demand paging (disabled until configured)
+    
+    // Active jobs/processes indexed by job ID; nodes come from jobNodes
+    typedef std::unordered_map<int, Job, std::hash<int>, std::equal_to<int>,
+                               PoolAllocator<std::pair<const int, Job>>> JobIndex;
+    BlockPool jobNodes;
+    JobIndex jobs;
+    
+    // Recycled page-list storage and interned job names, so steady-state
+    // accept/remove cycles do not allocate. A removed job's name is held
+    // until the next removal so RemoveResult::jobName stays valid.
+    PageListPool pageLists;
+    StringTable jobNames;
+    const std::string* removedName;
+    
+    // ID generators for unique identification
+    int nextJobId;       // Next available job ID
+    PageId nextPageNumber;  // Next available page number (wraps after 2^32 pages)
+    
+    // Demand paging statistics
+    uint64_t demandAccesses;  // Translations of in-bounds addresses
+    uint64_t pageFaults;      // Translations that found their page not resident
+    uint64_t evictions;       // Faults served by evicting another page
+    
+    // Page-table walk statistics
+    uint64_t translations;    // Successful translations
+    uint64_t pageWalks;       // Translations that walked the page table (TLB misses)
+    uint64_t pageTableReads;  // Page-table entries read by those walks
+    uint64_t hugeTranslations;  // Translations of pages mapped by huge pages
+    
+    // Operation counters and latency histograms (see memory_stats.h)
+    OperationStats stats;
+    
+    // Incremental compaction: frames below compactFree are known occupied
+    // and frames from compactScan up are done, inside NUMA node compactNode
+    bool compacting;
+    int compactNode;
+    FrameId compactFree;
+    FrameId compactScan;
+    uint64_t framesMigrated;  // Pages moved by compaction since construction
+    
+    // Copy-on-write statistics
+    uint64_t sharedMappings;  // Mappings of shared frames beyond their owners' (frames a full copy would add)
+    uint64_t cowCopies;       // Shared frames copied by a write
+    
+    // Scratch list of candidate frames for NUMA-local placement (reused)
+    std::vector<FrameId> candidateFrames;
+    
+    /**
+     * Give a free frame to the job's next page
+     */
+    void claimFrame(Job& job, FrameId frameNumber) {
+        freeFrames.take(frameNumber);
+        
+        PageId pageNumber = nextPageNumber++;
+        frames.occupy(frameNumber, job.id, pageNumber);
+        job.pages.push_back(pageNumber);
+        job.frameTable.push_back(frameNumber);
+    }
+    
+    /**
+     * Hand back every frame claimed so far for a job that could not be placed
+     */
+    void unclaimFrames(Job& job) {
+        for (FrameId frameNumber : job.frameTable) {
+            frames.release(frameNumber);
+            freeFrames.release(frameNumber);
+        }
+        job.pages.clear();
+        job.frameTable.clear();
+    }
+    
+    /**
+     * Random placement: a partial shuffle over the whole free pool
+     */
+    void placeRandom(Job& job, FrameId pageCount) {
+        // Randomize frame selection to prevent clustering and demonstrate
+        // non-contiguous memory allocation (key feature of paging)
+        for (FrameId i = 0; i < pageCount; i++) {
+            PageId pageNumber = nextPageNumber++;
+            FrameId frameNumber = freeFrames.takeRandom(rng);
+            frames.occupy(frameNumber, job.id, pageNumber);
+            job.pages.push_back(pageNumber);
+            job.frameTable.push_back(frameNumber);
+        }
+    }
+    
+    /**
+     * First-fit placement: the lowest run of pageCount contiguous frames
+     */
+    bool placeFirstFit(Job& job, FrameId pageCount) {
+        FrameId start = frames.findFreeRun(pageCount, 1, 0, totalFrames);
+        if (start == INVALID_FRAME) return false;
+        for (FrameId i = 0; i < pageCount; i++) claimFrame(job, start + i);
+        return true;
+    }
+    
+    /**
+     * Buddy placement: split the job into power-of-two blocks (largest
+     * first, one per set bit of pageCount) and put each block on a free run
+     * aligned to its own size
+     */
+    bool placeBuddy(Job& job, FrameId pageCount) {
+        for (int order = 31; order >= 0; order--) {
+            FrameId blockSize = FrameId(1) << order;
+            if (!(pageCount & blockSize)) continue;
+            
+            FrameId start = frames.findFreeRun(blockSize, blockSize, 0, totalFrames);
+            if (start == INVALID_FRAME) {
+                unclaimFrames(job);
+                return false;
+            }
+            for (FrameId i = 0; i < blockSize; i++) claimFrame(job, start + i);
+        }
+        return true;
+    }
+    
+    /**
+     * NUMA-local placement: random frames from one node, spilling to the
+     * following nodes in order only if the node runs out
+     * @param preferredNode Node to place on, or -1 for the node with the most free frames
+     */
+    void placeNumaLocal(Job& job, FrameId pageCount, int preferredNode) {
+        int node = preferredNode;
+        if (node < 0 || node >= numaNodes) {
+            FrameId mostFree = 0;
+            node = 0;
+            for (int n = 0; n < numaNodes; n++) {
+                FrameId nodeFree = numaNodeEnd(n) - numaNodeBegin(n)
+                                 - frames.countOccupied(numaNodeBegin(n), numaNodeEnd(n));
+                if (nodeFree > mostFree) {
+                    mostFree = nodeFree;
+                    node = n;
+                }
+            }
+        }
+        
+        FrameId remaining = pageCount;
+        for (int step = 0; step < numaNodes && remaining > 0; step++) {
+            int n = (node + step) % numaNodes;
+            FrameId begin = numaNodeBegin(n);
+            FrameId end = numaNodeEnd(n);
+            FrameId nodeFree = end - begin - frames.countOccupied(begin, end);
+            
+            // Mostly free node: sample random frames and keep the free ones,
+            // giving up after a bounded number of misses
+            if (nodeFree >= (end - begin) / 4) {
+                std::uniform_int_distribution<FrameId> pickFrame(begin, end - 1);
+                uint64_t attempts = 8 * static_cast<uint64_t>(remaining) + 64;
+                while (remaining > 0 && nodeFree > 0 && attempts-- > 0) {
+                    FrameId frameNumber = pickFrame(rng);
+                    if (frames.isOccupied(frameNumber)) continue;
+                    claimFrame(job, frameNumber);
+                    remaining--;
+                    nodeFree--;
+                }
+            }
+            if (remaining == 0 || nodeFree == 0) continue;
+            
+            candidateFrames.clear();
+            frames.collectFree(begin, end, candidateFrames);
+            
+            // Partial Fisher-Yates over the node's free frames
+            size_t available = candidateFrames.size();
+            for (size_t i = 0; i < available && remaining > 0; i++, remaining--) {
+                std::uniform_int_distribution<size_t> pick(i, available - 1);
+                std::swap(candidateFrames[i], candidateFrames[pick(rng)]);
+                claimFrame(job, candidateFrames[i]);
+            }
+        }
+    }
+    
+    /**
+     * Demand paging: reserve page numbers only; every page starts out not
+     * resident. A flat page table is sized for every page now; a radix
+     * table starts as just its root and grows as faults touch new regions.
+     */
+    void reservePages(Job& job, FrameId pageCount) {
+        if (pageTableLevels > 1) {
+            pageLists.acquire(job.radixTable.nodeStorage(), RadixPageTable::emptyEntries(pageTableLevels, pageCount));
+            job.radixTable.configure(pageTableLevels, pageCount);
+            nextPageNumber += pageCount;
+            return;
+        }
+        pageLists.acquire(job.pages, pageCount);
+        pageLists.acquire(job.frameTable, pageCount);
+        job.pages.resize(pageCount);
+        for (FrameId i = 0; i < pageCount; i++) job.pages[i] = nextPageNumber++;
+        job.frameTable.assign(pageCount, INVALID_FRAME);
+    }
+    
+    /**
+     * Back the job's leading pages with huge pages, largest class first,
+     * while a free run of frames aligned to the huge page size remains
+     * @return Pages covered (the rest need base pages)
+     */
+    PageId placeHugePages(Job& job, FrameId pageCount) {
+        PageId covered = 0;
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+            if (!(hugePages & (1 << c))) continue;
+            FrameId span = FrameId(1) << HUGE_PAGE_SHIFTS[c];
+            
+            // Smaller classes only start where larger ones left off, so the
+            // covered prefix stays aligned to every class
+            while (pageCount - covered >= span) {
+                FrameId start = frames.findFreeRun(span, span, 0, totalFrames);
+                if (start == INVALID_FRAME) break;
+                for (FrameId i = 0; i < span; i++) {
+                    freeFrames.take(start + i);
+                    frames.occupy(start + i, job.id, nextPageNumber++);
+                }
+                job.hugeFrames[c].push_back(start);
+                covered += span;
+            }
+        }
+        job.hugeCoveredPages = covered;
+        return covered;
+    }
+    
+    /**
+     * Hand back a job's huge pages
+     */
+    void releaseHugePages(Job& job) {
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+            FrameId span = FrameId(1) << HUGE_PAGE_SHIFTS[c];
+            for (FrameId start : job.hugeFrames[c]) {
+                for (FrameId i = 0; i < span; i++) {
+                    frames.release(start + i);
+                    freeFrames.release(start + i);
+                }
+            }
+            job.hugeFrames[c].clear();
+        }
+        job.hugeCoveredPages = 0;
+    }
+    
+    /**
+     * Return a job's page lists and page-table storage to the pool
+     */
+    void recyclePageLists(Job& job) {
+        pageLists.release(job.pages);
+        pageLists.release(job.frameTable);
+        pageLists.release(job.radixTable.nodeStorage());
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) pageLists.release(job.hugeFrames[c]);
+    }
+    
+    /**
+     * Rebuild a job's page table from its state image record, checking it
+     * against the job's size and the allocation settings already applied
+     * @param list The job's arrays in the page lists section
+     * @return false if the record or its arrays are inconsistent
+     */
+    bool restoreImageJob(const MemoryImageJob& record, const uint32_t* list, Job& job) {
+        uint64_t pagesNeeded = record.size / pageSize + (record.size % pageSize != 0);
+        if (record.size == 0 || record.pageCount == 0 || record.pageCount != pagesNeeded) return false;
+        job.size = record.size;
+        job.pageCount = record.pageCount;
+        job.firstPage = record.firstPage;
+        job.hugeCoveredPages = record.hugeCoveredPages;
+        job.forkNext = record.forkNext;
+        job.forkPrev = record.forkPrev;
+        job.lastPage = 0;
+        job.sequentialRun = 0;
+        job.prefetchEnd = 0;
+        
+        if (pageTableLevels > 1) {
+            if (record.radixLevels != pageTableLevels || record.pageListLength != 0 || record.frameTableLength != 0 ||
+                record.hugeCoveredPages != 0) {
+                return false;
+            }
+            for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+                if (record.hugeFrameCounts[c] != 0) return false;
+            }
+            RadixPageTable& table = job.radixTable;
+            pageLists.acquire(table.nodeStorage(), static_cast<size_t>(record.radixEntries));
+            if (!table.restore(pageTableLevels, record.pageCount, list, static_cast<size_t>(record.radixEntries),
+                               totalFrames)) {
+                return false;
+            }
+            return table.rootEntryCount() == record.radixRootEntries && table.nodeCount() == record.radixNodes &&
+                   table.mappedCount() == record.radixMapped && (demandPaging || table.mappedCount() == record.pageCount);
+        }
+        if (record.radixLevels != 0 || record.radixEntries != 0) return false;
+        
+        // Huge pages must be of configured sizes, aligned and inside memory
+        const uint32_t* pageNumbers = list;
+        const uint32_t* frameTable = pageNumbers + record.pageListLength;
+        const uint32_t* huge = frameTable + record.frameTableLength;
+        uint64_t covered = 0;
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+            FrameId span = FrameId(1) << HUGE_PAGE_SHIFTS[c];
+            if (record.hugeFrameCounts[c] > 0 && (!(hugePages & (1 << c)) || span > totalFrames)) return false;
+            for (uint32_t i = 0; i < record.hugeFrameCounts[c]; i++) {
+                if (huge[i] % span != 0 || huge[i] > totalFrames - span) return false;
+            }
+            pageLists.acquire(job.hugeFrames[c], record.hugeFrameCounts[c]);
+            job.hugeFrames[c].assign(huge, huge + record.hugeFrameCounts[c]);
+            covered += static_cast<uint64_t>(record.hugeFrameCounts[c]) << HUGE_PAGE_SHIFTS[c];
+            huge += record.hugeFrameCounts[c];
+        }
+        if (covered != record.hugeCoveredPages || covered > record.pageCount) return false;
+        
+        // The rest are base pages, numbered on from the huge pages; without
+        // demand paging every one is resident
+        PageId basePages = record.pageCount - record.hugeCoveredPages;
+        if (record.pageListLength != basePages || record.frameTableLength != basePages) return false;
+        for (PageId i = 0; i < basePages; i++) {
+            if (pageNumbers[i] != static_cast<PageId>(record.firstPage + record.hugeCoveredPages + i)) return false;
+            if (frameTable[i] == INVALID_FRAME ? !demandPaging : frameTable[i] >= totalFrames) return false;
+        }
+        pageLists.acquire(job.pages, basePages);
+        job.pages.assign(pageNumbers, pageNumbers + basePages);
+        pageLists.acquire(job.frameTable, basePages);
+        job.frameTable.assign(frameTable, frameTable + basePages);
+        return true;
+    }
+    
+    /**
+     * Check a state image's frame table, free pool and fork rings against
+     * the jobs restored from it (in ID order): every frame mapped is
+     * occupied and owned by a job that maps it at the same page index,
+     * sharers are in the owner's fork ring, share counts match the mappings
+     * and the free pool lists exactly the unoccupied frames
+     * @return false (with the reason in error) on any mismatch
+     */
+    bool checkImageFrames(const MemoryImage& image, const std::vector<Job>& restored, std::string& error) const {
+        std::vector<int> ids(restored.size());
+        for (size_t j = 0; j < restored.size(); j++) ids[j] = restored[j].id;
+        auto indexOf = [&ids](int jobId) -> size_t {
+            std::vector<int>::const_iterator it = std::lower_bound(ids.begin(), ids.end(), jobId);
+            return it != ids.end() && *it == jobId ? static_cast<size_t>(it - ids.begin()) : SIZE_MAX;
+        };
+        
+        // Fork links must pair up, so they form rings; number the rings
+        std::vector<size_t> ringOf(restored.size(), SIZE_MAX);
+        for (size_t j = 0; j < restored.size(); j++) {
+            size_t next = restored[j].forkNext == ids[j] ? j : indexOf(restored[j].forkNext);
+            size_t prev = restored[j].forkPrev == ids[j] ? j : indexOf(restored[j].forkPrev);
+            if (next == SIZE_MAX || prev == SIZE_MAX || restored[next].forkPrev != restored[j].id ||
+                restored[prev].forkNext != restored[j].id) {
+                error = "State image job " + std::to_string(restored[j].id) + " has invalid fork links";
+                return false;
+            }
+        }
+        for (size_t j = 0; j < restored.size(); j++) {
+            for (size_t k = j; ringOf[k] == SIZE_MAX; k = indexOf(restored[k].forkNext)) ringOf[k] = j;
+        }
+        
+        const uint64_t* occupancy = image.section<uint64_t>(IMAGE_FRAME_OCCUPANCY);
+        const int* owners = image.section<int>(IMAGE_FRAME_OWNERS);
+        const PageId* framePages = image.section<PageId>(IMAGE_FRAME_PAGES);
+        const uint32_t* sharers = image.count(IMAGE_FRAME_SHARERS) ? image.section<uint32_t>(IMAGE_FRAME_SHARERS) : nullptr;
+        auto occupied = [occupancy](FrameId frame) { return (occupancy[frame / 64] >> (frame % 64)) & 1; };
+        if (totalFrames % 64 != 0 && occupancy[totalFrames / 64] >> (totalFrames % 64) != 0) {
+            error = "State image marks frames beyond memory as occupied";
+            return false;
+        }
+        
+        // An owner maps a frame at the page number recorded for it, so each
+        // frame has at most one owner mapping; there must be one per occupied
+        // frame. Other mappings are sharers, counted per frame.
+        uint64_t ownerMappings = 0;
+        std::vector<uint32_t> sharerMappings(sharers ? totalFrames : 0, 0);
+        FrameId badFrame = INVALID_FRAME;
+        for (size_t j = 0; j < restored.size() && badFrame == INVALID_FRAME; j++) {
+            const Job& job = restored[j];
+            job.forEachResidentPage([&](PageId pageIndex, FrameId frameNumber) {
+                if (badFrame != INVALID_FRAME) return;
+                if (!occupied(frameNumber)) {
+                    badFrame = frameNumber;
+                    return;
+                }
+                size_t owner = owners[frameNumber] == job.id ? j : indexOf(owners[frameNumber]);
+                if (owner == SIZE_MAX || framePages[frameNumber] != static_cast<PageId>(restored[owner].firstPage + pageIndex)) {
+                    badFrame = frameNumber;
+                } else if (owner == j) {
+                    ownerMappings++;
+                } else if (sharers && ringOf[owner] == ringOf[j]) {
+                    sharerMappings[frameNumber]++;
+                } else {
+                    badFrame = frameNumber;
+                }
+            });
+        }
+        
+        uint64_t sharedTotal = 0;
+        for (FrameId f = 0; sharers && f < totalFrames && badFrame == INVALID_FRAME; f++) {
+            if (sharerMappings[f] != sharers[f] || (sharers[f] != 0 && !occupied(f))) badFrame = f;
+            sharedTotal += sharers[f];
+        }
+        if (badFrame != INVALID_FRAME) {
+            error = "State image frame " + std::to_string(badFrame) + " does not match the jobs mapping it";
+            return false;
+        }
+        if (ownerMappings != occupancyCountOccupied(occupancy, image.count(IMAGE_FRAME_OCCUPANCY))) {
+            error = "State image has occupied frames no job maps";
+            return false;
+        }
+        if (sharedTotal != image.header().sharedMappings || (demandPaging && sharedTotal != 0)) {
+            error = "State image share counts do not match its shared mappings";
+            return false;
+        }
+        
+        // The free list is a permutation of the unoccupied frames, and
+        // positions are its inverse
+        const FrameId* freeList = image.section<FrameId>(IMAGE_FREE_LIST);
+        const FrameId* positions = image.section<FrameId>(IMAGE_FREE_POSITIONS);
+        FrameId freeCount = static_cast<FrameId>(image.count(IMAGE_FREE_LIST));
+        bool valid = true;
+        for (FrameId i = 0; valid && i < freeCount; i++) {
+            valid = freeList[i] < totalFrames && !occupied(freeList[i]) && positions[freeList[i]] == i;
+        }
+        FrameId unoccupied = 0;
+        for (FrameId f = 0; valid && f < totalFrames; f++) {
+            if (occupied(f)) {
+                valid = positions[f] == INVALID_FRAME;
+            } else {
+                unoccupied++;
+            }
+        }
+        if (!valid || unoccupied != freeCount) {
+            error = "State image free list does not match its free frames";
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * First page of the page-table entry mapping a page, which is also the
+     * entry's TLB key: the page itself unless a huge page covers it
+     */
+    static PageId entryPageOf(const Job& job, PageId pageIndex) {
+        if (pageIndex >= job.hugeCoveredPages) return pageIndex;
+        PageId classBegin = 0;
+        for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+            PageId classEnd = classBegin + static_cast<PageId>(job.hugeFrames[c].size() << HUGE_PAGE_SHIFTS[c]);
+            if (pageIndex < classEnd) return pageIndex & ~((PageId(1) << HUGE_PAGE_SHIFTS[c]) - 1);
+            classBegin = classEnd;
+        }
+        return pageIndex;
+    }
+    
+    /**
+     * Read a page's frame from the job's page table, counting the walk
+     * @param depth Receives the number of page-table entries read
+     * @return Frame, or INVALID_FRAME if the page is not resident
+     */
+    FrameId walkPageTable(const Job& job, PageId pageIndex, int& depth) {
+        FrameId frameNumber;
+        if (pageTableLevels > 1) {
+            frameNumber = job.radixTable.lookup(pageIndex, depth);
+        } else if (pageIndex < job.hugeCoveredPages) {
+            // One entry per huge page; the page's frame is at its offset in the run
+            PageId classBegin = 0;
+            int c = 0;
+            while (pageIndex >= classBegin + (job.hugeFrames[c].size() << HUGE_PAGE_SHIFTS[c])) {
+                classBegin += static_cast<PageId>(job.hugeFrames[c].size() << HUGE_PAGE_SHIFTS[c]);
+                c++;
+            }
+            PageId inClass = pageIndex - classBegin;
+            frameNumber = job.hugeFrames[c][inClass >> HUGE_PAGE_SHIFTS[c]]
+                        + (inClass & ((PageId(1) << HUGE_PAGE_SHIFTS[c]) - 1));
+            depth = 1;
+            hugeTranslations++;
+        } else {
+            frameNumber = job.frameTable[pageIndex - job.hugeCoveredPages];
+            depth = 1;
+        }
+        pageWalks++;
+        pageTableReads += depth;
+        return frameNumber;
+    }
+    
+    /**
+     * Point a page-table entry at a frame (INVALID_FRAME unmaps it); a radix
+     * page must already be mapped or have had its path reserved
+     */
+    void setPageFrame(Job& job, PageId pageIndex, FrameId frameNumber) {
+        if (pageTableLevels > 1) {
+            if (frameNumber == INVALID_FRAME) job.radixTable.unmap(pageIndex);
+            else job.radixTable.map(pageIndex, frameNumber);
+        } else {
+            job.frameTable[pageIndex - job.hugeCoveredPages] = frameNumber;
+        }
+    }
+    
+    /**
+     * Make room in a radix table for the nodes mapping a page needs: when
+     * they do not fit its storage, move the table into pooled storage of
+     * twice the size (never more than the full table)
+     * @return false, leaving the table as it was, if that storage could not
+     *         be allocated
+     */
+    bool reserveRadixPath(Job& job, PageId pageIndex) noexcept {
+        std::vector<uint32_t>& storage = job.radixTable.nodeStorage();
+        size_t needed = storage.size() + job.radixTable.entriesToMap(pageIndex);
+        if (needed <= storage.capacity()) return true;
+        
+        size_t full = RadixPageTable::fullEntries(pageTableLevels, job.pageCount);
+        std::vector<uint32_t> grown;
+        try {
+            pageLists.acquire(grown, std::min(full, std::max(needed, storage.size() * 2)));
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        grown.assign(storage.begin(), storage.end());
+        pageLists.release(storage);
+        storage.swap(grown);
+        return true;
+    }
+    
+    /**
+     * Make a job's page resident: take a free frame, or evict the victim the
+     * replacement engine picks and unmap it from its owner
+     * @param pageIndex Job-relative page index
+     * @param demand Whether a page fault is being served (a prefetch is not
+     *               reported to the replacement engine as a fault)
+     * @return Frame now holding the page
+     */
+    FrameId loadPage(Job& job, PageId pageIndex, bool demand) {
+        uint64_t key = (static_cast<uint64_t>(job.id) << 32) | pageIndex;
+        if (demand) replacer.onFault(key);
+        else replacer.onPrefetch(key);
+        
+        FrameId frameNumber;
+        if (freeFrames.size() > 0) {
+            frameNumber = freeFrames.takeRandom(rng);
+        } else {
+            frameNumber = replacer.evict();
+            
+            // Page numbers within a job are consecutive, so the frame table's
+            // system-wide page number gives the owner's page index directly
+            int ownerId = frames.ownerOf(frameNumber);
+            Job& owner = jobs.find(ownerId)->second;
+            PageId ownerIndex = frames.pageOf(frameNumber) - owner.firstPage;
+            setPageFrame(owner, ownerIndex, INVALID_FRAME);
+            tlb.invalidate(ownerId, ownerIndex);
+            if (swap.enabled()) swap.evicted(frameNumber);
+            evictions++;
+        }
+        
+        frames.occupy(frameNumber, job.id, job.firstPage + pageIndex);
+        setPageFrame(job, pageIndex, frameNumber);
+        replacer.onLoad(frameNumber, key);
+        return frameNumber;
+    }
+    
+    /**
+     * Serve a page fault, waiting for the swap device to read the page
+     */
+    FrameId servePageFault(Job& job, PageId pageIndex) {
+        pageFaults++;
+        FrameId frameNumber = loadPage(job, pageIndex, true);
+        if (swap.enabled()) swap.demandRead(frameNumber);
+        return frameNumber;
+    }
+    
+    /**
+     * Sequential prefetch: once a job has touched SEQUENTIAL_RUN pages in
+     * order, read ahead up to the swap device's prefetch window beyond the
+     * page being accessed (pages already resident are skipped)
+     * 
+     * Runs before the access is served, so eviction for a prefetch can only
+     * cost the accessed page a fault, never hand out its frame.
+     */
+    void prefetchAhead(Job& job, PageId pageIndex) {
+        if (pageIndex == job.lastPage + 1) {
+            job.sequentialRun++;
+        } else if (pageIndex != job.lastPage) {
+            job.sequentialRun = 0;
+            job.prefetchEnd = 0;
+        }
+        job.lastPage = pageIndex;
+        if (job.sequentialRun < SEQUENTIAL_RUN || swap.prefetchWindow() == 0) return;
+        
+        PageId end = std::min<PageId>(job.pageCount, pageIndex + 1 + swap.prefetchWindow());
+        PageId next = std::max<PageId>(job.prefetchEnd, pageIndex + 1);
+        for (; next < end && swap.canPrefetch(); next++) {
+            if (mappedFrame(job, next) != INVALID_FRAME) continue;
+            if (pageTableLevels > 1 && !reserveRadixPath(job, next)) break;
+            swap.prefetch(loadPage(job, next, false));
+        }
+        job.prefetchEnd = next;
+    }
+    
+    /**
+     * Demand-paging frame lookup: TLB, then page table, then fault
+     * @return Frame, or INVALID_FRAME if a fault needed page-table nodes
+     *         that could not be allocated
+     */
+    FrameId demandFrame(Job& job, PageId pageIndex, bool& tlbHit, bool& pageFault, int& walkDepth) {
+        demandAccesses++;
+        if (swap.enabled()) {
+            swap.tick();
+            prefetchAhead(job, pageIndex);
+        }
+        FrameId frameNumber = INVALID_FRAME;
+        tlbHit = tlb.enabled() && tlb.lookup(job.id, pageIndex, frameNumber);
+        pageFault = false;
+        walkDepth = 0;
+        if (!tlbHit) {
+            frameNumber = walkPageTable(job, pageIndex, walkDepth);
+            if (frameNumber == INVALID_FRAME) {
+                // No fault is served (and nothing evicted) without room to map the page
+                if (pageTableLevels > 1 && !reserveRadixPath(job, pageIndex)) return INVALID_FRAME;
+                pageFault = true;
+                frameNumber = servePageFault(job, pageIndex);
+            }
+            if (tlb.enabled()) tlb.insert(job.id, pageIndex, frameNumber);
+        }
+        if (!pageFault) {
+            replacer.onAccess(frameNumber);
+            if (swap.enabled()) swap.access(frameNumber);
+        }
+        return frameNumber;
+    }
+    
+    /**
+     * Move the page in frame `from` to the free frame `to`, updating its
+     * owner's page table in place and dropping the stale TLB entry
+     * @return False if the page cannot move (it is part of a huge page, or
+     *         shared by forked jobs whose page tables are not all known here)
+     */
+    bool migratePage(FrameId from, FrameId to) {
+        int ownerId = frames.ownerOf(from);
+        Job& owner = jobs.find(ownerId)->second;
+        PageId pageNumber = frames.pageOf(from);
+        PageId pageIndex = pageNumber - owner.firstPage;
+        if (pageIndex < owner.hugeCoveredPages || frames.isShared(from)) return false;
+        
+        freeFrames.take(to);
+        frames.occupy(to, ownerId, pageNumber);
+        frames.release(from);
+        freeFrames.release(from);
+        if (demandPaging) replacer.onMove(from, to);
+        if (swap.enabled()) swap.moved(from, to);
+        setPageFrame(owner, pageIndex, to);
+        tlb.invalidate(ownerId, pageIndex);
+        framesMigrated++;
+        return true;
+    }
+    
+    /**
+     * First frame of the huge page holding frame (which must be huge-mapped)
+     */
+    FrameId hugePageStart(FrameId frameNumber) const {
+        const Job& owner = jobs.find(frames.ownerOf(frameNumber))->second;
+        PageId pageIndex = frames.pageOf(frameNumber) - owner.firstPage;
+        return frameNumber - (pageIndex - entryPageOf(owner, pageIndex));
+    }
+    
+    /**
+     * Frame a job's page table maps a page to, without counting a walk
+     */
+    FrameId mappedFrame(const Job& job, PageId pageIndex) const {
+        int depth;
+        if (pageTableLevels > 1) return job.radixTable.lookup(pageIndex, depth);
+        return job.frameTable[pageIndex - job.hugeCoveredPages];
+    }
+    
+    /**
+     * Drop a job's mapping of a shared frame; if the job owned the frame,
+     * another job in its fork ring that still maps it becomes the owner
+     */
+    void unshareFrame(const Job& job, PageId pageIndex, FrameId frameNumber) {
+        frames.unshare(frameNumber);
+        sharedMappings--;
+        if (frames.ownerOf(frameNumber) != job.id) return;
+        for (int id = job.forkNext; id != job.id;) {
+            const Job& sharer = jobs.find(id)->second;
+            if (mappedFrame(sharer, pageIndex) == frameNumber) {
+                frames.occupy(frameNumber, sharer.id, sharer.firstPage + pageIndex);
+                return;
+            }
+            id = sharer.forkNext;
+        }
+    }
+    
+    /**
+     * Give a job's page a private copy of the shared frame it maps
+     * @return The new frame, or INVALID_FRAME if no frame is free
+     */
+    FrameId copyOnWrite(Job& job, PageId pageIndex, FrameId sharedFrame) {
+        if (freeFrames.size() == 0) return INVALID_FRAME;
+        FrameId copy = freeFrames.takeRandom(rng);
+        frames.occupy(copy, job.id, job.firstPage + pageIndex);
+        unshareFrame(job, pageIndex, sharedFrame);
+        setPageFrame(job, pageIndex, copy);
+        tlb.invalidate(job.id, pageIndex);
+        cowCopies++;
+        return copy;
+    }
+    
+    /**
+     * Split a logical address with the given splitter
+     */
+    template <typename Split>
+    static void splitAddress(const Split& split, Address address, PageId& pageNumber, Address& offset) {
+        pageNumber = static_cast<PageId>(split.pageOf(address));
+        offset = split.offsetOf(address);
+    }
+    
+    /**
+     * Batch translation kernel, specialized per splitter
+     * 
+     * Every job owns at least one page, so page 0 is a safe dummy index for
+     * out-of-bounds lanes and the loop body stays branch-free.
+     */
+    template <typename Split>
+    static size_t translateBatch(const Split& split, const Job& job, const Address* logicalAddresses,
+                                 size_t count, Address* physicalAddresses) {
+        const FrameId* frameTable = job.frameTable.data();
+        const Address jobSize = job.size;
+        size_t translated = 0;
+        
+        for (size_t i = 0; i < count; i++) {
+            Address address = logicalAddresses[i];
+            bool inBounds = address < jobSize;
+            Address safeAddress = inBounds ? address : 0;
+            Address physical = split.frameBase(frameTable[split.pageOf(safeAddress)])
+                             + split.offsetOf(safeAddress);
+            physicalAddresses[i] = inBounds ? physical : TRANSLATION_OUT_OF_BOUNDS;
+            translated += inBounds;
+        }
+        
+        return translated;
+    }
+    
+    /**
+     * Scalar batch kernel used when the TLB is enabled, the page table is
+     * multi-level or the job has huge pages, so every access is counted
+     * against the TLB and the walk statistics like a single resolveAddress call
+     */
+    template <typename Split>
+    size_t translateBatchThroughTlb(const Split& split, int jobId, const Job& job,
+                                    const Address* logicalAddresses, size_t count,
+                                    Address* physicalAddresses) {
+        size_t translated = 0;
+        
+        for (size_t i = 0; i < count; i++) {
+            Address address = logicalAddresses[i];
+            if (address >= job.size) {
+                physicalAddresses[i] = TRANSLATION_OUT_OF_BOUNDS;
+                continue;
+            }
+            
+            PageId pageNumber = static_cast<PageId>(split.pageOf(address));
+            PageId entryPage = entryPageOf(job, pageNumber);
+            FrameId frameNumber;
+            if (tlb.enabled() && tlb.lookup(jobId, entryPage, frameNumber)) {
+                frameNumber += pageNumber - entryPage;
+            } else {
+                int depth;
+                frameNumber = walkPageTable(job, pageNumber, depth);
+                if (tlb.enabled()) tlb.insert(jobId, entryPage, frameNumber - (pageNumber - entryPage));
+            }
+            translations++;
+            physicalAddresses[i] = split.frameBase(frameNumber) + split.offsetOf(address);
+            translated++;
+        }
+        
+        return translated;
+    }
+    
+    /**
+     * Scalar batch kernel for demand paging: any access may fault
+     */
+    template <typename Split>
+    size_t translateBatchOnDemand(const Split& split, Job& job, const Address* logicalAddresses,
+                                  size_t count, Address* physicalAddresses) {
+        size_t translated = 0;
+        
+        for (size_t i = 0; i < count; i++) {
+            Address address = logicalAddresses[i];
+            if (address >= job.size) {
+                physicalAddresses[i] = TRANSLATION_OUT_OF_BOUNDS;
+                continue;
+            }
+            
+            bool tlbHit, pageFault;
+            int walkDepth;
+            FrameId frameNumber = demandFrame(job, static_cast<PageId>(split.pageOf(address)), tlbHit, pageFault,
+                                              walkDepth);
+            if (frameNumber == INVALID_FRAME) {
+                physicalAddresses[i] = TRANSLATION_NO_MEMORY;
+                continue;
+            }
+            translations++;
+            physicalAddresses[i] = split.frameBase(frameNumber) + split.offsetOf(address);
+            translated++;
+        }
+        
+        return translated;
+    }
+    
+    // acceptJob without the instrumentation
+    AcceptResult admitJob(const std::string& jobName, Address jobSize, Placement policy, int numaNode) {
+        AcceptResult result = {false, Status::Ok, {{0, 0, 0}, nullptr}, -1, 0, 0};
+        
+        // Input validation - reject zero job sizes
+        if (jobSize == 0) {
+            result.status = failWith(Status::InvalidSize, result.detail);
+            return result;
+        }
+        
+        // Calculate number of pages needed using ceiling division
+        // (written to avoid overflow for sizes near the 64-bit limit)
+        Address pagesNeeded = jobSize / pageSize + (jobSize % pageSize != 0);
+        
+        // Check if we have enough free frames for this job (under demand
+        // paging only the page table has to fit)
+        if (demandPaging && pagesNeeded > MAX_FRAMES) {
+            result.status = failWith(Status::TooLarge, result.detail, pagesNeeded);
+            return result;
+        }
+        if (!demandPaging && freeFrames.size() < pagesNeeded) {
+            result.status = failWith(Status::OutOfFrames, result.detail, pagesNeeded, freeFrames.size());
+            return result;
+        }
+        
+        // Create new job object with validated parameters
+        Job newJob;
+        newJob.id = nextJobId++;
+        newJob.name = jobNames.intern(jobName);
+        newJob.size = jobSize;
+        newJob.pageCount = static_cast<PageId>(pagesNeeded);
+        newJob.firstPage = nextPageNumber;
+        newJob.hugeCoveredPages = 0;
+        newJob.forkNext = newJob.id;
+        newJob.lastPage = 0;
+        newJob.sequentialRun = 0;
+        newJob.prefetchEnd = 0;
+        newJob.forkPrev = newJob.id;
+        
+        // Calculate internal fragmentation (wasted space in last page)
+        Address internalFragmentation = 0;
+        if (jobSize % pageSize != 0) {
+            // If job doesn't fill the last page completely, there's fragmentation
+            internalFragmentation = pageSize - (jobSize % pageSize);
+        }
+        
+        // Choose frames for every page; the pool holds enough frames, but
+        // contiguous policies can still fail on a fragmented memory
+        FrameId pageCount = static_cast<FrameId>(pagesNeeded);
+        PageId firstPageNumber = nextPageNumber;
+        bool placed = true;
+        if (demandPaging) {
+            reservePages(newJob, pageCount);
+        } else {
+            FrameId basePages = pageCount;
+            if (hugePages != HUGE_PAGES_NONE) {
+                for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+                    pageLists.acquire(newJob.hugeFrames[c], pageCount >> HUGE_PAGE_SHIFTS[c]);
+                }
+                basePages -= placeHugePages(newJob, pageCount);
+            }
+            
+            // Page lists are sized up front so placement never regrows them
+            pageLists.acquire(newJob.pages, basePages);
+            pageLists.acquire(newJob.frameTable, basePages);
+            if (basePages > 0) {
+                switch (policy) {
+                    case PLACEMENT_FIRST_FIT:
+                        placed = placeFirstFit(newJob, basePages);
+                        break;
+                    case PLACEMENT_BUDDY:
+                        placed = placeBuddy(newJob, basePages);
+                        break;
+                    case PLACEMENT_NUMA_LOCAL:
+                        placeNumaLocal(newJob, basePages, numaNode);
+                        break;
+                    default:
+                        placeRandom(newJob, basePages);
+                        break;
+                }
+            }
+        }
+        if (!placed) {
+            releaseHugePages(newJob);
+            recyclePageLists(newJob);
+            jobNames.release(newJob.name);
+            nextJobId--;
+            nextPageNumber = firstPageNumber;
+            result.status = failWith(Status::Fragmented, result.detail, pagesNeeded, 0, 0, placementName(policy));
+            return result;
+        }
+        
+        // A multi-level table takes over the placed frames; the flat arrays
+        // are released rather than kept alongside it
+        if (pageTableLevels > 1 && !demandPaging) {
+            pageLists.acquire(newJob.radixTable.nodeStorage(), RadixPageTable::fullEntries(pageTableLevels, pageCount));
+            newJob.radixTable.configure(pageTableLevels, pageCount);
+            for (FrameId i = 0; i < pageCount; i++) newJob.radixTable.map(i, newJob.frameTable[i]);
+            pageLists.release(newJob.pages);
+            pageLists.release(newJob.frameTable);
+        }
+        
+        // Move the job into the active jobs index (its lists are not copied)
+        int jobId = newJob.id;
+        jobs.emplace(jobId, std::move(newJob));
+        
+        result.success = true;
+        result.jobId = jobId;
+        result.pagesAllocated = static_cast<PageId>(pagesNeeded);
+        result.internalFragmentation = internalFragmentation;
+        return result;
+    }
+    
+    // forkJob without the instrumentation
+    AcceptResult cloneJob(int parentId) {
+        AcceptResult result = {false, Status::Ok, {{0, 0, 0}, nullptr}, -1, 0, 0};
+        
+        if (parentId <= 0) {
+            result.status = failWith(Status::InvalidJobId, result.detail, static_cast<uint64_t>(parentId));
+            return result;
+        }
+        auto parentIt = jobs.find(parentId);
+        if (parentIt == jobs.end()) {
+            result.status = failWith(Status::NoSuchJob, result.detail, static_cast<uint64_t>(parentId));
+            return result;
+        }
+        if (demandPaging || parentIt->second.hugeCoveredPages > 0) {
+            result.status = failWith(Status::Unsupported, result.detail, 0, 0, 0,
+                                     "Forking a demand-paged or huge-page job");
+            return result;
+        }
+        
+        const Job& parent = parentIt->second;
+        Job child;
+        child.id = nextJobId++;
+        child.name = parent.name;
+        jobNames.retain(child.name);
+        child.size = parent.size;
+        child.pageCount = parent.pageCount;
+        child.firstPage = nextPageNumber;
+        child.hugeCoveredPages = 0;
+        child.forkNext = parent.forkNext;
+        child.forkPrev = parent.id;
+        child.lastPage = 0;
+        child.sequentialRun = 0;
+        child.prefetchEnd = 0;
+        nextPageNumber += parent.pageCount;
+        
+        // Copy the page table into recycled storage; the frames are shared
+        if (pageTableLevels > 1) {
+            pageLists.acquire(child.radixTable.nodeStorage(), parent.radixTable.nodeStorage().size());
+            child.radixTable.copyFrom(parent.radixTable);
+        } else {
+            pageLists.acquire(child.pages, parent.pageCount);
+            pageLists.acquire(child.frameTable, parent.pageCount);
+            for (PageId i = 0; i < parent.pageCount; i++) child.pages.push_back(child.firstPage + i);
+            child.frameTable.assign(parent.frameTable.begin(), parent.frameTable.end());
+        }
+        parent.forEachResidentPage([this](PageId, FrameId frameNumber) {
+            frames.share(frameNumber);
+            sharedMappings++;
+        });
+        
+        // Join the parent's fork ring, just after the parent
+        int childId = child.id;
+        jobs.emplace(childId, std::move(child));
+        jobs.find(jobs.find(parentId)->second.forkNext)->second.forkPrev = childId;
+        jobs.find(parentId)->second.forkNext = childId;
+        
+        result.success = true;
+        result.jobId = childId;
+        result.pagesAllocated = parent.pageCount;
+        result.internalFragmentation = parent.size % pageSize ? pageSize - parent.size % pageSize : 0;
+        return result;
+    }
+    
+    // resolveAddress without the instrumentation
+    TranslationResult translateAddress(int jobId, Address logicalAddress) noexcept {
+        TranslationResult result = {false, Status::Ok, {{0, 0, 0}, nullptr}, 0, 0, 0, INVALID_FRAME, 0, false, false, false,
+                                     0};
+        
+        // Find the job by ID
+        auto jobIt = jobs.find(jobId);
+        if (jobIt == jobs.end()) {
+            result.status = failWith(Status::NoSuchJob, result.detail, static_cast<uint64_t>(jobId));
+            return result;
+        }
+        Job* job = &jobIt->second;
+        
+        // Check if logical address is within job bounds
+        if (logicalAddress >= job->size) {
+            result.status = failWith(Status::OutOfBounds, result.detail, logicalAddress,
+                                     static_cast<uint64_t>(jobId), job->size);
+            return result;
+        }
+        
+        // Perform address translation (logical -> physical)
+        // Step 1: Extract page number and offset from logical address
+        PageId pageNumber;
+        Address offset;
+        switch (splitMode) {
+            case SPLIT_SHIFT_4K:
+                splitAddress(FixedShiftPageSplit<12>(), logicalAddress, pageNumber, offset);
+                break;
+            case SPLIT_SHIFT_64K:
+                splitAddress(FixedShiftPageSplit<16>(), logicalAddress, pageNumber, offset);
+                break;
+            case SPLIT_SHIFT:
+                splitAddress(ShiftPageSplit(pageShift), logicalAddress, pageNumber, offset);
+                break;
+            default:
+                splitAddress(DividePageSplit(pageSize), logicalAddress, pageNumber, offset);
+                break;
+        }
+        
+        // Step 2: Validate page number is within job's page table
+        if (pageNumber >= job->pageCount) {
+            result.status = failWith(Status::OutOfBounds, result.detail, logicalAddress,
+                                     static_cast<uint64_t>(jobId), job->size);
+            return result;
+        }
+        
+        // Step 3: Look up frame number, consulting the TLB before the page table
+        // (and loading the page first if demand paging finds it not resident)
+        FrameId frameNumber;
+        bool tlbHit;
+        bool pageFault = false;
+        int walkDepth = 0;
+        if (demandPaging) {
+            frameNumber = demandFrame(*job, pageNumber, tlbHit, pageFault, walkDepth);
+            if (frameNumber == INVALID_FRAME) {
+                result.status = failWith(Status::NoMemory, result.detail, pageNumber, static_cast<uint64_t>(jobId));
+                return result;
+            }
+        } else {
+            // A huge page's TLB entry is keyed by its first page and caches its first frame
+            PageId entryPage = entryPageOf(*job, pageNumber);
+            FrameId cachedFrame = 0;
+            tlbHit = tlb.enabled() && tlb.lookup(jobId, entryPage, cachedFrame);
+            frameNumber = tlbHit ? cachedFrame + (pageNumber - entryPage) : walkPageTable(*job, pageNumber, walkDepth);
+            if (tlb.enabled() && !tlbHit) {
+                tlb.insert(jobId, entryPage, frameNumber - (pageNumber - entryPage));
+            }
+        }
+        translations++;
+        
+        // Step 4: Calculate physical address
+        result.success = true;
+        result.pageNumber = pageNumber;
+        result.offset = offset;
+        result.actualPageNumber = job->firstPage + pageNumber;
+        result.frameNumber = frameNumber;
+        result.physicalAddress = static_cast<Address>(frameNumber) * pageSize + offset;
+        result.tlbHit = tlbHit;
+        result.pageFault = pageFault;
+        result.walkDepth = walkDepth;
+        return result;
+    }
+    
+    // resolveAddresses without the instrumentation
+    size_t translateAddresses(int jobId, const Address* logicalAddresses, size_t count,
+                              Address* physicalAddresses) noexcept {
+        auto jobIt = jobs.find(jobId);
+        if (jobIt == jobs.end()) {
+            std::fill(physicalAddresses, physicalAddresses + count, TRANSLATION_NO_SUCH_JOB);
+            return 0;
+        }
+        
+        Job& job = jobIt->second;
+        if (demandPaging) {
+            switch (splitMode) {
+                case SPLIT_SHIFT_4K:
+                    return translateBatchOnDemand(FixedShiftPageSplit<12>(), job, logicalAddresses, count,
+                                                  physicalAddresses);
+                case SPLIT_SHIFT_64K:
+                    return translateBatchOnDemand(FixedShiftPageSplit<16>(), job, logicalAddresses, count,
+                                                  physicalAddresses);
+                case SPLIT_SHIFT:
+                    return translateBatchOnDemand(ShiftPageSplit(pageShift), job, logicalAddresses, count,
+                                                  physicalAddresses);
+                default:
+                    return translateBatchOnDemand(DividePageSplit(pageSize), job, logicalAddresses, count,
+                                                  physicalAddresses);
+            }
+        }
+        if (tlb.enabled() || pageTableLevels > 1 || job.hugeCoveredPages > 0) {
+            switch (splitMode) {
+                case SPLIT_SHIFT_4K:
+                    return translateBatchThroughTlb(FixedShiftPageSplit<12>(), jobId, job,
+                                                    logicalAddresses, count, physicalAddresses);
+                case SPLIT_SHIFT_64K:
+                    return translateBatchThroughTlb(FixedShiftPageSplit<16>(), jobId, job,
+                                                    logicalAddresses, count, physicalAddresses);
+                case SPLIT_SHIFT:
+                    return translateBatchThroughTlb(ShiftPageSplit(pageShift), jobId, job,
+                                                    logicalAddresses, count, physicalAddresses);
+                default:
+                    return translateBatchThroughTlb(DividePageSplit(pageSize), jobId, job,
+                                                    logicalAddresses, count, physicalAddresses);
+            }
+        }
+        
+        size_t translated;
+        switch (splitMode) {
+            case SPLIT_SHIFT_4K:
+                translated = translateBatch(FixedShiftPageSplit<12>(), job, logicalAddresses, count,
+                                            physicalAddresses);
+                break;
+            case SPLIT_SHIFT_64K:
+                translated = translateBatch(FixedShiftPageSplit<16>(), job, logicalAddresses, count,
+                                            physicalAddresses);
+                break;
+            case SPLIT_SHIFT:
+                translated = translateBatch(ShiftPageSplit(pageShift), job, logicalAddresses, count,
+                                            physicalAddresses);
+                break;
+            default:
+                translated = translateBatch(DividePageSplit(pageSize), job, logicalAddresses, count,
+                                            physicalAddresses);
+                break;
+        }
+        
+        // Each translation read one flat page-table entry
+        translations += translated;
+        pageWalks += translated;
+        pageTableReads += translated;
+        return translated;
+    }
+    
+    // removeJob without the instrumentation
+    RemoveResult releaseJob(int jobId) noexcept {
+        RemoveResult result = {false, Status::Ok, {{0, 0, 0}, nullptr}, nullptr, 0, 0};
+        
+        // Input validation - reject negative job IDs
+        if (jobId <= 0) {
+            result.status = failWith(Status::InvalidJobId, result.detail, static_cast<uint64_t>(jobId));
+            return result;
+        }
+        
+        // Find the job to remove
+        auto it = jobs.find(jobId);
+        
+        if (it == jobs.end()) {
+            result.status = failWith(Status::NoSuchJob, result.detail, static_cast<uint64_t>(jobId));
+            return result;
+        }
+        
+        Job& job = it->second;
+        
+        // Free all frames used by this job (pages never loaded or already
+        // evicted hold none)
+        FrameId framesFreed = 0;
+        job.forEachResidentPage([this, &job, &framesFreed](PageId pageIndex, FrameId frameNumber) {
+            // A frame other jobs still map stays allocated to them
+            if (frames.isShared(frameNumber)) {
+                unshareFrame(job, pageIndex, frameNumber);
+                return;
+            }
+            if (demandPaging) replacer.onFree(frameNumber);
+            if (swap.enabled()) swap.discarded(frameNumber);
+            
+            // Mark frame as free
+            frames.release(frameNumber);
+            freeFrames.release(frameNumber);
+            framesFreed++;
+        });
+        
+        // Drop the job's cached translations before its frames can be reused
+        tlb.flushJob(jobId, job.pageCount);
+        
+        result.success = true;
+        result.jobName = job.name;
+        result.pagesFreed = job.pageCount;
+        jobNames.release(removedName);
+        removedName = job.name;
+        result.framesFreed = framesFreed;
+        
+        // Leave the fork ring
+        jobs.find(job.forkPrev)->second.forkNext = job.forkNext;
+        jobs.find(job.forkNext)->second.forkPrev = job.forkPrev;
+        
+        // Keep the job's storage for the next accept, then remove it from the
+        // active jobs index (other jobs' nodes stay in place)
+        recyclePageLists(job);
+        jobs.erase(it);
+        
+        return result;
+    }
+
+public:
+    /**
+     * Constructor - Initialize the paged memory manager
+     * @param pageSize Size of each page/frame in bytes
+     * @param totalFrames Total number of physical frames
+     */
+    PagedMemoryManager(uint32_t pageSize, FrameId totalFrames)
+        : pageSize(pageSize), totalFrames(totalFrames), splitMode(SPLIT_DIVIDE),
+          pageShift(0), placement(PLACEMENT_RANDOM), numaNodes(1), rng(Xoshiro256::entropySeed()),
+          demandPaging(false), pageTableLevels(1), hugePages(HUGE_PAGES_NONE),
+          frames(totalFrames <= MAX_FRAMES ? totalFrames : 0),
+          freeFrames(totalFrames <= MAX_FRAMES ? totalFrames : 0),
+          jobs(0, std::hash<int>(), std::equal_to<int>(), JobIndex::allocator_type(&jobNodes)), removedName(nullptr), nextJobId(1), nextPageNumber(1), demandAccesses(0), pageFaults(0), evictions(0),
+          translations(0), pageWalks(0), pageTableReads(0), hugeTranslations(0),
+          compacting(false), compactNode(0), compactFree(0), compactScan(0), framesMigrated(0),
+          sharedMappings(0), cowCopies(0) {
+        
+        // Validate input parameters
+        if (pageSize == 0 || totalFrames == 0) {
+            throw std::invalid_argument("Page size and frame count must be positive");
+        }
+        if (totalFrames > MAX_FRAMES) {
+            throw std::invalid_argument("Frame count exceeds the 32-bit frame ID range");
+        }
+        
+        // Use shifts and masks when the page size is a power of two
+        if ((pageSize & (pageSize - 1)) == 0) {
+            while ((uint32_t(1) << pageShift) < pageSize) pageShift++;
+            splitMode = pageShift == 12 ? SPLIT_SHIFT_4K
+                      : pageShift == 16 ? SPLIT_SHIFT_64K
+                      : SPLIT_SHIFT;
+        }
+    }
+    
+    /**
+     * Configure the simulated TLB in front of address translation
+     * @param entryCount Total TLB entries (0 disables the TLB)
+     * @param associativity Entries per set; equal to entryCount for fully associative
+     * @param policy Replacement policy used when a set is full
+     */
+    void configureTlb(int entryCount, int associativity, Tlb::Policy policy) {
+        tlb.configure(entryCount, associativity, policy);
+    }
+    
+    /**
+     * Restart frame selection from a fixed seed so that runs with the same
+     * operations place every page identically
+     */
+    void seedRandom(uint64_t seed) { rng.seed(seed); }
+    
+    /**
+     * Choose the placement policy used by acceptJob when none is given
+     */
+    void setPlacement(Placement policy) { placement = policy; }
+    
+    /**
+     * Split physical memory into equal NUMA nodes (the last node takes any
+     * remainder); only NUMA-local placement looks at node boundaries
+     * @param nodeCount Number of nodes, 1 to the frame count
+     */
+    void configureNuma(int nodeCount) {
+        if (nodeCount < 1 || static_cast<FrameId>(nodeCount) > totalFrames) {
+            throw std::invalid_argument("NUMA node count must be between 1 and the frame count");
+        }
+        numaNodes = nodeCount;
+    }
+    
+    /**
+     * Switch to demand paging: acceptJob only reserves page numbers, and each
+     * page gets a frame the first time an address in it is translated. Once
+     * memory is full a fault evicts the page chosen by the replacement
+     * policy, so jobs together (or alone) may exceed physical memory.
+     * Placement policies do not apply; faults take random free frames.
+     * Must be chosen before any job is accepted.
+     */
+    void configureDemandPaging(PageReplacer::Policy policy) {
+        if (!jobs.empty()) {
+            throw std::invalid_argument("Demand paging must be configured before any job is accepted");
+        }
+        if (hugePages != HUGE_PAGES_NONE) {
+            throw std::invalid_argument("Demand paging cannot be combined with huge pages");
+        }
+        demandPaging = true;
+        replacer.configure(policy, totalFrames);
+        demandAccesses = 0;
+        pageFaults = 0;
+        evictions = 0;
+    }
+    
+    /**
+     * Back demand paging with a simulated swap device
+     * 
+     * Faults then wait for the device in simulated time, pages written
+     * through resolveWrite() are written back in batches when evicted, and a
+     * job touching pages in order has the next pages read ahead
+     * asynchronously. See SwapDevice for the timing model. Needs demand
+     * paging; resets the device's clock and statistics.
+     * @param latencyNs Latency of every device request
+     * @param bandwidthMBps Transfer rate in megabytes per second
+     * @param writebackBatch Dirty pages written per request
+     * @param prefetchPages Pages read ahead of a sequential stream (0 = none,
+     *                      at most SwapDevice::QUEUE_DEPTH)
+     */
+    void configureSwap(uint64_t latencyNs, uint64_t bandwidthMBps, uint32_t writebackBatch,
+                       uint32_t prefetchPages) {
+        if (!demandPaging) throw std::invalid_argument("A swap device needs demand paging");
+        swap.configure(totalFrames, pageSize, latencyNs, bandwidthMBps, writebackBatch, prefetchPages);
+    }
+    
+    /**
+     * Choose the page-table shape for jobs: 1 keeps the flat per-job frame
+     * table; 2 to 4 use a RadixPageTable whose nodes are allocated as pages
+     * are mapped. Combined with demand paging, a job's page-table memory
+     * then follows the pages it touches rather than its virtual size.
+     * Must be chosen before any job is accepted.
+     */
+    void configurePageTable(int levels) {
+        if (levels != 1 && (levels < RadixPageTable::MIN_LEVELS || levels > RadixPageTable::MAX_LEVELS)) {
+            throw std::invalid_argument("Page table levels must be 1 (flat) or between 2 and 4");
+        }
+        if (!jobs.empty()) {
+            throw std::invalid_argument("The page table must be configured before any job is accepted");
+        }
+        if (levels > 1 && hugePages != HUGE_PAGES_NONE) {
+            throw std::invalid_argument("Multi-level page tables cannot be combined with huge pages");
+        }
+        pageTableLevels = levels;
+    }
+    
+    /**
+     * Let acceptJob back jobs with huge pages: while at least a huge page of
+     * the job remains and a free run of frames aligned to that size exists,
+     * the next pages get one huge page (one page-table entry and one TLB
+     * entry for the whole run). The remainder uses the placement policy.
+     * Huge pages work with the flat page table and eager allocation only, and
+     * must be chosen before any job is accepted.
+     * @param sizes HugePages flags
+     */
+    void configureHugePages(int sizes) {
+        if (sizes & ~HUGE_PAGES_ALL) {
+            throw std::invalid_argument("Unknown huge page size");
+        }
+        if (!jobs.empty()) {
+            throw std::invalid_argument("Huge pages must be configured before any job is accepted");
+        }
+        if (sizes != HUGE_PAGES_NONE && (demandPaging || pageTableLevels > 1)) {
+            throw std::invalid_argument("Huge pages need eager allocation and a flat page table");
+        }
+        hugePages = sizes;
+    }
+    
+    /**
+     * Accept a new job and allocate memory pages for it with the default
+     * placement policy
+     * @param jobName Name of the job/process
+     * @param jobSize Size of the job in bytes
+     * @return Allocation outcome; on success includes the new job's ID
+     */
+    AcceptResult acceptJob(const std::string& jobName, Address jobSize) {
+        return acceptJob(jobName, jobSize, placement, -1);
+    }
+    
+    /**
+     * Accept a new job and allocate memory pages for it
+     * @param jobName Name of the job/process
+     * @param jobSize Size of the job in bytes
+     * @param policy How to choose the job's frames
+     * @param numaNode Node for NUMA-local placement (-1 = node with the most free frames)
+     * @return Allocation outcome; on success includes the new job's ID
+     */
+    AcceptResult acceptJob(const std::string& jobName, Address jobSize, Placement policy, int numaNode = -1) {
+        OperationStats::Stamp started = stats.start();
+        AcceptResult result = admitJob(jobName, jobSize, policy, numaNode);
+        stats.accepted(result.status, started);
+        return result;
+    }
+    
+    /**
+     * Fork a job: the new job gets a copy of the parent's page table and
+     * shares every one of its frames copy-on-write
+     * 
+     * No frames are allocated; each shared page gets its own frame the
+     * first time either job writes it through resolveWrite(). Needs eager
+     * allocation and a job without huge pages.
+     * @param parentId ID of the job to fork
+     * @return Outcome; on success includes the new job's ID, and
+     *         pagesAllocated counts its (shared) pages
+     */
+    AcceptResult forkJob(int parentId) {
+        OperationStats::Stamp started = stats.start();
+        AcceptResult result = cloneJob(parentId);
+        stats.accepted(result.status, started);
+        return result;
+    }
+    
+    /**
+     * Perform address resolution from logical to physical address
+     * 
+     * Never throws, including on failure and on page faults; the failure's
+     * message is only built by errorMessage(). The one allocation is a page
+     * fault that grows a multi-level table's node storage when no recycled
+     * array is large enough, and if it fails the result is NoMemory.
+     * @param jobId ID of the job
+     * @param logicalAddress Logical address to resolve
+     * @return Translation outcome with every intermediate step
+     */
+    TranslationResult resolveAddress(int jobId, Address logicalAddress) noexcept {
+        OperationStats::Stamp started = stats.startSampled();
+        TranslationResult result = translateAddress(jobId, logicalAddress);
+        stats.translated(result.success, result.pageFault, started);
+        return result;
+    }
+    
+    /**
+     * Resolve an address for a write
+     * 
+     * Translates like resolveAddress(); if the page's frame is shared with
+     * forked jobs, the page is first given a private copy (a free random
+     * frame) and the write goes there. Under demand paging with a swap
+     * device the page is marked dirty, so evicting it costs a writeback.
+     * Never throws, and allocates no more than resolveAddress().
+     * @return Translation outcome; copiedOnWrite is set when a copy was
+     *         made, and status is OutOfFrames if one was needed but no frame
+     *         was free
+     */
+    TranslationResult resolveWrite(int jobId, Address logicalAddress) noexcept {
+        TranslationResult result = resolveAddress(jobId, logicalAddress);
+        if (!result.success) return result;
+        if (!frames.isShared(result.frameNumber)) {
+            swap.markDirty(result.frameNumber);
+            return result;
+        }
+        
+        FrameId copy = copyOnWrite(jobs.find(jobId)->second, result.pageNumber, result.frameNumber);
+        if (copy == INVALID_FRAME) {
+            result.success = false;
+            result.status = failWith(Status::OutOfFrames, result.detail, 1, 0);
+            return result;
+        }
+        result.frameNumber = copy;
+        result.physicalAddress = static_cast<Address>(copy) * pageSize + result.offset;
+        result.copiedOnWrite = true;
+        return result;
+    }
+    
+    /**
+     * Translate a batch of logical addresses for one job
+     * 
+     * Each output slot receives the physical address, or
+     * TRANSLATION_OUT_OF_BOUNDS if the logical address is past the job's end
+     * (TRANSLATION_NO_MEMORY if its page fault could not allocate page-table
+     * nodes). If the job does not exist every slot receives
+     * TRANSLATION_NO_SUCH_JOB.
+     * Without a TLB and with a flat page table of base pages the loops are
+     * branch-free so the compiler can vectorize them; with a TLB, a
+     * multi-level table or huge pages every access is looked up and counted,
+     * and under demand paging any access may fault its page in.
+     * @param jobId ID of the job
+     * @param logicalAddresses Input array of logical addresses
+     * @param count Number of addresses to translate
+     * @param physicalAddresses Output array (at least count entries)
+     * @return Number of addresses translated successfully
+     */
+    size_t resolveAddresses(int jobId, const Address* logicalAddresses, size_t count,
+                            Address* physicalAddresses) noexcept {
+        OperationStats::Stamp started = stats.startSampled();
+        uint64_t faultsBefore = pageFaults;
+        size_t translated = translateAddresses(jobId, logicalAddresses, count, physicalAddresses);
+        stats.translatedBatch(count, translated, pageFaults - faultsBefore, started);
+        return translated;
+    }
+    
+    /**
+     * Remove a job and free all its allocated frames (never throws; its
+     * storage goes back to the manager's pools)
+     * @param jobId ID of the job to remove
+     * @return Removal outcome; on success includes the job's name and page count
+     */
+    RemoveResult removeJob(int jobId) noexcept {
+        OperationStats::Stamp started = stats.start();
+        RemoveResult result = releaseJob(jobId);
+        stats.removed(result.status, started);
+        return result;
+    }
+    
+    /**
+     * Begin a compaction pass, restarting any pass in progress
+     * 
+     * The pass slides pages from the top of each NUMA node into the lowest
+     * free frames of the same node (two fingers moving towards each other),
+     * so free frames coalesce into one run at the node's end. Pages of huge
+     * pages and frames shared after a fork stay in place. Nothing moves until compactStep() is called.
+     */
+    void startCompaction() {
+        compacting = true;
+        compactNode = 0;
+        compactFree = numaNodeBegin(0);
+        compactScan = numaNodeEnd(0);
+    }
+    
+    /**
+     * Run the compaction pass for at most budget page migrations
+     * 
+     * Each migration updates the owner's page table in place and
+     * invalidates its TLB entry, so translations may be interleaved freely
+     * with steps; the work per step is bounded by the budget plus a bitmap
+     * scan. Jobs accepted or removed between steps are handled: frames freed
+     * behind the pass are left for the next one.
+     * @param budget Maximum pages to move in this step
+     * @return Pages moved, and whether the pass has finished
+     */
+    CompactionStep compactStep(FrameId budget) noexcept {
+        CompactionStep step = {0, !compacting};
+        while (compacting && step.framesMoved < budget) {
+            FrameId to = frames.findFree(compactFree);
+            FrameId from = to == INVALID_FRAME ? INVALID_FRAME : frames.findLastOccupied(to + 1, compactScan);
+            if (to == INVALID_FRAME || to >= compactScan || from == INVALID_FRAME) {
+                // This node is compact; move on to the next one
+                if (++compactNode == numaNodes) {
+                    compacting = false;
+                    step.finished = true;
+                    break;
+                }
+                compactFree = numaNodeBegin(compactNode);
+                compactScan = numaNodeEnd(compactNode);
+                continue;
+            }
+            
+            if (migratePage(from, to)) {
+                compactFree = to + 1;
+                compactScan = from;
+                step.framesMoved++;
+            } else {
+                // Shared frames stay put; a huge page is skipped in one go
+                compactScan = frames.isShared(from) ? from : hugePageStart(from);
+            }
+        }
+        return step;
+    }
+    
+    bool compactionActive() const { return compacting; }
+    uint64_t getFramesMigrated() const { return framesMigrated; }
+    
+    /**
+     * Frames saved by copy-on-write: the extra frames eager copies of every
+     * forked job's still-shared pages would occupy
+     */
+    uint64_t getFramesSavedByCow() const { return sharedMappings; }
+    uint64_t getCowCopies() const { return cowCopies; }
+    
+    /**
+     * Histogram of runs of consecutive free frames (external fragmentation)
+     */
+    FreeRunHistogram getFreeRunHistogram() const { return frames.freeRunHistogram(); }
+    
+    /**
+     * External fragmentation: the share of free frames outside the largest
+     * free run (0 when all free memory is one run, approaching 1 as it is
+     * scattered)
+     */
+    double getExternalFragmentation() const {
+        FreeRunHistogram runs = frames.freeRunHistogram();
+        return runs.freeFrames ? 1.0 - static_cast<double>(runs.largestRun) / runs.freeFrames : 0.0;
+    }
+    
+    // Configuration and state accessors for reporting
+    uint32_t getPageSize() const { return pageSize; }
+    FrameId getTotalFrames() const { return totalFrames; }
+    FrameId getUsedFrames() const { return totalFrames - freeFrames.size(); }
+    Address getTotalMemory() const { return static_cast<Address>(pageSize) * totalFrames; }
+    size_t getJobCount() const { return jobs.size(); }
+    const FrameTable& getFrameTable() const { return frames; }
+    const Tlb& getTlb() const { return tlb; }
+    Placement getPlacement() const { return placement; }
+    int getNumaNodes() const { return numaNodes; }
+    bool demandPagingEnabled() const { return demandPaging; }
+    PageReplacer::Policy getReplacementPolicy() const { return replacer.replacementPolicy(); }
+    const PageReplacer& getReplacer() const { return replacer; }
+    uint64_t getDemandAccesses() const { return demandAccesses; }
+    uint64_t getPageFaults() const { return pageFaults; }
+    uint64_t getEvictions() const { return evictions; }
+    const SwapDevice& getSwap() const { return swap; }
+    
+    /**
+     * Fraction of demand-paged translations that faulted
+     */
+    double getPageFaultRate() const {
+        return demandAccesses ? static_cast<double>(pageFaults) / demandAccesses : 0.0;
+    }
+    
+    // Page-table shape and walk statistics
+    int getPageTableLevels() const { return pageTableLevels; }
+    uint64_t getTranslations() const { return translations; }
+    uint64_t getPageWalks() const { return pageWalks; }
+    uint64_t getPageTableReads() const { return pageTableReads; }
+    int getHugePages() const { return hugePages; }
+    uint64_t getHugeTranslations() const { return hugeTranslations; }
+    
+    /**
+     * Operation counters and latency histograms recorded since construction
+     * or the last resetOperationStats() (all zero when built with
+     * PAGED_MEMORY_STATS=0)
+     */
+    const OperationStats& getOperationStats() const { return stats; }
+    void resetOperationStats() { stats.reset(); }
+    
+    /**
+     * Page-table entries across active jobs, and the entries the same jobs
+     * would need with base pages only
+     */
+    size_t pageTableEntries(size_t& basePageEntries) const {
+        size_t entries = 0;
+        basePageEntries = 0;
+        for (const auto& entry : jobs) {
+            entries += entry.second.pageTableEntries();
+            basePageEntries += entry.second.pageCount;
+        }
+        return entries;
+    }
+    
+    /**
+     * Huge pages in use per class, across active jobs
+     */
+    size_t hugePagesInUse(int sizeClass) const {
+        size_t count = 0;
+        for (const auto& entry : jobs) count += entry.second.hugeFrames[sizeClass].size();
+        return count;
+    }
+    
+    /**
+     * Average page-table entries read per walk (TLB misses only)
+     */
+    double getAverageWalkDepth() const {
+        return pageWalks ? static_cast<double>(pageTableReads) / pageWalks : 0.0;
+    }
+    
+    /**
+     * Memory references per translation: the data access itself plus every
+     * page-table entry read on a TLB miss
+     */
+    double getMemoryRefsPerTranslation() const {
+        return translations ? static_cast<double>(translations + pageTableReads) / translations : 0.0;
+    }
+    
+    /**
+     * Memory held by page tables across all active jobs
+     * @param nodeCount Receives the number of radix nodes (0 for flat tables)
+     * @return Bytes of page-table entries
+     */
+    size_t pageTableBytes(size_t& nodeCount) const {
+        size_t bytes = 0;
+        nodeCount = 0;
+        for (const auto& entry : jobs) {
+            const Job& job = entry.second;
+            if (pageTableLevels > 1) {
+                bytes += job.radixTable.bytes();
+                nodeCount += job.radixTable.nodeCount();
+            } else {
+                bytes += job.frameTable.capacity() * sizeof(FrameId);
+                for (int c = 0; c < HUGE_PAGE_CLASSES; c++) bytes += job.hugeFrames[c].capacity() * sizeof(FrameId);
+            }
+        }
+        return bytes;
+    }
+    
+    // NUMA node boundaries: node n owns frames [numaNodeBegin(n), numaNodeEnd(n))
+    FrameId numaNodeBegin(int node) const {
+        return static_cast<FrameId>(static_cast<uint64_t>(totalFrames) * node / numaNodes);
+    }
+    FrameId numaNodeEnd(int node) const { return numaNodeBegin(node + 1); }
+    
+    /**
+     * Display name of a placement policy
+     */
+    static const char* placementName(Placement policy) {
+        switch (policy) {
+            case PLACEMENT_FIRST_FIT: return "first-fit";
+            case PLACEMENT_BUDDY: return "buddy";
+            case PLACEMENT_NUMA_LOCAL: return "numa-local";
+            default: return "random";
+        }
+    }
+    
+    /**
+     * Frames occupied or released since the previous call (see
+     * FrameTable::takeChangedFrames), for delta snapshots
+     */
+    void takeChangedFrames(std::vector<FrameId>& out) { frames.takeChangedFrames(out); }
+    
+    /**
+     * @return Up to count active jobs, largest first (ties by ID)
+     */
+    std::vector<const Job*> largestJobs(size_t count) const {
+        std::vector<const Job*> sortedJobs;
+        sortedJobs.reserve(jobs.size());
+        for (const auto& entry : jobs) {
+            sortedJobs.push_back(&entry.second);
+        }
+        if (count > sortedJobs.size()) count = sortedJobs.size();
+        std::partial_sort(sortedJobs.begin(), sortedJobs.begin() + count, sortedJobs.end(),
+                          [](const Job* a, const Job* b) { return a->size != b->size ? a->size > b->size : a->id < b->id; });
+        sortedJobs.resize(count);
+        return sortedJobs;
+    }
+    
+    /**
+     * Look up an active job
+     * @return Pointer to the job, or nullptr if no job has this ID
+     */
+    const Job* findJob(int jobId) const {
+        auto it = jobs.find(jobId);
+        return it == jobs.end() ? nullptr : &it->second;
+    }
+    
+    /**
+     * @return Active jobs in ID order (the index itself is unordered)
+     */
+    std::vector<const Job*> jobsById() const {
+        std::vector<const Job*> sortedJobs;
+        sortedJobs.reserve(jobs.size());
+        for (const auto& entry : jobs) {
+            sortedJobs.push_back(&entry.second);
+        }
+        std::sort(sortedJobs.begin(), sortedJobs.end(),
+                  [](const Job* a, const Job* b) { return a->id < b->id; });
+        return sortedJobs;
+    }
+    
+    /**
+     * Save the frame table, free pool, page tables and job table as a flat
+     * binary image (see memory_image.h) that loadState() can map back
+     * 
+     * Everything placement depends on is saved, including the free pool's
+     * order and the frame selection generator, so a restored manager places
+     * later jobs exactly as this one would. Not saved: TLB contents,
+     * replacement order, swap device state, statistics and any compaction
+     * pass in progress.
+     * @param path File to create (replaced if it exists)
+     * @param error Receives the reason on failure
+     * @return true if the whole image was written
+     */
+    bool saveState(const std::string& path, std::string& error) const {
+        MemoryImageWriter writer;
+        if (!writer.create(path, error)) return false;
+        
+        writer.beginSection(IMAGE_FRAME_OCCUPANCY);
+        writer.append(frames.occupancyWords(), frames.wordCount());
+        writer.beginSection(IMAGE_FRAME_OWNERS);
+        writer.append(frames.ownerData(), totalFrames);
+        writer.beginSection(IMAGE_FRAME_PAGES);
+        writer.append(frames.pageData(), totalFrames);
+        writer.beginSection(IMAGE_FRAME_SHARERS);
+        writer.append(frames.shareCounts().data(), frames.shareCounts().size());
+        writer.beginSection(IMAGE_FREE_LIST);
+        writer.append(freeFrames.freeData(), freeFrames.size());
+        writer.beginSection(IMAGE_FREE_POSITIONS);
+        writer.append(freeFrames.positionData(), totalFrames);
+        
+        // Job records first, with their arrays' offsets; the arrays and
+        // names follow in the same order
+        std::vector<const Job*> sortedJobs = jobsById();
+        writer.beginSection(IMAGE_JOBS);
+        uint64_t listOffset = 0;
+        uint64_t nameOffset = 0;
+        for (const Job* job : sortedJobs) {
+            MemoryImageJob record;
+            std::memset(&record, 0, sizeof(record));
+            record.id = job->id;
+            record.pageCount = job->pageCount;
+            record.size = job->size;
+            record.firstPage = job->firstPage;
+            record.hugeCoveredPages = job->hugeCoveredPages;
+            record.forkNext = job->forkNext;
+            record.forkPrev = job->forkPrev;
+            record.nameOffset = static_cast<uint32_t>(nameOffset);
+            record.nameLength = static_cast<uint32_t>(job->name->size());
+            record.listOffset = listOffset;
+            record.pageListLength = static_cast<uint32_t>(job->pages.size());
+            record.frameTableLength = static_cast<uint32_t>(job->frameTable.size());
+            record.radixEntries = job->radixTable.nodeStorage().size();
+            for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+                record.hugeFrameCounts[c] = static_cast<uint32_t>(job->hugeFrames[c].size());
+                listOffset += job->hugeFrames[c].size();
+            }
+            record.radixLevels = job->radixTable.levels();
+            record.radixRootEntries = job->radixTable.rootEntryCount();
+            record.radixNodes = job->radixTable.nodeCount();
+            record.radixMapped = job->radixTable.mappedCount();
+            listOffset += record.pageListLength + record.frameTableLength + record.radixEntries;
+            nameOffset += record.nameLength;
+            writer.append(&record, 1);
+        }
+        writer.beginSection(IMAGE_PAGE_LISTS);
+        for (const Job* job : sortedJobs) {
+            writer.append(job->pages.data(), job->pages.size());
+            writer.append(job->frameTable.data(), job->frameTable.size());
+            writer.append(job->radixTable.nodeStorage().data(), job->radixTable.nodeStorage().size());
+            for (int c = 0; c < HUGE_PAGE_CLASSES; c++) {
+                writer.append(job->hugeFrames[c].data(), job->hugeFrames[c].size());
+            }
+        }
+        writer.beginSection(IMAGE_NAMES);
+        for (const Job* job : sortedJobs) writer.append(job->name->data(), job->name->size());
+        
+        MemoryImageHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.pageSize = pageSize;
+        header.totalFrames = totalFrames;
+        header.placement = placement;
+        header.numaNodes = numaNodes;
+        header.replacement = demandPaging ? replacer.replacementPolicy() : -1;
+        header.pageTableLevels = pageTableLevels;
+        header.hugePages = hugePages;
+        header.nextJobId = nextJobId;
+        header.nextPageNumber = nextPageNumber;
+        header.sharedMappings = sharedMappings;
+        std::memcpy(header.rngState, rng.stateWords(), sizeof(header.rngState));
+        return writer.finish(header, path, error);
+    }
+    
+    /**
+     * Restore the state saved in an image into this manager
+     * 
+     * The manager must have the image's page size and frame count and must
+     * never have accepted a job; the image's placement, NUMA, demand-paging,
+     * page-table and huge-page settings replace its own (the TLB keeps its
+     * configuration). This is a copying loader: each array is copied from
+     * the mapping in one piece, names are interned and every job is inserted
+     * into the job index, so it allocates in proportion to the state. Under
+     * demand paging resident pages re-enter the replacement order in job and
+     * page order. A swap device may be configured afterwards.
+     * 
+     * Nothing in the image is trusted: each job's page table is checked
+     * against its size and the settings, frames against the jobs mapping
+     * them, and the free pool and fork rings for consistency, before the
+     * manager takes any of it; a rejected image leaves the manager as it was,
+     * settings included.
+     * @param image Mapped image (MemoryImage::open)
+     * @param error Receives the reason on failure
+     * @return Whether the state was restored
+     */
+    bool loadState(const MemoryImage& image, std::string& error) {
+        const MemoryImageHeader& header = image.header();
+        if (header.pageSize != pageSize || header.totalFrames != totalFrames) {
+            error = "State image holds " + std::to_string(header.totalFrames) + " frames of "
+                  + std::to_string(header.pageSize) + " bytes, not " + std::to_string(totalFrames)
+                  + " frames of " + std::to_string(pageSize) + " bytes";
+            return false;
+        }
+        if (nextJobId != 1 || swap.enabled()) {
+            error = "State can only be loaded into a new manager, before a swap device is configured";
+            return false;
+        }
+        
+        // Section sizes must match this geometry before anything is copied
+        uint64_t jobCount = image.count(IMAGE_JOBS);
+        uint64_t listEntries = image.count(IMAGE_PAGE_LISTS);
+        uint64_t nameBytes = image.count(IMAGE_NAMES);
+        bool valid = image.count(IMAGE_FRAME_OCCUPANCY) == frames.wordCount() &&
+                     image.count(IMAGE_FRAME_OWNERS) == totalFrames &&
+                     image.count(IMAGE_FRAME_PAGES) == totalFrames &&
+                     (image.count(IMAGE_FRAME_SHARERS) == 0 || image.count(IMAGE_FRAME_SHARERS) == totalFrames) &&
+                     image.count(IMAGE_FREE_LIST) <= totalFrames &&
+                     image.count(IMAGE_FREE_POSITIONS) == totalFrames &&
+                     header.placement >= PLACEMENT_RANDOM && header.placement <= PLACEMENT_NUMA_LOCAL &&
+                     header.replacement >= -1 && header.replacement <= PageReplacer::POLICY_ARC &&
+                     header.nextJobId > 0;
+        const MemoryImageJob* records = image.section<MemoryImageJob>(IMAGE_JOBS);
+        int previousId = 0;
+        for (uint64_t j = 0; valid && j < jobCount; j++) {
+            const MemoryImageJob& record = records[j];
+            uint64_t entries = static_cast<uint64_t>(record.pageListLength) + record.frameTableLength;
+            for (int c = 0; c < HUGE_PAGE_CLASSES; c++) entries += record.hugeFrameCounts[c];
+            valid = record.id > previousId && record.id < header.nextJobId &&
+                    record.listOffset <= listEntries && record.radixEntries <= listEntries &&
+                    entries + record.radixEntries <= listEntries - record.listOffset &&
+                    static_cast<uint64_t>(record.nameOffset) + record.nameLength <= nameBytes;
+            previousId = record.id;
+        }
+        if (!valid) {
+            error = "State image sections do not match its header";
+            return false;
+        }
+        
+        // Restoring the jobs needs the image's settings in place; a rejected
+        // image puts this manager's own settings back
+        const int ownNumaNodes = numaNodes;
+        const Placement ownPlacement = placement;
+        const int ownPageTableLevels = pageTableLevels;
+        const int ownHugePages = hugePages;
+        const bool ownDemandPaging = demandPaging;
+        const PageReplacer::Policy ownReplacement = replacer.replacementPolicy();
+        auto restoreSettings = [&]() {
+            numaNodes = ownNumaNodes;
+            placement = ownPlacement;
+            pageTableLevels = ownPageTableLevels;
+            hugePages = ownHugePages;
+            if (demandPaging && !ownDemandPaging) replacer = PageReplacer();
+            else if (demandPaging) replacer.configure(ownReplacement, totalFrames);
+            demandPaging = ownDemandPaging;
+        };
+        
+        try {
+            configureNuma(header.numaNodes);
+            setPlacement(static_cast<Placement>(header.placement));
+            configurePageTable(header.pageTableLevels);
+            configureHugePages(header.hugePages);
+            if (header.replacement >= 0) {
+                configureDemandPaging(static_cast<PageReplacer::Policy>(header.replacement));
+            }
+        } catch (const std::invalid_argument& e) {
+            restoreSettings();
+            error = std::string("State image settings rejected: ") + e.what();
+            return false;
+        }
+        
+        // Rebuild and check every job before the manager takes any of them
+        const uint32_t* lists = image.section<uint32_t>(IMAGE_PAGE_LISTS);
+        const char* names = image.section<char>(IMAGE_NAMES);
+        std::vector<Job> restored(static_cast<size_t>(jobCount));
+        for (uint64_t j = 0; valid && j < jobCount; j++) {
+            Job& job = restored[j];
+            job.id = records[j].id;
+            job.name = nullptr;
+            valid = restoreImageJob(records[j], lists + records[j].listOffset, job);
+            if (!valid) error = "State image job " + std::to_string(job.id) + " has an invalid page table";
+        }
+        if (valid) valid = checkImageFrames(image, restored, error);
+        if (!valid) {
+            for (size_t j = 0; j < restored.size(); j++) recyclePageLists(restored[j]);
+            restoreSettings();
+            return false;
+        }
+        
+        frames.restore(image.section<uint64_t>(IMAGE_FRAME_OCCUPANCY), image.section<int>(IMAGE_FRAME_OWNERS),
+                       image.section<PageId>(IMAGE_FRAME_PAGES),
+                       image.count(IMAGE_FRAME_SHARERS) ? image.section<uint32_t>(IMAGE_FRAME_SHARERS) : nullptr);
+        freeFrames.restore(image.section<FrameId>(IMAGE_FREE_LIST), static_cast<FrameId>(image.count(IMAGE_FREE_LIST)),
+                           image.section<FrameId>(IMAGE_FREE_POSITIONS));
+        
+        jobs.reserve(static_cast<size_t>(jobCount));
+        for (uint64_t j = 0; j < jobCount; j++) {
+            Job& job = restored[j];
+            job.name = jobNames.intern(std::string(names + records[j].nameOffset, records[j].nameLength));
+            if (demandPaging) {
+                job.forEachResidentPage([this, &job](PageId pageIndex, FrameId frameNumber) {
+                    replacer.onLoad(frameNumber, (static_cast<uint64_t>(job.id) << 32) | pageIndex);
+                });
+            }
+            jobs.emplace(job.id, std::move(job));
+        }
+        
+        nextJobId = header.nextJobId;
+        nextPageNumber = header.nextPageNumber;
+        sharedMappings = header.sharedMappings;
+        rng.restoreState(header.rngState);
+        return true;
+    }
+};
+
+#endif // PAGED_MEMORY_H
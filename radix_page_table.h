@@ -0,0 +1,299 @@
+/**
+ * Multi-Level Page Table
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef RADIX_PAGE_TABLE_H
+#define RADIX_PAGE_TABLE_H
+
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#include "memory_types.h"
+
+/**
+ * Radix page table with 2 to 4 levels and lazily allocated inner nodes
+ * 
+ * Below the root every node holds 512 entries (9 index bits, as on x86-64),
+ * so four levels span 2^36 pages. The root is sized to the job: it holds
+ * just enough entries for the job's page count, like a page-table base that
+ * only covers the address space in use. Inner entries hold the index of a
+ * child node (0 = absent; the root is node 0 and never a child) and leaf
+ * entries hold frame numbers. A node is allocated the first time a page
+ * under it is mapped, so memory in use follows the pages actually touched
+ * rather than the virtual size. Nodes are kept when their pages are
+ * unmapped. Nodes are carved out of the storage's spare capacity and the
+ * storage never grows by itself: the owner checks entriesToMap() before
+ * mapping and hands in larger storage when the nodes would not fit.
+ * 
+ * All nodes live in one pool vector, addressed by entry offset, so the table
+ * copies and moves like a value and walks touch no allocator structures.
+ */
+class RadixPageTable {
+public:
+    static const int NODE_BITS = 9;
+    static const uint32_t NODE_ENTRIES = 1u << NODE_BITS;
+    static const int MIN_LEVELS = 2;
+    static const int MAX_LEVELS = 4;
+
+private:
+    std::vector<uint32_t> pool;     // Root entries, then NODE_ENTRIES per allocated node
+    int levelCount;                 // 0 when unconfigured
+    uint32_t rootEntries;
+    size_t nodes;                   // Allocated nodes, root included
+    uint64_t mapped;                // Leaf entries holding a frame
+    
+    // Entry offset of a node's first entry (node 0 is the root)
+    static size_t nodeBase(uint32_t node) { return static_cast<size_t>(node) * NODE_ENTRIES; }
+    
+    // Index bits consumed by level `level` (0 = root)
+    int shiftOf(int level) const { return NODE_BITS * (levelCount - 1 - level); }
+    
+    uint32_t slotOf(PageId page, int level) const {
+        uint32_t slot = static_cast<uint32_t>(static_cast<uint64_t>(page) >> shiftOf(level));
+        return level == 0 ? slot : slot & (NODE_ENTRIES - 1);
+    }
+    
+    // Root entries needed to cover pageCount pages
+    static uint32_t rootEntriesFor(int levels, uint64_t pageCount) {
+        uint64_t perRootEntry = uint64_t(1) << (NODE_BITS * (levels - 1));
+        uint32_t entries = static_cast<uint32_t>((pageCount + perRootEntry - 1) / perRootEntry);
+        return entries == 0 ? 1 : entries;
+    }
+    
+    // The root's region is rounded up to whole nodes so child n starts at n * NODE_ENTRIES
+    static size_t rootRegion(uint32_t entries) {
+        return (static_cast<size_t>(entries) + NODE_ENTRIES - 1) / NODE_ENTRIES * NODE_ENTRIES;
+    }
+    
+    // Take a node from the spare capacity, which the caller has checked
+    uint32_t allocateNode(bool leaf) noexcept {
+        // Node n occupies entries [n * NODE_ENTRIES, (n + 1) * NODE_ENTRIES)
+        uint32_t node = static_cast<uint32_t>(pool.size() / NODE_ENTRIES);
+        pool.resize(pool.size() + NODE_ENTRIES, leaf ? INVALID_FRAME : 0);
+        nodes++;
+        return node;
+    }
+    
+    template <typename Visit>
+    void visitNode(uint32_t node, int level, uint64_t firstPage, Visit& visit) const {
+        size_t base = nodeBase(node);
+        uint32_t entries = level == 0 ? rootEntries : NODE_ENTRIES;
+        bool leaf = level == levelCount - 1;
+        for (uint32_t slot = 0; slot < entries; slot++) {
+            uint32_t entry = pool[base + slot];
+            uint64_t page = firstPage + (static_cast<uint64_t>(slot) << shiftOf(level));
+            if (leaf) {
+                if (entry != INVALID_FRAME) visit(static_cast<PageId>(page), entry);
+            } else if (entry != 0) {
+                visitNode(entry, level + 1, page, visit);
+            }
+        }
+    }
+    
+    // Validate a restored node and everything below it, counting mapped leaves
+    bool checkNode(uint32_t node, int level, uint64_t firstPage, uint64_t pageCount, FrameId frameLimit,
+                   size_t rootNodes, std::vector<bool>& linked) {
+        size_t base = nodeBase(node);
+        uint32_t entries = level == 0 ? rootEntries : NODE_ENTRIES;
+        bool leaf = level == levelCount - 1;
+        for (uint32_t slot = 0; slot < entries; slot++) {
+            uint32_t entry = pool[base + slot];
+            uint64_t page = firstPage + (static_cast<uint64_t>(slot) << shiftOf(level));
+            if (leaf) {
+                if (entry == INVALID_FRAME) continue;
+                if (entry >= frameLimit || page >= pageCount) return false;
+                mapped++;
+            } else if (entry != 0) {
+                if (entry < rootNodes || entry >= linked.size() || linked[entry]) return false;
+                linked[entry] = true;
+                if (!checkNode(entry, level + 1, page, pageCount, frameLimit, rootNodes, linked)) return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    RadixPageTable() : levelCount(0), rootEntries(0), nodes(0), mapped(0) {}
+    
+    /**
+     * Reset to an empty table covering pageCount pages
+     * @param levels Levels from the root to the leaves (2 to 4)
+     */
+    void configure(int levels, uint64_t pageCount) {
+        if (levels < MIN_LEVELS || levels > MAX_LEVELS) {
+            throw std::invalid_argument("Page table levels must be between 2 and 4");
+        }
+        levelCount = levels;
+        rootEntries = rootEntriesFor(levels, pageCount);
+        pool.assign(rootRegion(rootEntries), 0);
+        nodes = 1;
+        mapped = 0;
+    }
+    
+    /**
+     * Node storage entries an empty table of pageCount pages holds (its root)
+     */
+    static size_t emptyEntries(int levels, uint64_t pageCount) {
+        if (levels < MIN_LEVELS || levels > MAX_LEVELS) return 0;
+        return rootRegion(rootEntriesFor(levels, pageCount));
+    }
+    
+    /**
+     * Node storage entries a table of pageCount pages holds once every page
+     * is mapped, the most it can ever need
+     */
+    static size_t fullEntries(int levels, uint64_t pageCount) {
+        if (levels < MIN_LEVELS || levels > MAX_LEVELS) return 0;
+        size_t entries = rootRegion(rootEntriesFor(levels, pageCount));
+        for (int level = 1; level < levels; level++) {
+            uint64_t perNode = uint64_t(1) << (NODE_BITS * (levels - level));
+            entries += static_cast<size_t>((pageCount + perNode - 1) / perNode) * NODE_ENTRIES;
+        }
+        return entries;
+    }
+    
+    int levels() const { return levelCount; }
+    uint32_t rootEntryCount() const { return rootEntries; }
+    
+    /**
+     * Node storage, so an owner can hand in recycled capacity before
+     * configure and take it back when the table is discarded
+     */
+    std::vector<uint32_t>& nodeStorage() { return pool; }
+    const std::vector<uint32_t>& nodeStorage() const { return pool; }
+    
+    /**
+     * Become a copy of another table, reusing this table's node storage
+     * (hand in capacity for other's nodes first to avoid growing it)
+     */
+    void copyFrom(const RadixPageTable& other) {
+        pool.assign(other.pool.begin(), other.pool.end());
+        levelCount = other.levelCount;
+        rootEntries = other.rootEntries;
+        nodes = other.nodes;
+        mapped = other.mapped;
+    }
+    
+    /**
+     * Take over saved node storage, checking that it forms a table of
+     * pageCount pages: each child index names a node of the storage, every
+     * node is linked exactly once, and each mapped leaf entry holds a frame
+     * below frameLimit for a page below pageCount. Hand in capacity first
+     * to avoid growing the storage.
+     * @return false if the entries do not form such a table (the table is
+     *         then left empty)
+     */
+    bool restore(int levels, uint64_t pageCount, const uint32_t* entries, size_t entryCount, FrameId frameLimit) {
+        if (levels < MIN_LEVELS || levels > MAX_LEVELS) return false;
+        configure(levels, pageCount);
+        size_t rootNodes = pool.size() / NODE_ENTRIES;
+        if (entryCount < pool.size() || entryCount % NODE_ENTRIES != 0 || entryCount > fullEntries(levels, pageCount)) {
+            return false;
+        }
+        
+        pool.assign(entries, entries + entryCount);
+        std::vector<bool> linked(entryCount / NODE_ENTRIES, false);
+        bool valid = checkNode(0, 0, 0, pageCount, frameLimit, rootNodes, linked);
+        for (size_t node = rootNodes; valid && node < linked.size(); node++) valid = linked[node];
+        if (!valid) {
+            configure(levels, pageCount);
+            return false;
+        }
+        nodes = 1 + linked.size() - rootNodes;
+        return true;
+    }
+    
+    /**
+     * Walk to a page's frame
+     * @param depth Receives the number of table entries read (levels walked
+     *              before reaching the leaf or a missing node)
+     * @return Frame, or INVALID_FRAME if the page is not mapped
+     */
+    FrameId lookup(PageId page, int& depth) const {
+        uint32_t node = 0;
+        for (int level = 0; level < levelCount; level++) {
+            uint32_t entry = pool[nodeBase(node) + slotOf(page, level)];
+            if (level == levelCount - 1) {
+                depth = levelCount;
+                return entry;
+            }
+            if (entry == 0) {
+                depth = level + 1;
+                return INVALID_FRAME;
+            }
+            node = entry;
+        }
+        depth = 0;
+        return INVALID_FRAME;
+    }
+    
+    /**
+     * Node storage entries that mapping a page would add: one node per
+     * missing node on its path (0 once the page's leaf node exists)
+     */
+    size_t entriesToMap(PageId page) const {
+        uint32_t node = 0;
+        for (int level = 0; level < levelCount - 1; level++) {
+            node = pool[nodeBase(node) + slotOf(page, level)];
+            if (node == 0) return static_cast<size_t>(levelCount - 1 - level) * NODE_ENTRIES;
+        }
+        return 0;
+    }
+    
+    /**
+     * Map a page to a frame, allocating any missing nodes on its path from
+     * the storage's spare capacity
+     * @return false, leaving the table unchanged, if those nodes do not fit
+     *         the capacity (see entriesToMap())
+     */
+    bool map(PageId page, FrameId frame) noexcept {
+        if (pool.size() + entriesToMap(page) > pool.capacity()) return false;
+        uint32_t node = 0;
+        for (int level = 0; level < levelCount - 1; level++) {
+            size_t entry = nodeBase(node) + slotOf(page, level);
+            if (pool[entry] == 0) {
+                uint32_t child = allocateNode(level + 1 == levelCount - 1);
+                pool[entry] = child;
+            }
+            node = pool[entry];
+        }
+        uint32_t& leaf = pool[nodeBase(node) + slotOf(page, levelCount - 1)];
+        mapped += leaf == INVALID_FRAME;
+        leaf = frame;
+        return true;
+    }
+    
+    /**
+     * Remove a page's mapping (a no-op if it is not mapped)
+     */
+    void unmap(PageId page) {
+        uint32_t node = 0;
+        for (int level = 0; level < levelCount - 1; level++) {
+            node = pool[nodeBase(node) + slotOf(page, level)];
+            if (node == 0) return;
+        }
+        uint32_t& leaf = pool[nodeBase(node) + slotOf(page, levelCount - 1)];
+        mapped -= leaf != INVALID_FRAME;
+        leaf = INVALID_FRAME;
+    }
+    
+    /**
+     * Call visit(pageIndex, frame) for every mapped page in ascending order
+     */
+    template <typename Visit>
+    void forEachMapped(Visit visit) const {
+        if (levelCount > 0) visitNode(0, 0, 0, visit);
+    }
+    
+    size_t nodeCount() const { return nodes; }
+    uint64_t mappedCount() const { return mapped; }
+    
+    // Storage held, spare capacity included
+    size_t bytes() const { return pool.capacity() * sizeof(uint32_t); }
+};
+
+#endif // RADIX_PAGE_TABLE_H
@@ -0,0 +1,180 @@
+/**
+ * Sharded Free Frame Pool
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef SHARDED_FRAME_POOL_H
+#define SHARDED_FRAME_POOL_H
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "memory_types.h"
+#include "free_frame_pool.h"
+#include "fast_random.h"
+
+/**
+ * Free frames split into per-thread shards in front of a global pool
+ * 
+ * Modelled on tcmalloc/jemalloc arenas: each allocating thread works out of
+ * its own shard, refilling it from the global pool a batch at a time and
+ * stealing from neighbouring shards once the global pool is empty. Frames
+ * moved into a shard are drawn at random from the global pool and handed out
+ * at random from the shard, so placement stays non-contiguous per shard.
+ * 
+ * A take either succeeds completely or fails without touching any shard:
+ * frames are first reserved against an atomic count of free frames, so a
+ * successful reservation guarantees enough frames exist somewhere.
+ * 
+ * Lock order is shard before global, and a thread never holds two shard locks.
+ */
+class ShardedFramePool {
+public:
+    static const size_t DEFAULT_BATCH = 64;
+
+private:
+    struct Shard {
+        std::mutex lock;
+        std::vector<FrameId> frames;      // Free frames cached by this shard
+        Xoshiro256 rng;                   // Per-shard so placement needs no shared state
+        char padding[64];                 // Keep neighbouring shards off one cache line
+    };
+    
+    std::mutex globalLock;
+    FreeFramePool global;                 // Guarded by globalLock
+    Xoshiro256 globalRng;                 // Guarded by globalLock
+    std::unique_ptr<Shard[]> shards;
+    int shardCount;
+    size_t batchSize;
+    std::atomic<int64_t> available;       // Free frames not yet reserved by a take
+    
+    ShardedFramePool(const ShardedFramePool&);
+    ShardedFramePool& operator=(const ShardedFramePool&);
+    
+    /**
+     * Hand out up to count random frames from a locked shard
+     */
+    static size_t takeFromShard(Shard& shard, size_t count, FrameId* out) {
+        size_t taken = 0;
+        while (taken < count && !shard.frames.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, shard.frames.size() - 1);
+            size_t slot = pick(shard.rng);
+            out[taken++] = shard.frames[slot];
+            shard.frames[slot] = shard.frames.back();
+            shard.frames.pop_back();
+        }
+        return taken;
+    }
+    
+    /**
+     * Move at least want frames (one batch minimum) from the global pool
+     * into a locked shard
+     */
+    void refill(Shard& shard, size_t want) {
+        std::lock_guard<std::mutex> guard(globalLock);
+        size_t moving = want > batchSize ? want : batchSize;
+        if (moving > global.size()) moving = global.size();
+        for (size_t i = 0; i < moving; i++) {
+            shard.frames.push_back(global.takeRandom(globalRng));
+        }
+    }
+
+public:
+    /**
+     * Constructor - Start with every frame in the global pool
+     * @param totalFrames Total number of physical frames
+     * @param shardCount Number of shards (at least 1)
+     * @param batchSize Frames moved per refill or flush
+     */
+    ShardedFramePool(FrameId totalFrames, int shardCount, size_t batchSize = DEFAULT_BATCH)
+        : global(totalFrames), shards(new Shard[shardCount > 0 ? shardCount : 1]),
+          shardCount(shardCount > 0 ? shardCount : 1), batchSize(batchSize > 0 ? batchSize : 1),
+          available(totalFrames) {
+        seed(Xoshiro256::entropySeed());
+    }
+    
+    /**
+     * Reseed the global pool and every shard from one seed (each gets its
+     * own stream); not safe while other threads are taking frames
+     */
+    void seed(uint64_t seedValue) {
+        Xoshiro256 seeds(seedValue);
+        globalRng.seed(seeds());
+        for (int i = 0; i < shardCount; i++) shards[i].rng.seed(seeds());
+    }
+    
+    int getShardCount() const { return shardCount; }
+    
+    /**
+     * Free frames not reserved by an in-flight take
+     */
+    FrameId freeCount() const {
+        return static_cast<FrameId>(available.load(std::memory_order_acquire));
+    }
+    
+    /**
+     * Take count frames for the thread owning a shard
+     * @param shard Caller's shard (0 .. getShardCount() - 1)
+     * @param count Frames wanted
+     * @param out Receives count frame numbers on success
+     * @return false (and nothing taken) if fewer than count frames are free
+     */
+    bool take(int shard, size_t count, FrameId* out) {
+        // Reserve first so the frames are guaranteed to exist somewhere
+        int64_t free = available.load(std::memory_order_relaxed);
+        do {
+            if (free < static_cast<int64_t>(count)) return false;
+        } while (!available.compare_exchange_weak(free, free - static_cast<int64_t>(count),
+                                                  std::memory_order_acq_rel));
+        
+        size_t taken = 0;
+        while (taken < count) {
+            // Own shard, topped up from the global pool
+            {
+                Shard& own = shards[shard];
+                std::lock_guard<std::mutex> guard(own.lock);
+                if (own.frames.size() < count - taken) refill(own, count - taken - own.frames.size());
+                taken += takeFromShard(own, count - taken, out + taken);
+            }
+            
+            // Global pool exhausted: steal from neighbours, nearest first.
+            // Frames in flight between pools can be missed, so keep sweeping
+            // until the reservation is filled.
+            for (int step = 1; step < shardCount && taken < count; step++) {
+                Shard& victim = shards[(shard + step) % shardCount];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                taken += takeFromShard(victim, count - taken, out + taken);
+            }
+        }
+        return true;
+    }
+    
+    /**
+     * Return frames to a shard, flushing the excess over two batches back to
+     * the global pool so idle shards do not hoard memory
+     * @param shard Caller's shard
+     */
+    void release(int shard, const FrameId* frames, size_t count) {
+        Shard& own = shards[shard];
+        {
+            std::lock_guard<std::mutex> guard(own.lock);
+            own.frames.insert(own.frames.end(), frames, frames + count);
+            if (own.frames.size() > 2 * batchSize) {
+                std::lock_guard<std::mutex> globalGuard(globalLock);
+                while (own.frames.size() > batchSize) {
+                    global.release(own.frames.back());
+                    own.frames.pop_back();
+                }
+            }
+        }
+        available.fetch_add(static_cast<int64_t>(count), std::memory_order_acq_rel);
+    }
+};
+
+#endif // SHARDED_FRAME_POOL_H
@@ -0,0 +1,276 @@
+/**
+ * Simulated Swap Device
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef SWAP_DEVICE_H
+#define SWAP_DEVICE_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <stdexcept>
+
+#include "memory_types.h"
+
+/**
+ * Swap device statistics (times in simulated nanoseconds)
+ */
+struct SwapStats {
+    uint64_t simulatedNs;       // Simulated time: compute per access plus stalls
+    uint64_t demandReads;       // Page faults served by a synchronous read
+    uint64_t stallNs;           // Time accesses waited for pages still on the device
+    uint64_t prefetchesIssued;  // Asynchronous reads started by the prefetcher
+    uint64_t prefetchHits;      // Accesses that found their page prefetched (arrived or in flight)
+    uint64_t prefetchesWasted;  // Prefetched pages evicted or freed before any access
+    uint64_t hiddenNs;          // Fault latency prefetch hits did not wait for
+    uint64_t dirtyEvictions;    // Evicted pages that had to be written back
+    uint64_t pagesWritten;      // Written-back pages whose batch has completed
+    uint64_t writeBatches;      // Completed writeback requests
+};
+
+/**
+ * Discrete-event model of a paging device behind demand paging
+ * 
+ * The device has a fixed access latency and a bandwidth. Requests share one
+ * transfer channel in issue order; latency overlaps between requests in
+ * flight, transfers do not. Time is simulated: every access advances the
+ * clock by ACCESS_NS and waiting for a page advances it to the page's
+ * arrival, so runs take as long as the bookkeeping, not the modelled I/O.
+ * 
+ * A page fault issues a read and stalls until it completes. Prefetches and
+ * writebacks are asynchronous: each occupies a slot in a fixed-size event
+ * queue (at most QUEUE_DEPTH requests in flight) ordered by completion time,
+ * and events retire as the clock passes them. A prefetched frame records its
+ * arrival time; the first access stalls only for whatever remains, and the
+ * rest of the unloaded fault latency counts as hidden. Dirty pages evicted
+ * are collected and written in one request per batch, so the latency is
+ * paid once per batch rather than per page.
+ * 
+ * All storage is allocated by configure(); nothing afterwards allocates. A
+ * device that was never configured is disabled; callers check enabled()
+ * before driving it (markDirty() checks for itself).
+ */
+class SwapDevice {
+public:
+    static const uint64_t ACCESS_NS = 100;   // Simulated compute time per access
+    static const size_t QUEUE_DEPTH = 64;    // Asynchronous requests in flight at most
+
+private:
+    enum IoKind {
+        IO_PREFETCH,    // Read ahead of a sequential access stream
+        IO_WRITEBACK    // One batch of dirty pages
+    };
+    
+    struct IoEvent {
+        uint64_t completesAt;
+        IoKind kind;
+        uint32_t pages;
+        
+        bool operator>(const IoEvent& other) const { return completesAt > other.completesAt; }
+    };
+    
+    uint64_t latencyNs;
+    uint64_t transferNs;        // Channel time per page
+    uint32_t batchPages;        // Dirty pages per writeback request
+    uint32_t prefetchPages;     // Pages read ahead of a sequential stream (0 = no prefetch)
+    
+    uint64_t now;               // Simulated clock
+    uint64_t channelFree;       // When the transfer channel next becomes idle
+    std::vector<IoEvent> queue; // Min-heap on completion time, capacity QUEUE_DEPTH
+    std::vector<uint64_t> arrival;        // Frame -> prefetched page's arrival time (0 = none pending use)
+    std::vector<uint64_t> dirty;          // Bit f set when frame f was written since it was loaded
+    uint32_t pendingWrites;     // Dirty evictions waiting for a full batch
+    SwapStats totals;
+    
+    // Start a request of `pages` pages; the channel serializes transfers
+    uint64_t issue(uint32_t pages) {
+        uint64_t start = std::max(now, channelFree);
+        channelFree = start + transferNs * pages;
+        return channelFree + latencyNs;
+    }
+    
+    void push(uint64_t completesAt, IoKind kind, uint32_t pages) {
+        IoEvent event = {completesAt, kind, pages};
+        queue.push_back(event);
+        std::push_heap(queue.begin(), queue.end(), std::greater<IoEvent>());
+    }
+    
+    // Retire every event that has completed by the current time
+    void retire() {
+        while (!queue.empty() && queue.front().completesAt <= now) {
+            if (queue.front().kind == IO_WRITEBACK) {
+                totals.pagesWritten += queue.front().pages;
+                totals.writeBatches++;
+            }
+            std::pop_heap(queue.begin(), queue.end(), std::greater<IoEvent>());
+            queue.pop_back();
+        }
+    }
+    
+    void stallUntil(uint64_t time) {
+        if (time <= now) return;
+        totals.stallNs += time - now;
+        now = time;
+        retire();
+    }
+    
+    void writeBatch(uint32_t pages) {
+        // A full queue holds back reclaim until the earliest request finishes
+        if (queue.size() == QUEUE_DEPTH) stallUntil(queue.front().completesAt);
+        push(issue(pages), IO_WRITEBACK, pages);
+        pendingWrites = 0;
+    }
+    
+    bool isDirty(FrameId frame) const { return (dirty[frame / 64] >> (frame % 64)) & 1; }
+    void setDirty(FrameId frame) { dirty[frame / 64] |= uint64_t(1) << (frame % 64); }
+    void clearDirty(FrameId frame) { dirty[frame / 64] &= ~(uint64_t(1) << (frame % 64)); }
+    
+    // A frame's page leaves memory; an unused prefetch was wasted
+    void dropPrefetch(FrameId frame) {
+        if (arrival[frame] != 0) totals.prefetchesWasted++;
+        arrival[frame] = 0;
+    }
+
+public:
+    SwapDevice()
+        : latencyNs(0), transferNs(0), batchPages(0), prefetchPages(0), now(0), channelFree(0),
+          pendingWrites(0), totals() {}
+    
+    /**
+     * Enable the device and reset its clock and statistics
+     * @param frameCount Physical frames (size of the per-frame state)
+     * @param pageBytes Bytes moved per page
+     * @param accessLatencyNs Latency of every request
+     * @param bandwidthMBps Transfer rate in megabytes (10^6 bytes) per second
+     * @param writebackBatch Dirty pages written per request
+     * @param prefetch Pages read ahead of a sequential stream (0 = none)
+     */
+    void configure(FrameId frameCount, uint32_t pageBytes, uint64_t accessLatencyNs, uint64_t bandwidthMBps,
+                   uint32_t writebackBatch, uint32_t prefetch) {
+        if (bandwidthMBps == 0) throw std::invalid_argument("Swap bandwidth must be positive");
+        if (writebackBatch == 0) throw std::invalid_argument("Writeback batch must be at least one page");
+        if (prefetch > QUEUE_DEPTH) {
+            throw std::invalid_argument("Prefetch window cannot exceed the device queue depth");
+        }
+        latencyNs = accessLatencyNs;
+        transferNs = std::max<uint64_t>(1, static_cast<uint64_t>(pageBytes) * 1000 / bandwidthMBps);
+        batchPages = writebackBatch;
+        prefetchPages = prefetch;
+        now = 0;
+        channelFree = 0;
+        queue.clear();
+        queue.reserve(QUEUE_DEPTH);
+        std::vector<uint64_t>(frameCount, 0).swap(arrival);
+        std::vector<uint64_t>((static_cast<size_t>(frameCount) + 63) / 64, 0).swap(dirty);
+        pendingWrites = 0;
+        totals = SwapStats();
+    }
+    
+    bool enabled() const { return !arrival.empty(); }
+    uint64_t accessLatency() const { return latencyNs; }
+    uint64_t transferTime() const { return transferNs; }
+    uint32_t writebackBatch() const { return batchPages; }
+    uint32_t prefetchWindow() const { return prefetchPages; }
+    size_t inFlight() const { return queue.size(); }
+    
+    /**
+     * Time a fault costs on an idle device
+     */
+    uint64_t unloadedReadNs() const { return latencyNs + transferNs; }
+    
+    /**
+     * One access's worth of compute time passes
+     */
+    void tick() {
+        now += ACCESS_NS;
+        totals.simulatedNs = now;
+        retire();
+    }
+    
+    /**
+     * A page fault loaded a page into frame: read it and wait
+     */
+    void demandRead(FrameId frame) {
+        totals.demandReads++;
+        arrival[frame] = 0;
+        stallUntil(issue(1));
+        totals.simulatedNs = now;
+    }
+    
+    bool canPrefetch() const { return queue.size() < QUEUE_DEPTH; }
+    
+    /**
+     * The prefetcher loaded a page into frame: start reading it
+     */
+    void prefetch(FrameId frame) {
+        uint64_t completesAt = issue(1);
+        push(completesAt, IO_PREFETCH, 1);
+        arrival[frame] = completesAt;
+        totals.prefetchesIssued++;
+    }
+    
+    /**
+     * A resident page was accessed; if it was prefetched and not used yet,
+     * wait for it to arrive and credit the latency that was hidden
+     */
+    void access(FrameId frame) {
+        uint64_t arrives = arrival[frame];
+        if (arrives == 0) return;
+        arrival[frame] = 0;
+        uint64_t waited = arrives > now ? arrives - now : 0;
+        stallUntil(arrives);
+        totals.simulatedNs = now;
+        totals.prefetchHits++;
+        totals.hiddenNs += unloadedReadNs() > waited ? unloadedReadNs() - waited : 0;
+    }
+    
+    /**
+     * The page in frame was written
+     */
+    void markDirty(FrameId frame) {
+        if (enabled()) setDirty(frame);
+    }
+    
+    /**
+     * The page in frame was evicted: queue it for writeback if dirty
+     */
+    void evicted(FrameId frame) {
+        dropPrefetch(frame);
+        if (!isDirty(frame)) return;
+        clearDirty(frame);
+        totals.dirtyEvictions++;
+        if (++pendingWrites == batchPages) writeBatch(pendingWrites);
+    }
+    
+    /**
+     * The page in frame was dropped without writeback (its job was removed)
+     */
+    void discarded(FrameId frame) {
+        dropPrefetch(frame);
+        clearDirty(frame);
+    }
+    
+    /**
+     * A resident page moved between frames; its state moves with it
+     */
+    void moved(FrameId from, FrameId to) {
+        arrival[to] = arrival[from];
+        arrival[from] = 0;
+        if (isDirty(from)) setDirty(to);
+        clearDirty(from);
+    }
+    
+    /**
+     * Write out a partial batch now rather than waiting for it to fill
+     */
+    void flush() {
+        if (pendingWrites > 0) writeBatch(pendingWrites);
+    }
+    
+    const SwapStats& stats() const { return totals; }
+};
+
+#endif // SWAP_DEVICE_H
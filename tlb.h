@@ -0,0 +1,236 @@
+/**
+ * Translation Lookaside Buffer Model
+ * 
+ * Part of the Paged Memory Allocation Simulator library.
+ */
+
+#ifndef TLB_H
+#define TLB_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "memory_types.h"
+
+/**
+ * Simulated Translation Lookaside Buffer
+ * 
+ * Set-associative cache of (job ID, page number) -> frame number sitting in
+ * front of the page-table walk. Entries live in one fixed-size, cache-line
+ * aligned array allocated at configuration time; lookups never allocate.
+ * A TLB with zero entries is disabled.
+ */
+class Tlb {
+public:
+    // Victim selection within a set
+    enum Policy {
+        POLICY_LRU,    // Evict the least recently used entry
+        POLICY_FIFO,   // Evict the oldest inserted entry
+        POLICY_RANDOM  // Evict a pseudo-random entry
+    };
+    
+private:
+    // One TLB entry; four fit in a 64-byte cache line
+    struct Entry {
+        uint32_t jobId;        // Owning job, 0 when the entry is invalid
+        PageId pageNumber;     // Job-relative page number
+        FrameId frameNumber;   // Cached translation
+        uint32_t stamp;        // Last use (LRU) or insertion time (FIFO)
+    };
+    
+    static const size_t CACHE_LINE = 64;
+    
+    std::unique_ptr<unsigned char[]> storage;  // Backing memory for entries
+    Entry* entries;      // Cache-line aligned view into storage
+    int numEntries;      // Total entries (0 = disabled)
+    int ways;            // Entries per set
+    int numSets;         // numEntries / ways
+    Policy policy;
+    uint32_t clock;      // Logical time for LRU/FIFO stamps
+    uint32_t randomState;  // xorshift state for random replacement
+    
+    // Statistics
+    uint64_t hits;
+    uint64_t misses;
+    
+    // Latency model for effective access time
+    double hitTimeNs;
+    double memoryTimeNs;
+    
+    /**
+     * Map a translation to its set; consecutive pages land in different sets
+     */
+    Entry* setFor(int jobId, PageId pageNumber) const {
+        uint32_t h = pageNumber + static_cast<uint32_t>(jobId) * 2654435761u;
+        return entries + static_cast<size_t>(h % static_cast<uint32_t>(numSets)) * ways;
+    }
+    
+public:
+    Tlb() : entries(nullptr), numEntries(0), ways(0), numSets(0), policy(POLICY_LRU),
+            clock(0), randomState(2463534242u), hits(0), misses(0),
+            hitTimeNs(1.0), memoryTimeNs(100.0) {}
+    
+    /**
+     * (Re)configure the TLB geometry; all entries and statistics are reset
+     * @param entryCount Total number of entries (0 disables the TLB)
+     * @param associativity Entries per set (must divide entryCount)
+     * @param replacement Victim selection policy
+     */
+    void configure(int entryCount, int associativity, Policy replacement) {
+        if (entryCount < 0 || (entryCount > 0 && (associativity <= 0 || entryCount % associativity != 0))) {
+            throw std::invalid_argument("TLB entry count must be a multiple of its associativity");
+        }
+        
+        numEntries = entryCount;
+        ways = entryCount > 0 ? associativity : 0;
+        numSets = entryCount > 0 ? entryCount / associativity : 0;
+        policy = replacement;
+        clock = 0;
+        hits = 0;
+        misses = 0;
+        
+        // Over-allocate by one cache line and align the entry array inside it
+        size_t bytes = sizeof(Entry) * numEntries;
+        storage.reset(entryCount > 0 ? new unsigned char[bytes + CACHE_LINE] : nullptr);
+        entries = nullptr;
+        if (storage) {
+            uintptr_t raw = reinterpret_cast<uintptr_t>(storage.get());
+            entries = reinterpret_cast<Entry*>((raw + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1));
+            std::memset(entries, 0, bytes);
+        }
+    }
+    
+    /**
+     * Set the latencies used for the effective access time estimate
+     */
+    void setLatencies(double tlbHitNs, double memoryAccessNs) {
+        hitTimeNs = tlbHitNs;
+        memoryTimeNs = memoryAccessNs;
+    }
+    
+    bool enabled() const { return numEntries > 0; }
+    
+    /**
+     * Look up a translation, updating hit/miss counters
+     * @param frameNumber Receives the cached frame on a hit
+     * @return true on a TLB hit
+     */
+    bool lookup(int jobId, PageId pageNumber, FrameId& frameNumber) {
+        clock++;
+        Entry* set = setFor(jobId, pageNumber);
+        for (int w = 0; w < ways; w++) {
+            if (set[w].jobId == static_cast<uint32_t>(jobId) &&
+                set[w].pageNumber == pageNumber) {
+                if (policy == POLICY_LRU) set[w].stamp = clock;
+                frameNumber = set[w].frameNumber;
+                hits++;
+                return true;
+            }
+        }
+        misses++;
+        return false;
+    }
+    
+    /**
+     * Install a translation after a miss, evicting per the policy if needed
+     */
+    void insert(int jobId, PageId pageNumber, FrameId frameNumber) {
+        Entry* set = setFor(jobId, pageNumber);
+        Entry* victim = nullptr;
+        
+        for (int w = 0; w < ways && !victim; w++) {
+            if (set[w].jobId == 0) victim = &set[w];
+        }
+        
+        if (!victim) {
+            if (policy == POLICY_RANDOM) {
+                randomState ^= randomState << 13;
+                randomState ^= randomState >> 17;
+                randomState ^= randomState << 5;
+                victim = &set[randomState % static_cast<uint32_t>(ways)];
+            } else {
+                // Oldest stamp; unsigned age keeps this correct across wraparound
+                victim = &set[0];
+                for (int w = 1; w < ways; w++) {
+                    if (clock - set[w].stamp > clock - victim->stamp) victim = &set[w];
+                }
+            }
+        }
+        
+        victim->jobId = static_cast<uint32_t>(jobId);
+        victim->pageNumber = pageNumber;
+        victim->frameNumber = frameNumber;
+        victim->stamp = clock;
+    }
+    
+    /**
+     * Invalidate one cached translation (a page was evicted)
+     */
+    void invalidate(int jobId, PageId pageNumber) {
+        if (!enabled()) return;
+        
+        Entry* set = setFor(jobId, pageNumber);
+        for (int w = 0; w < ways; w++) {
+            if (set[w].jobId == static_cast<uint32_t>(jobId) && set[w].pageNumber == pageNumber) {
+                set[w].jobId = 0;
+            }
+        }
+    }
+    
+    /**
+     * Invalidate every entry belonging to a job
+     * @param pageCount Number of pages the job owns, used to pick the cheaper
+     *                  of probing its pages' sets or sweeping the whole TLB
+     */
+    void flushJob(int jobId, PageId pageCount) {
+        if (!enabled()) return;
+        
+        uint32_t id = static_cast<uint32_t>(jobId);
+        if (pageCount < static_cast<PageId>(numSets)) {
+            for (PageId page = 0; page < pageCount; page++) {
+                Entry* set = setFor(jobId, page);
+                for (int w = 0; w < ways; w++) {
+                    if (set[w].jobId == id && set[w].pageNumber == page) {
+                        set[w].jobId = 0;
+                    }
+                }
+            }
+        } else {
+            for (int i = 0; i < numEntries; i++) {
+                if (entries[i].jobId == id) entries[i].jobId = 0;
+            }
+        }
+    }
+    
+    // Configuration and statistics accessors
+    int entryCount() const { return numEntries; }
+    int associativity() const { return ways; }
+    Policy replacementPolicy() const { return policy; }
+    uint64_t hitCount() const { return hits; }
+    uint64_t missCount() const { return misses; }
+    
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+    
+    /**
+     * Effective access time: every access pays the TLB probe and one memory
+     * reference; a miss adds one more memory reference for the page-table walk
+     */
+    double effectiveAccessTimeNs() const {
+        return hitTimeNs + memoryTimeNs + (1.0 - hitRate()) * memoryTimeNs;
+    }
+    
+    static const char* policyName(Policy p) {
+        switch (p) {
+            case POLICY_FIFO: return "FIFO";
+            case POLICY_RANDOM: return "Random";
+            default: return "LRU";
+        }
+    }
+};
+
+#endif // TLB_H
@@ -0,0 +1,386 @@
+/**
+ * Trace Replay Driver
+ * 
+ * Replays a recorded stream of memory-manager operations back-to-back
+ * against a PagedMemoryManager and reports throughput and latency.
+ * 
+ * Text trace format (one operation per line, '#' starts a comment):
+ *   A <id> <size> [name]   Accept a job of <size> bytes
+ *   R <id> <address>       Resolve a logical address of job <id>
+ *   W <id> <address>       Resolve an address of job <id> for a write
+ *   X <id>                 Remove job <id>
+ *   D                      Poll the memory state (utilization and TLB counters)
+ * 
+ * Binary traces (binary_trace.h) carry the same operations in fixed-width
+ * records and replay through the same loop.
+ * 
+ * Job IDs in a trace are the trace's own identifiers (for example the IDs
+ * found in an allocator log); the driver maps them to the IDs assigned by
+ * the manager when each job is accepted.
+ */
+
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "paged_memory.h"
+#include "latency_histogram.h"
+#include "access_analyzer.h"
+#include "memory_snapshot.h"
+#include "object_pool.h"
+
+/**
+ * One decoded trace operation
+ */
+struct TraceOp {
+    enum Kind {
+        ACCEPT,   // Accept a job: jobId, value = size, name
+        RESOLVE,  // Resolve an address: jobId, value = logical address
+        REMOVE,   // Remove a job: jobId
+        DISPLAY,  // Poll the memory state
+        WRITE     // Resolve an address for a write: jobId, value = logical address
+    };
+    
+    Kind kind;
+    int jobId;          // Trace-local job identifier
+    int64_t value;      // Job size or logical address
+    std::string name;   // Job name (accept only)
+};
+
+const int TRACE_OP_KINDS = 5;
+
+/**
+ * Decoded view of one operation, independent of the trace encoding
+ * 
+ * The name points into the trace's own storage, so producing a view never
+ * allocates.
+ */
+struct TraceOpView {
+    TraceOp::Kind kind;
+    int jobId;              // Trace-local job identifier
+    int64_t value;          // Job size or logical address
+    const char* name;       // Job name (accept only), not NUL-terminated
+    size_t nameLength;
+};
+
+/**
+ * Trace source over parsed text operations
+ */
+class TextTraceSource {
+private:
+    const std::vector<TraceOp>& ops;
+    
+public:
+    explicit TextTraceSource(const std::vector<TraceOp>& ops) : ops(ops) {}
+    
+    size_t size() const { return ops.size(); }
+    
+    TraceOpView operator[](size_t i) const {
+        const TraceOp& op = ops[i];
+        TraceOpView view = {op.kind, op.jobId, op.value, op.name.data(), op.name.size()};
+        return view;
+    }
+};
+
+/**
+ * Per-operation-kind replay measurements
+ */
+struct ReplayOpStats {
+    uint64_t count;                  // Operations issued
+    uint64_t failures;               // Operations the manager rejected
+    LatencyHistogram latencies;      // Per-operation latency in nanoseconds
+};
+
+/**
+ * Replay summary
+ */
+struct ReplayStats {
+    ReplayOpStats ops[TRACE_OP_KINDS];
+    uint64_t totalOps;
+    double elapsedSeconds;           // Wall time spent replaying
+    uint64_t lastUsedFrames;         // Utilization seen by the last poll
+    uint64_t failuresByStatus[STATUS_COUNT];  // Failed accepts, resolves and removes by Status
+    ReplayOpStats compaction;        // Compaction steps run between operations (count = steps)
+    uint64_t pagesMigrated;          // Pages those steps moved
+};
+
+/**
+ * Outcome of parsing one text trace line
+ */
+enum TraceLineStatus {
+    TRACE_LINE_OP,        // Line decoded into an operation
+    TRACE_LINE_BLANK,     // Blank or comment-only line
+    TRACE_LINE_MALFORMED  // Line could not be decoded
+};
+
+/**
+ * Parse one line of a text trace
+ * @param line Line to decode (comments are stripped in place)
+ * @param op Receives the operation when the line holds one
+ */
+inline TraceLineStatus parseTraceLine(std::string& line, TraceOp& op) {
+    // Strip comments and skip blank lines
+    std::string::size_type hash = line.find('#');
+    if (hash != std::string::npos) line.erase(hash);
+    
+    std::istringstream fields(line);
+    std::string opcode;
+    if (!(fields >> opcode)) return TRACE_LINE_BLANK;
+    
+    op.jobId = 0;
+    op.value = 0;
+    op.name.clear();
+    if (opcode.size() != 1) return TRACE_LINE_MALFORMED;
+    
+    switch (opcode[0]) {
+        case 'A':
+            op.kind = TraceOp::ACCEPT;
+            if (!(fields >> op.jobId >> op.value)) return TRACE_LINE_MALFORMED;
+            std::getline(fields >> std::ws, op.name);
+            if (op.name.empty()) {
+                char defaultName[16];
+                int length = std::snprintf(defaultName, sizeof(defaultName), "job%d", op.jobId);
+                op.name.assign(defaultName, static_cast<size_t>(length));
+            }
+            return TRACE_LINE_OP;
+        case 'R':
+            op.kind = TraceOp::RESOLVE;
+            return fields >> op.jobId >> op.value ? TRACE_LINE_OP : TRACE_LINE_MALFORMED;
+        case 'W':
+            op.kind = TraceOp::WRITE;
+            return fields >> op.jobId >> op.value ? TRACE_LINE_OP : TRACE_LINE_MALFORMED;
+        case 'X':
+            op.kind = TraceOp::REMOVE;
+            return fields >> op.jobId ? TRACE_LINE_OP : TRACE_LINE_MALFORMED;
+        case 'D':
+            op.kind = TraceOp::DISPLAY;
+            return TRACE_LINE_OP;
+        default:
+            return TRACE_LINE_MALFORMED;
+    }
+}
+
+/**
+ * Parse a text trace
+ * @param in Input stream holding the trace
+ * @param ops Receives the decoded operations
+ * @param error Receives a description of the first malformed line
+ * @return true if the whole trace was parsed
+ */
+inline bool parseTextTrace(std::istream& in, std::vector<TraceOp>& ops, std::string& error) {
+    std::string line;
+    int lineNumber = 0;
+    TraceOp op = {TraceOp::DISPLAY, 0, 0, std::string()};
+    
+    while (std::getline(in, line)) {
+        lineNumber++;
+        
+        TraceLineStatus status = parseTraceLine(line, op);
+        if (status == TRACE_LINE_MALFORMED) {
+            error = "Malformed trace line " + std::to_string(lineNumber) + ": " + line;
+            return false;
+        }
+        if (status == TRACE_LINE_OP) ops.push_back(op);
+    }
+    
+    return true;
+}
+
+/**
+ * Replay operations back-to-back, timing each one
+ * 
+ * Works over any source providing size() and operator[] returning a
+ * TraceOpView, so text and memory-mapped binary traces share one loop.
+ * @param manager Manager to drive
+ * @param source Operations to replay
+ * @param analyzer If given, receives every translated access (outside the
+ *                 timed region) for reuse-distance and working-set analysis
+ * @param snapshots If given, every poll writes a snapshot through it (timed
+ *                  as part of the poll)
+ * @param compactionBudget If positive, every successful remove starts a
+ *                         compaction pass (unless one is running) and one
+ *                         step of at most this many page migrations runs
+ *                         after each operation until it finishes, timed
+ *                         separately from the operations
+ * @return Throughput and latency measurements
+ */
+template <typename Source>
+inline ReplayStats replayTrace(PagedMemoryManager& manager, const Source& source,
+                               AccessAnalyzer* analyzer = nullptr, SnapshotWriter* snapshots = nullptr,
+                               FrameId compactionBudget = 0) {
+    typedef std::chrono::steady_clock Clock;
+    
+    ReplayStats stats;
+    for (int k = 0; k < TRACE_OP_KINDS; k++) {
+        stats.ops[k].count = 0;
+        stats.ops[k].failures = 0;
+    }
+    stats.totalOps = source.size();
+    stats.lastUsedFrames = 0;
+    std::fill(stats.failuresByStatus, stats.failuresByStatus + STATUS_COUNT, uint64_t(0));
+    stats.compaction.count = 0;
+    stats.compaction.failures = 0;
+    stats.pagesMigrated = 0;
+    
+    // Trace job ID -> manager job ID (nodes recycled, so steady-state
+    // accept/remove cycles do not allocate)
+    typedef std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                               PoolAllocator<std::pair<const int, int>>> JobMap;
+    BlockPool jobMapNodes;
+    JobMap jobMap(0, std::hash<int>(), std::equal_to<int>(), JobMap::allocator_type(&jobMapNodes));
+    
+    // Reused for every accept so job names do not allocate once it has grown
+    std::string nameBuffer;
+    std::string snapshotError;
+    
+    const size_t count = source.size();
+    Clock::time_point replayStart = Clock::now();
+    for (size_t i = 0; i < count; i++) {
+        TraceOpView op = source[i];
+        Clock::time_point start = Clock::now();
+        bool success = true;
+        Status status = Status::Ok;   // Why an accept, resolve or remove failed
+        int managerJobId = 0;         // Job the operation applied to, for the analyzer
+        PageId pageIndex = 0;         // Page a resolve translated
+        PageId pagesAllocated = 0;    // Pages an accept reserved
+        
+        switch (op.kind) {
+            case TraceOp::ACCEPT: {
+                nameBuffer.assign(op.name, op.nameLength);
+                success = op.value > 0;
+                status = Status::InvalidSize;
+                if (success) {
+                    AcceptResult result = manager.acceptJob(nameBuffer, static_cast<Address>(op.value));
+                    success = result.success;
+                    status = result.status;
+                    if (success) jobMap[op.jobId] = result.jobId;
+                    managerJobId = result.jobId;
+                    pagesAllocated = result.pagesAllocated;
+                }
+                break;
+            }
+            case TraceOp::RESOLVE:
+            case TraceOp::WRITE: {
+                auto it = jobMap.find(op.jobId);
+                if (it != jobMap.end() && op.value >= 0) {
+                    Address address = static_cast<Address>(op.value);
+                    TranslationResult result = op.kind == TraceOp::WRITE ? manager.resolveWrite(it->second, address)
+                                                                         : manager.resolveAddress(it->second, address);
+                    success = result.success;
+                    status = result.status;
+                    managerJobId = it->second;
+                    pageIndex = result.pageNumber;
+                } else {
+                    success = false;
+                    status = it == jobMap.end() ? Status::NoSuchJob : Status::OutOfBounds;
+                }
+                break;
+            }
+            case TraceOp::REMOVE: {
+                auto it = jobMap.find(op.jobId);
+                status = it != jobMap.end() ? manager.removeJob(it->second).status : Status::NoSuchJob;
+                success = status == Status::Ok;
+                if (success) {
+                    managerJobId = it->second;
+                    jobMap.erase(it);
+                }
+                break;
+            }
+            case TraceOp::DISPLAY:
+                stats.lastUsedFrames = static_cast<uint64_t>(manager.getUsedFrames());
+                if (snapshots) success = snapshots->write(manager, snapshotError);
+                break;
+        }
+        
+        uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        ReplayOpStats& opStats = stats.ops[op.kind];
+        opStats.count++;
+        opStats.failures += !success;
+        if (status != Status::Ok) stats.failuresByStatus[static_cast<int>(status)]++;
+        opStats.latencies.record(nanos);
+        
+        if (compactionBudget > 0) {
+            if (op.kind == TraceOp::REMOVE && success && !manager.compactionActive()) manager.startCompaction();
+            if (manager.compactionActive()) {
+                Clock::time_point stepStart = Clock::now();
+                stats.pagesMigrated += manager.compactStep(compactionBudget).framesMoved;
+                stats.compaction.latencies.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - stepStart).count()));
+                stats.compaction.count++;
+            }
+        }
+        
+        if (analyzer && success) {
+            switch (op.kind) {
+                case TraceOp::ACCEPT: analyzer->trackJob(managerJobId, pagesAllocated); break;
+                case TraceOp::RESOLVE:
+                case TraceOp::WRITE: analyzer->recordAccess(managerJobId, pageIndex); break;
+                case TraceOp::REMOVE: analyzer->untrackJob(managerJobId); break;
+                default: break;
+            }
+        }
+    }
+    stats.elapsedSeconds = std::chrono::duration<double>(Clock::now() - replayStart).count();
+    
+    return stats;
+}
+
+/**
+ * Print the replay summary: throughput plus latency percentiles per operation
+ */
+inline void printReplayReport(std::ostream& out, const ReplayStats& stats) {
+    static const char* const kindNames[TRACE_OP_KINDS] = {"accept", "resolve", "remove", "display", "write"};
+    static const double percentiles[] = {50.0, 90.0, 99.0, 99.9};
+    
+    out << "\n=== Trace Replay Results ===" << std::endl;
+    out << "Operations: " << stats.totalOps << std::endl;
+    out << "Elapsed: " << std::fixed << std::setprecision(3) << stats.elapsedSeconds * 1000 << " ms" << std::endl;
+    out << "Throughput: " << std::fixed << std::setprecision(0)
+        << (stats.elapsedSeconds > 0 ? stats.totalOps / stats.elapsedSeconds : 0.0) << " ops/sec" << std::endl;
+    
+    out << "\nLatency (ns):" << std::endl;
+    out << std::setw(10) << "Op" << std::setw(12) << "Count" << std::setw(10) << "Failed"
+        << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+        << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::endl;
+    out << std::string(82, '-') << std::endl;
+    
+    for (int k = 0; k < TRACE_OP_KINDS; k++) {
+        const ReplayOpStats& opStats = stats.ops[k];
+        if (opStats.count == 0) continue;
+        
+        out << std::setw(10) << kindNames[k] << std::setw(12) << opStats.count
+            << std::setw(10) << opStats.failures;
+        for (double p : percentiles) {
+            out << std::setw(10) << opStats.latencies.percentile(p);
+        }
+        out << std::setw(10) << opStats.latencies.max() << std::endl;
+    }
+    if (stats.compaction.count > 0) {
+        out << std::setw(10) << "compact" << std::setw(12) << stats.compaction.count << std::setw(10) << "-";
+        for (double p : percentiles) {
+            out << std::setw(10) << stats.compaction.latencies.percentile(p);
+        }
+        out << std::setw(10) << stats.compaction.latencies.max() << std::endl;
+        out << "Compaction steps moved " << stats.pagesMigrated << " pages" << std::endl;
+    }
+    
+    const char* separator = "\nFailures by status: ";
+    for (int k = 1; k < STATUS_COUNT; k++) {
+        if (stats.failuresByStatus[k] == 0) continue;
+        out << separator << statusName(static_cast<Status>(k)) << " " << stats.failuresByStatus[k];
+        separator = ", ";
+    }
+    if (separator[0] == ',') out << std::endl;
+}
+
+#endif // TRACE_REPLAY_H